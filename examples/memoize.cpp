@@ -0,0 +1,45 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <iostream>
+
+#include "lru/lru.hpp"
+
+auto main() -> int {
+  // The function receives the memoized function itself as its first argument.
+  // Recursive calls made through it are cached, unlike with `LRU::wrap`.
+  auto fibonacci = LRU::memoize<long(int)>([](auto& self, int n) -> long {
+    if (n < 2) return 1;
+    return self(n - 1) + self(n - 2);
+  });
+
+  std::cout << fibonacci(32) << std::endl;
+
+  // For a single integer argument with a known range, a dense array avoids
+  // hashing altogether. Arguments outside [0, 100) are simply not cached.
+  auto dense_fibonacci =
+      LRU::memoize_dense<long(int)>([](auto& self, int n) -> long {
+        if (n < 2) return 1;
+        return self(n - 1) + self(n - 2);
+      }, 100);
+
+  std::cout << dense_fibonacci(90) << std::endl;
+}
@@ -0,0 +1,104 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_ACCESS_HINT_HPP
+#define LRU_ACCESS_HINT_HPP
+
+namespace LRU {
+
+/// Hints about the nature of an access to a cache.
+///
+/// Accesses made during a *scan*, such as a batch job iterating over many cold
+/// keys, would normally move every key they touch to the most-recently-used end
+/// of the cache and flush out the keys interactive traffic depends on. Scan
+/// accesses instead insert new keys at the least-recently-used end (so they are
+/// the first to be evicted again) and do not promote keys they hit.
+enum class AccessHint {
+  /// A regular access, which marks the key as most recently used.
+  Normal,
+
+  /// An access that is part of a scan and should not disturb the order.
+  Scan
+};
+
+/// Marks all accesses to a cache as scan accesses for the lifetime of the
+/// guard.
+///
+/// Guards may be nested. Usually, a guard is obtained via a cache's `scan()`
+/// method:
+/// \code{.cpp}
+/// {
+///   auto guard = cache.scan();
+///   for (const auto& key : cold_keys) {
+///     cache.insert(key, compute(key));
+///   }
+/// }
+/// \endcode
+///
+/// \tparam Cache The type of the cache to guard.
+template <typename Cache>
+class ScanGuard {
+ public:
+  /// Constructor.
+  ///
+  /// \param cache The cache whose accesses to mark as scan accesses.
+  explicit ScanGuard(Cache& cache) : _cache(&cache) {
+    _cache->begin_scan();
+  }
+
+  /// Move constructor.
+  ///
+  /// \param other The guard to take over the scan from.
+  ScanGuard(ScanGuard&& other) noexcept : _cache(other._cache) {
+    other._cache = nullptr;
+  }
+
+  /// Copy constructor.
+  ScanGuard(const ScanGuard& other) = delete;
+
+  /// Copy assignment operator.
+  ScanGuard& operator=(const ScanGuard& other) = delete;
+
+  /// Move assignment operator.
+  ScanGuard& operator=(ScanGuard&& other) = delete;
+
+  /// Destructor.
+  ///
+  /// Ends the scan, unless an enclosing guard is still alive.
+  ~ScanGuard() {
+    if (_cache) _cache->end_scan();
+  }
+
+ private:
+  /// The cache being scanned.
+  Cache* _cache;
+};
+
+namespace Lowercase {
+using access_hint = AccessHint;
+
+template <typename Cache>
+using scan_guard = ScanGuard<Cache>;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_ACCESS_HINT_HPP
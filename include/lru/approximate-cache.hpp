@@ -0,0 +1,884 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_APPROXIMATE_CACHE_HPP
+#define LRU_APPROXIMATE_CACHE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <lru/access-hint.hpp>
+#include <lru/cache-tags.hpp>
+#include <lru/error.hpp>
+#include <lru/hash.hpp>
+#include <lru/internal/cache-monitor.hpp>
+#include <lru/internal/callback-manager.hpp>
+#include <lru/internal/definitions.hpp>
+#include <lru/internal/last-accessed.hpp>
+#include <lru/internal/random.hpp>
+#include <lru/internal/statistics-mutator.hpp>
+#include <lru/internal/utility.hpp>
+#include <lru/statistics.hpp>
+
+namespace LRU {
+namespace Internal {
+
+/// The value type of the internal map of an `ApproximateCache`.
+///
+/// Instead of an iterator into an order queue, this information object stores
+/// only the logical time of the last access to its key and the position of the
+/// key in the flat array of entries the cache samples eviction candidates from.
+///
+/// \tparam Key The key type of the information.
+/// \tparam Value The value type of the information.
+template <typename Key, typename Value>
+struct SampledInformation {
+  using KeyType = Key;
+  using ValueType = Value;
+  using Tick = std::uint32_t;
+
+  /// Constructor.
+  ///
+  /// \param value_ The value for the information.
+  /// \param tick_ The logical time of the last access to the key.
+  /// \param index_ The index of the key in the array of entries.
+  template <typename AnyValue>
+  SampledInformation(AnyValue&& value_, Tick tick_, std::size_t index_)
+  : value(std::forward<AnyValue>(value_)), tick(tick_), index(index_) {
+  }
+
+  /// The value of the information.
+  Value value;
+
+  /// The logical time of the last access to the key.
+  ///
+  /// This is mutable because accessing a key through a const cache still
+  /// counts as a use of the key.
+  mutable Tick tick;
+
+  /// The index of the key in the array of entries of the cache.
+  std::size_t index;
+};
+}  // namespace Internal
+
+/// An approximate LRU cache that keeps no recency list.
+///
+/// Rather than maintaining an exact order of use in a linked list (costing a
+/// list node and an iterator per key, and a splice per hit), this cache stores
+/// only a 32-bit logical timestamp with each key, so that a hit amounts to a
+/// single store. When the cache is full, it samples a few random keys from a
+/// flat array of entries and evicts the least recently used among them. Like
+/// Redis, it remembers a small pool of the best candidates seen during past
+/// evictions, which brings the approximation remarkably close to true LRU.
+///
+/// Since there is no notion of order, the cache provides no (ordered)
+/// iterators. Timestamps wrap around after $2^{32}$ accesses, so a key not used
+/// for that long may appear young again. Neither is a concern for its intended
+/// use: large caches where the per-key overhead of exact LRU matters.
+///
+/// \see LRU::Cache
+template <typename Key,
+          typename Value,
+          typename HashFunction = DefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class ApproximateCache : private Internal::CacheMonitor<Key, Value> {
+ private:
+  using monitoring = Internal::CacheMonitor<Key, Value>;
+  using PRIVATE_CACHE_MONITOR_MEMBERS
+
+  using Information = Internal::SampledInformation<Key, Value>;
+  using Tick = typename Information::Tick;
+
+  using Map = Internal::Map<Key, Information, HashFunction, KeyEqual>;
+  using MapIterator = typename Map::iterator;
+  using MapConstIterator = typename Map::const_iterator;
+  using Node = typename Map::value_type;
+
+  using typename monitoring::CallbackManagerType;
+  using HitCallback = typename CallbackManagerType::HitCallback;
+  using MissCallback = typename CallbackManagerType::MissCallback;
+  using AccessCallback = typename CallbackManagerType::AccessCallback;
+  using HitCallbackContainer =
+      typename CallbackManagerType::HitCallbackContainer;
+  using MissCallbackContainer =
+      typename CallbackManagerType::MissCallbackContainer;
+  using AccessCallbackContainer =
+      typename CallbackManagerType::AccessCallbackContainer;
+
+  using LastAccessed =
+      typename Internal::LastAccessed<Key, Information, KeyEqual>;
+
+ public:
+  using Tag = LRU::Tag::ApproximateCache;
+  using InitializerList = std::initializer_list<std::pair<Key, Value>>;
+  using StatisticsPointer = std::shared_ptr<Statistics<Key>>;
+  using size_t = std::size_t;
+
+  static constexpr Tag tag() noexcept {
+    return {};
+  }
+
+  /// Constructor.
+  ///
+  /// \param capacity The capacity of the cache.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  explicit ApproximateCache(size_t capacity = Internal::DEFAULT_CAPACITY,
+                            const HashFunction& hash = HashFunction(),
+                            const KeyEqual& key_equal = KeyEqual())
+  : _map(0, hash, key_equal)
+  , _last_accessed(key_equal)
+  , _capacity(capacity)
+  , _samples(Internal::DEFAULT_SAMPLES)
+  , _pool_size(Internal::DEFAULT_EVICTION_POOL_SIZE)
+  , _clock(0) {
+  }
+
+  /// Constructor.
+  ///
+  /// \param capacity The capacity of the cache.
+  /// \param list The initializer list to construct the cache with.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  ApproximateCache(size_t capacity,
+                   InitializerList list,
+                   const HashFunction& hash = HashFunction(),
+                   const KeyEqual& key_equal = KeyEqual())
+  : ApproximateCache(capacity, hash, key_equal) {
+    insert(list);
+  }
+
+  /// Constructor.
+  ///
+  /// \param list The initializer list to construct the cache with.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  ApproximateCache(InitializerList list,
+                   const HashFunction& hash = HashFunction(),
+                   const KeyEqual& key_equal =
+                       KeyEqual())  // NOLINT(runtime/explicit)
+      : ApproximateCache(list.size(), list, hash, key_equal) {
+  }
+
+  /// Copy constructor.
+  ApproximateCache(const ApproximateCache& other)
+  : monitoring(other)
+  , _map(other._map)
+  , _pool(other._pool)
+  , _last_accessed(other._last_accessed.key_equal())
+  , _capacity(other._capacity)
+  , _samples(other._samples)
+  , _pool_size(other._pool_size)
+  , _clock(other._clock)
+  , _random(other._random) {
+    _reassign_slots();
+  }
+
+  /// Move constructor.
+  ApproximateCache(ApproximateCache&& other) = default;
+
+  /// Copy assignment operator.
+  ApproximateCache& operator=(const ApproximateCache& other) {
+    if (this != &other) {
+      ApproximateCache copy(other);
+      swap(copy);
+    }
+
+    return *this;
+  }
+
+  /// Move assignment operator.
+  ApproximateCache& operator=(ApproximateCache&& other) = default;
+
+  /// Swaps the contents of the cache with another cache.
+  ///
+  /// \param other The other cache to swap with.
+  void swap(ApproximateCache& other) noexcept {
+    using std::swap;
+
+    swap(_map, other._map);
+    swap(_slots, other._slots);
+    swap(_pool, other._pool);
+    swap(_stats, other._stats);
+    swap(_last_accessed, other._last_accessed);
+    swap(_callback_manager, other._callback_manager);
+    swap(_capacity, other._capacity);
+    swap(_samples, other._samples);
+    swap(_pool_size, other._pool_size);
+    swap(_clock, other._clock);
+    swap(_random, other._random);
+  }
+
+  /// Swaps the contents of one cache with another cache.
+  ///
+  /// \param first The first cache to swap.
+  /// \param second The second cache to swap.
+  friend void swap(ApproximateCache& first, ApproximateCache& second) noexcept {
+    first.swap(second);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // CACHE INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// Tests if the given key is contained in the cache.
+  ///
+  /// If the key is found, it counts as used.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key to check for.
+  /// \returns True if the key is contained in the cache, else false.
+  bool contains(const Key& key) const {
+    if (key == _last_accessed) {
+      _touch(_last_accessed.information());
+      _register_hit(key, _last_accessed.value());
+      return true;
+    }
+
+    return _find(key) != _map.end();
+  }
+
+  /// Looks up the value for the given key.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key whose value to look for.
+  /// \throws LRU::Error::KeyNotFound if the key is not in the cache.
+  /// \returns The value stored in the cache for the given key.
+  const Value& lookup(const Key& key) const {
+    if (key == _last_accessed) {
+      _touch(_last_accessed.information());
+      _register_hit(key, _last_accessed.value());
+      return _last_accessed.value();
+    }
+
+    auto iterator = _find(key);
+    if (iterator == _map.end()) {
+      throw LRU::Error::KeyNotFound();
+    }
+
+    return iterator->second.value;
+  }
+
+  /// \copydoc lookup(const Key&) const
+  Value& lookup(const Key& key) {
+    const auto& self = *this;
+    return const_cast<Value&>(self.lookup(key));
+  }
+
+  /// \copydoc lookup(const Key&)
+  Value& operator[](const Key& key) {
+    return lookup(key);
+  }
+
+  /// \copydoc lookup(const Key&) const
+  const Value& operator[](const Key& key) const {
+    return lookup(key);
+  }
+
+  /// Inserts the given `(key, value)` pair into the cache.
+  ///
+  /// If the key is already present, its value is updated and the key counts as
+  /// used. If the cache is full, an (approximately) least recently used key is
+  /// evicted first.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key to insert.
+  /// \param value The value to insert with the key.
+  /// \returns True if the key was newly inserted, false if it was only updated.
+  bool insert(const Key& key, const Value& value) {
+    if (_capacity == 0) return false;
+
+    auto iterator = _map.find(key);
+    if (iterator != _map.end()) {
+      iterator->second.value = value;
+      _touch(iterator->second);
+      _register_overwrite();
+      _last_accessed = iterator;
+      return false;
+    }
+
+    _insert_new_key(key, value);
+    return true;
+  }
+
+  /// Inserts the given `(key, value)` pair into the cache.
+  ///
+  /// If the access is part of a scan, a new key is inserted as if it had not
+  /// been used for a long time (making it a prime candidate for eviction) and
+  /// an existing key is updated without counting as used.
+  ///
+  /// \param key The key to insert.
+  /// \param value The value to insert with the key.
+  /// \param hint The kind of access being made.
+  /// \returns True if the key was newly inserted, false if it was only updated.
+  /// \see LRU::AccessHint
+  bool insert(const Key& key, const Value& value, AccessHint hint) {
+    if (hint == AccessHint::Normal) return insert(key, value);
+    ScanGuard<ApproximateCache> guard(*this);
+    return insert(key, value);
+  }
+
+  /// Inserts a range of `(key, value)` pairs.
+  ///
+  /// \param begin An iterator for the start of the range to insert.
+  /// \param end An iterator for the end of the range to insert.
+  /// \returns The number of elements newly inserted (as opposed to only
+  /// updated).
+  template <typename Iterator,
+            typename = Internal::enable_if_iterator_over_pair<Iterator>>
+  size_t insert(Iterator begin, Iterator end) {
+    size_t newly_inserted = 0;
+    for (; begin != end; ++begin) {
+      newly_inserted += insert(begin->first, begin->second);
+    }
+
+    return newly_inserted;
+  }
+
+  /// Inserts a list of `(key, value)` pairs.
+  ///
+  /// \param list The list of `(key, value)` pairs to insert.
+  /// \returns The number of elements newly inserted (as opposed to only
+  /// updated).
+  size_t insert(InitializerList list) {
+    return insert(list.begin(), list.end());
+  }
+
+  /// Emplaces a `(key, value)` pair.
+  ///
+  /// \param key_argument The argument to construct a key object with.
+  /// \param value_argument The argument to construct a value object with.
+  /// \returns True if the key was newly inserted, false if it was only updated.
+  template <typename K, typename V>
+  bool emplace(K&& key_argument, V&& value_argument) {
+    if (_capacity == 0) return false;
+
+    Key key(std::forward<K>(key_argument));
+    auto iterator = _map.find(key);
+
+    if (iterator != _map.end()) {
+      iterator->second.value = Value(std::forward<V>(value_argument));
+      _touch(iterator->second);
+      _register_overwrite();
+      _last_accessed = iterator;
+      return false;
+    }
+
+    _insert_new_key(std::move(key), std::forward<V>(value_argument));
+    return true;
+  }
+
+  /// Erases the given key from the cache, if it is present.
+  ///
+  /// \param key The key to erase.
+  /// \returns True if the key was erased, else false.
+  bool erase(const Key& key) {
+    auto iterator = _map.find(key);
+    if (iterator == _map.end()) return false;
+
+    _register_erasure();
+    _erase(iterator);
+    return true;
+  }
+
+  /// Clears the cache entirely.
+  void clear() {
+    _map.clear();
+    _slots.clear();
+    _pool.clear();
+    _last_accessed.invalidate();
+  }
+
+  /// Requests shrinkage of the cache to the given size.
+  ///
+  /// If the size is greater than the current size, this is a no-op. Otherwise,
+  /// approximately least recently used keys are evicted until the size of the
+  /// cache is reduced to the given size.
+  ///
+  /// \param new_size The size to (maybe) shrink to.
+  void shrink(size_t new_size) {
+    if (new_size == 0) {
+      clear();
+      return;
+    }
+
+    while (size() > new_size) {
+      _evict();
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // SCAN INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// \copydoc BaseCache::scan()
+  ScanGuard<ApproximateCache> scan() {
+    return ScanGuard<ApproximateCache>(*this);
+  }
+
+  /// \copydoc BaseCache::begin_scan()
+  void begin_scan() const noexcept {
+    _scan_depth += 1;
+  }
+
+  /// \copydoc BaseCache::end_scan()
+  void end_scan() const noexcept {
+    assert(_scan_depth > 0);
+    _scan_depth -= 1;
+  }
+
+  /// \copydoc BaseCache::is_scanning()
+  bool is_scanning() const noexcept {
+    return _scan_depth > 0;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // SIZE AND CAPACITY INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// \returns The number of keys present in the cache.
+  size_t size() const noexcept {
+    return _map.size();
+  }
+
+  /// Sets the capacity of the cache to the given value.
+  ///
+  /// If the given capacity is less than the current size of the cache, keys
+  /// are evicted until the size equals the capacity.
+  ///
+  /// \param new_capacity The capacity to shrink or grow to.
+  void capacity(size_t new_capacity) {
+    shrink(new_capacity);
+    _capacity = new_capacity;
+  }
+
+  /// \returns The current capacity of the cache.
+  size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+  /// \returns The number of slots left in the cache.
+  size_t space_left() const noexcept {
+    return _capacity - size();
+  }
+
+  /// \returns True if the cache contains no elements, else false.
+  bool is_empty() const noexcept {
+    return size() == 0;
+  }
+
+  /// \returns True if the cache's size equals its capacity, else false.
+  bool is_full() const noexcept {
+    return size() == _capacity;
+  }
+
+  /// Sets the number of keys sampled per eviction.
+  ///
+  /// More samples approximate LRU more closely, at the cost of slower
+  /// evictions. Redis' default of five is usually a good trade-off.
+  ///
+  /// \param new_samples The number of keys to sample (at least one).
+  void samples(size_t new_samples) noexcept {
+    _samples = std::max<size_t>(new_samples, 1);
+  }
+
+  /// \returns The number of keys sampled per eviction.
+  size_t samples() const noexcept {
+    return _samples;
+  }
+
+  /// Sets the number of eviction candidates remembered between evictions.
+  ///
+  /// \param new_pool_size The size of the pool of candidates (at least one).
+  void pool_size(size_t new_pool_size) {
+    _pool_size = std::max<size_t>(new_pool_size, 1);
+    if (_pool.size() > _pool_size) {
+      // The youngest candidates are at the front.
+      _pool.erase(_pool.begin(), _pool.end() - _pool_size);
+    }
+  }
+
+  /// \returns The number of eviction candidates remembered between evictions.
+  size_t pool_size() const noexcept {
+    return _pool_size;
+  }
+
+  /// \returns The function used to hash keys.
+  HashFunction hash_function() const {
+    return _map.hash_function();
+  }
+
+  /// \returns The function used to compare keys.
+  KeyEqual key_equal() const {
+    return _map.key_eq();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // STATISTICS INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// \copydoc BaseCache::monitor(const StatisticsPointer&)
+  void monitor(const StatisticsPointer& statistics) {
+    _stats = statistics;
+  }
+
+  /// \copydoc BaseCache::monitor(StatisticsPointer&&)
+  void monitor(StatisticsPointer&& statistics) {
+    _stats = std::move(statistics);
+  }
+
+  /// \copydoc BaseCache::monitor(Args&&...)
+  template <typename... Args,
+            typename = std::enable_if_t<
+                Internal::none_of_type<StatisticsPointer, Args...>>>
+  void monitor(Args&&... args) {
+    _stats = std::make_shared<Statistics<Key>>(std::forward<Args>(args)...);
+  }
+
+  /// Stops any monitoring being performed with a statistics object.
+  void stop_monitoring() {
+    _stats.reset();
+  }
+
+  /// \returns True if the cache is currently monitoring statistics, else
+  /// false.
+  bool is_monitoring() const noexcept {
+    return _stats.has_stats();
+  }
+
+  /// \returns The statistics object currently in use by the cache.
+  /// \throws LRU::Error::NotMonitoring if the cache is currently not
+  /// monitoring.
+  Statistics<Key>& stats() {
+    if (!is_monitoring()) {
+      throw LRU::Error::NotMonitoring();
+    }
+    return _stats.get();
+  }
+
+  /// \copydoc stats()
+  const Statistics<Key>& stats() const {
+    if (!is_monitoring()) {
+      throw LRU::Error::NotMonitoring();
+    }
+    return _stats.get();
+  }
+
+  /// \returns A `shared_ptr` to the statistics currently in use by the cache.
+  StatisticsPointer& shared_stats() {
+    return _stats.shared();
+  }
+
+  /// \returns A `shared_ptr` to the statistics currently in use by the cache.
+  const StatisticsPointer& shared_stats() const {
+    return _stats.shared();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // CALLBACK INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// Registers a new hit callback.
+  ///
+  /// \param hit_callback The hit callback function to register with the cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<HitCallback, Callback>>
+  void hit_callback(Callback&& hit_callback) {
+    _callback_manager.hit_callback(std::forward<Callback>(hit_callback));
+  }
+
+  /// Registers a new miss callback.
+  ///
+  /// \param miss_callback The miss callback function to register with the
+  ///                       cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<MissCallback, Callback>>
+  void miss_callback(Callback&& miss_callback) {
+    _callback_manager.miss_callback(std::forward<Callback>(miss_callback));
+  }
+
+  /// Registers a new access callback.
+  ///
+  /// \param access_callback The access callback function to register with the
+  ///                        cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<AccessCallback, Callback>>
+  void access_callback(Callback&& access_callback) {
+    _callback_manager.access_callback(std::forward<Callback>(access_callback));
+  }
+
+  /// Removes the access callbacks satisfying a predicate.
+  ///
+  /// \param predicate A function taking an access callback and returning
+  ///                  true if it should be removed.
+  template <typename Predicate>
+  void remove_access_callbacks(Predicate predicate) {
+    _callback_manager.remove_access_callbacks(predicate);
+  }
+
+  /// Clears all callbacks.
+  void clear_all_callbacks() {
+    _callback_manager.clear();
+  }
+
+  /// \returns All hit callbacks.
+  const HitCallbackContainer& hit_callbacks() const noexcept {
+    return _callback_manager.hit_callbacks();
+  }
+
+  /// \returns All miss callbacks.
+  const MissCallbackContainer& miss_callbacks() const noexcept {
+    return _callback_manager.miss_callbacks();
+  }
+
+  /// \returns All access callbacks.
+  const AccessCallbackContainer& access_callbacks() const noexcept {
+    return _callback_manager.access_callbacks();
+  }
+
+ private:
+  /// A key remembered as a candidate for eviction.
+  struct Candidate {
+    Candidate(const Key& key_, Tick tick_) : key(key_), tick(tick_) {
+    }
+
+    /// The key of the candidate.
+    Key key;
+
+    /// The tick of the key at the time it was sampled. If the key has been
+    /// accessed since, its tick will differ and the candidate is stale.
+    Tick tick;
+  };
+
+  /// Looks up a key and registers a hit or miss.
+  ///
+  /// \param key The key to look for.
+  /// \returns An iterator to the key, or the end iterator.
+  MapConstIterator _find(const Key& key) const {
+    auto iterator = _map.find(key);
+    if (iterator != _map.end()) {
+      _touch(iterator->second);
+      _register_hit(key, iterator->second.value);
+      _last_accessed = iterator;
+    } else {
+      _register_miss(key);
+    }
+
+    return iterator;
+  }
+
+  /// Inserts a key that is not yet present in the cache.
+  ///
+  /// If the cache is full, a key is evicted first, so that the new key is never
+  /// a candidate for its own eviction.
+  ///
+  /// \param key The key to insert.
+  /// \param value The value to insert with the key.
+  template <typename K, typename V>
+  void _insert_new_key(K&& key, V&& value) {
+    if (size() >= _capacity) {
+      _evict();
+    }
+
+    // Keys inserted during a scan start out as old as a key can be.
+    const Tick tick = is_scanning() ? _clock - _oldest_age() : ++_clock;
+
+    auto result = _map.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(std::forward<K>(key)),
+        std::forward_as_tuple(std::forward<V>(value), tick, _slots.size()));
+    assert(result.second);
+
+    _slots.push_back(&*result.first);
+    _last_accessed = result.first;
+    _register_insertion();
+
+    // Sampling would rarely find the single scanned key among all others, so
+    // we make it the next candidate for eviction right away.
+    if (is_scanning()) {
+      _offer(result.first->first, tick);
+    }
+  }
+
+  /// Marks the key of the information as used just now.
+  ///
+  /// Accesses made during a scan do not count as uses.
+  ///
+  /// \param information The information of the key that was used.
+  void _touch(const Information& information) const noexcept {
+    if (is_scanning()) return;
+    information.tick = ++_clock;
+  }
+
+  /// \returns The greatest age a key can have before its tick wraps around.
+  static constexpr Tick _oldest_age() noexcept {
+    return std::numeric_limits<Tick>::max() / 2;
+  }
+
+  /// \returns The number of accesses since the given tick.
+  /// \param tick The tick to compute the age of.
+  Tick _age(Tick tick) const noexcept {
+    // Unsigned arithmetic does the right thing across wrap-arounds.
+    return _clock - tick;
+  }
+
+  /// Evicts the least recently used key among the candidates.
+  void _evict() {
+    assert(!is_empty());
+
+    while (true) {
+      _populate_pool();
+
+      // The oldest candidates are at the back of the pool.
+      while (!_pool.empty()) {
+        auto candidate = std::move(_pool.back());
+        _pool.pop_back();
+
+        // Skip candidates that were erased or used since they were sampled.
+        auto iterator = _map.find(candidate.key);
+        if (iterator != _map.end() && iterator->second.tick == candidate.tick) {
+          _register_eviction();
+          _erase(iterator);
+          return;
+        }
+      }
+    }
+  }
+
+  /// Samples random keys and offers them to the pool of candidates.
+  void _populate_pool() {
+    for (size_t sample = 0; sample < _samples; ++sample) {
+      const Node* node = _slots[_random.below(_slots.size())];
+      _offer(node->first, node->second.tick);
+    }
+  }
+
+  /// Adds a key to the pool of candidates if it is older than the youngest.
+  ///
+  /// The pool is kept sorted by age, with the youngest candidate at the front.
+  /// Since all ages grow at the same rate, the order remains valid over time.
+  ///
+  /// \param key The key to offer.
+  /// \param tick The current tick of the key.
+  void _offer(const Key& key, Tick tick) {
+    const auto equal = _map.key_eq();
+    auto existing = std::find_if(
+        _pool.begin(), _pool.end(), [&equal, &key](const Candidate& candidate) {
+          return equal(candidate.key, key);
+        });
+
+    if (existing != _pool.end()) {
+      if (existing->tick == tick) return;
+      _pool.erase(existing);
+    }
+
+    const auto age = _age(tick);
+    if (_pool.size() == _pool_size) {
+      if (age <= _age(_pool.front().tick)) return;
+      _pool.erase(_pool.begin());
+    }
+
+    auto position = std::find_if(
+        _pool.begin(), _pool.end(), [this, age](const Candidate& candidate) {
+          return _age(candidate.tick) >= age;
+        });
+
+    _pool.emplace(position, key, tick);
+  }
+
+  /// Erases the element pointed to by the iterator.
+  ///
+  /// The slot of the erased key is filled with the last slot, so that the array
+  /// of entries stays dense.
+  ///
+  /// \param iterator The iterator pointing to the key to erase.
+  void _erase(MapIterator iterator) {
+    if (_last_accessed == iterator) {
+      _last_accessed.invalidate();
+    }
+
+    const auto index = iterator->second.index;
+    _slots[index] = _slots.back();
+    _slots[index]->second.index = index;
+    _slots.pop_back();
+
+    _map.erase(iterator);
+  }
+
+  /// Re-creates the array of entries from the map.
+  ///
+  /// After a copy, the array points to the entries of the other cache's map.
+  void _reassign_slots() {
+    _slots.assign(_map.size(), nullptr);
+    for (auto& node : _map) {
+      _slots[node.second.index] = &node;
+    }
+  }
+
+  /// The map from keys to information objects.
+  Map _map;
+
+  /// The flat array of entries, sampled for eviction candidates.
+  std::vector<Node*> _slots;
+
+  /// The best eviction candidates seen so far, youngest first.
+  std::vector<Candidate> _pool;
+
+  /// The last-accessed cache object.
+  mutable LastAccessed _last_accessed;
+
+  /// The current capacity of the cache.
+  size_t _capacity;
+
+  /// The number of keys sampled per eviction.
+  size_t _samples;
+
+  /// The maximum number of candidates in the pool.
+  size_t _pool_size;
+
+  /// The logical clock, advanced on every access.
+  mutable Tick _clock;
+
+  /// The random number generator used to sample keys.
+  Internal::FastRandom _random;
+
+  /// The number of scans currently in progress.
+  mutable size_t _scan_depth = 0;
+};
+
+namespace Lowercase {
+template <typename... Ts>
+using approximate_cache = ApproximateCache<Ts...>;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_APPROXIMATE_CACHE_HPP
@@ -26,12 +26,20 @@ namespace LRU {
 namespace Tag {
 struct BasicCache {};
 struct TimedCache {};
+struct ApproximateCache {};
+struct PriorityCache {};
+struct PartitionedCache {};
+struct LfuCache {};
 }  // namespace Tag
 
 namespace Lowercase {
 namespace tag {
 using basic_cache = ::LRU::Tag::BasicCache;
 using timed_cache = ::LRU::Tag::TimedCache;
+using approximate_cache = ::LRU::Tag::ApproximateCache;
+using priority_cache = ::LRU::Tag::PriorityCache;
+using partitioned_cache = ::LRU::Tag::PartitionedCache;
+using lfu_cache = ::LRU::Tag::LfuCache;
 }  // namespace tag
 }  // namespace Lowercase
 
@@ -33,6 +33,7 @@
 
 #include <lru/cache-tags.hpp>
 #include <lru/error.hpp>
+#include <lru/hash.hpp>
 #include <lru/internal/base-cache.hpp>
 #include <lru/internal/information.hpp>
 #include <lru/internal/last-accessed.hpp>
@@ -42,13 +43,17 @@ namespace Internal {
 template <typename Key,
           typename Value,
           typename HashFunction,
-          typename KeyEqual>
+          typename KeyEqual,
+          typename Hooks,
+          typename Tracking>
 using UntimedCacheBase = Internal::BaseCache<Key,
                                              Value,
                                              Internal::Information,
                                              HashFunction,
                                              KeyEqual,
-                                             Tag::BasicCache>;
+                                             Tag::BasicCache,
+                                             Hooks,
+                                             Tracking>;
 }  // namespace Internal
 
 /// A basic LRU cache implementation.
@@ -64,12 +69,19 @@ using UntimedCacheBase = Internal::BaseCache<Key,
 /// \see LRU::TimedCache
 template <typename Key,
           typename Value,
-          typename HashFunction = std::hash<Key>,
-          typename KeyEqual = std::equal_to<Key>>
-class Cache
-    : public Internal::UntimedCacheBase<Key, Value, HashFunction, KeyEqual> {
+          typename HashFunction = DefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Hooks = NoHooks,
+          typename Tracking = NoTracking>
+class Cache : public Internal::UntimedCacheBase<Key,
+                                                Value,
+                                                HashFunction,
+                                                KeyEqual,
+                                                Hooks,
+                                                Tracking> {
  private:
-  using super = Internal::UntimedCacheBase<Key, Value, HashFunction, KeyEqual>;
+  using super = Internal::
+      UntimedCacheBase<Key, Value, HashFunction, KeyEqual, Hooks, Tracking>;
   using PRIVATE_BASE_CACHE_MEMBERS;
 
  public:
@@ -150,10 +162,11 @@ class Cache
 
   /// \copydoc BaseCache::find(const Key&)
   UnorderedIterator find(const Key& key) override {
+    auto timer = _time(Operation::Find);
     auto iterator = _map.find(key);
     if (iterator != _map.end()) {
       _register_hit(key, iterator->second.value);
-      _move_to_front(iterator->second.order);
+      _promote(iterator->second);
       _last_accessed = iterator;
     } else {
       _register_miss(key);
@@ -164,10 +177,11 @@ class Cache
 
   /// \copydoc BaseCache::find(const Key&) const
   UnorderedConstIterator find(const Key& key) const override {
+    auto timer = _time(Operation::Find);
     auto iterator = _map.find(key);
     if (iterator != _map.end()) {
       _register_hit(key, iterator->second.value);
-      _move_to_front(iterator->second.order);
+      _promote(iterator->second);
       _last_accessed = iterator;
     } else {
       _register_miss(key);
@@ -177,7 +191,7 @@ class Cache
   }
 
   /// \returns The most-recently inserted element.
-  const Key& front() const noexcept {
+  const Key& front() const {
     if (is_empty()) {
       throw LRU::Error::EmptyCache("front");
     } else {
@@ -187,7 +201,7 @@ class Cache
   }
 
   /// \returns The least-recently inserted element.
-  const Key& back() const noexcept {
+  const Key& back() const {
     if (is_empty()) {
       throw LRU::Error::EmptyCache("back");
     } else {
@@ -0,0 +1,376 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_CAPACITY_CONTROLLER_HPP
+#define LRU_CAPACITY_CONTROLLER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <lru/internal/definitions.hpp>
+#include <lru/internal/shadow-stack.hpp>
+
+namespace LRU {
+
+/// Distributes a global memory budget among several caches.
+///
+/// Hand-picked capacities are rarely right. The controller instead measures,
+/// for every cache it manages, how many hits the cache would gain by growing
+/// one step and how many it would lose by shrinking one step. It does so by
+/// replaying (a hash-sampled fraction of) each cache's lookups against a
+/// shadow LRU stack, fed through an access callback. Every call to
+/// `rebalance()` then moves capacity from the cache with the lowest marginal
+/// loss to the cache with the highest marginal gain (per unit of cost), grows
+/// caches into unused budget and shrinks them if the budget is exceeded.
+///
+/// Managed caches must outlive the controller, which removes its access
+/// callbacks from them when it is destroyed. Since the simulation only sees
+/// lookups, it assumes that every miss is followed by an insertion.
+///
+/// Managed caches may dispatch their callbacks asynchronously: each simulation
+/// is guarded by its own mutex, so it may be fed on the dispatcher thread while
+/// `rebalance()` runs on the owner's. Capacities themselves are still only
+/// changed on the thread calling `rebalance()`.
+class CapacityController {
+ public:
+  using size_t = std::size_t;
+
+  /// Constructor.
+  ///
+  /// \param budget The total budget, in the same unit as the cost per entry of
+  ///               the managed caches (e.g. bytes, or simply entries).
+  /// \param sampling_rate The fraction of keys to simulate, in `(0, 1]`.
+  explicit CapacityController(
+      size_t budget,
+      double sampling_rate = Internal::DEFAULT_SHADOW_SAMPLING_RATE)
+  : _budget(budget), _sampling_rate(sampling_rate) {
+  }
+
+  /// The controller is not copyable, since a cache feeds only one controller.
+  CapacityController(const CapacityController&) = delete;
+  CapacityController& operator=(const CapacityController&) = delete;
+
+  /// Move constructor.
+  ///
+  /// \param other The controller to take over the managed caches from.
+  CapacityController(CapacityController&& other) noexcept
+  : _caches(std::move(other._caches))
+  , _budget(other._budget)
+  , _sampling_rate(other._sampling_rate) {
+    other._caches.clear();
+  }
+
+  /// Move assignment operator. Releases the caches managed so far.
+  ///
+  /// \param other The controller to take over the managed caches from.
+  CapacityController& operator=(CapacityController&& other) {
+    if (this != &other) {
+      _release();
+      _caches = std::move(other._caches);
+      _budget = other._budget;
+      _sampling_rate = other._sampling_rate;
+      other._caches.clear();
+    }
+
+    return *this;
+  }
+
+  /// Destructor, removing the access callbacks from all managed caches.
+  ~CapacityController() {
+    _release();
+  }
+
+  /// Puts a cache under the control of the controller.
+  ///
+  /// \param cache The cache to manage.
+  /// \param cost_per_entry The cost of one entry of the cache.
+  /// \param minimum The capacity below which the cache is never shrunk.
+  template <template <typename...> class CacheTemplate,
+            typename Key,
+            typename... Rest>
+  void manage(CacheTemplate<Key, Rest...>& cache,
+              size_t cost_per_entry = 1,
+              size_t minimum = 1) {
+    using HashFunction = decltype(cache.hash_function());
+    using KeyEqual = decltype(cache.key_equal());
+    using Shadow = Internal::ShadowStack<Key, HashFunction, KeyEqual>;
+
+    auto shadow = std::make_shared<Shadow>(
+        _sampling_rate, cache.hash_function(), cache.key_equal());
+    cache.access_callback(Feed<Shadow>{shadow});
+
+    Managed managed;
+    managed.release = [&cache, feeding = shadow.get()] {
+      cache.remove_access_callbacks([feeding](const auto& callback) {
+        auto feed = callback.template target<Feed<Shadow>>();
+        return feed != nullptr && feed->shadow.get() == feeding;
+      });
+    };
+    managed.get_capacity = [&cache] { return cache.capacity(); };
+    managed.set_capacity = [&cache](size_t capacity) {
+      cache.capacity(capacity);
+    };
+    managed.shadow = std::move(shadow);
+    managed.cost = std::max<size_t>(cost_per_entry, 1);
+    managed.minimum = minimum;
+
+    managed.shadow->resize(cache.capacity(), _step(cache.capacity()));
+    _caches.push_back(std::move(managed));
+  }
+
+  /// Re-distributes the budget among the managed caches.
+  ///
+  /// Meant to be called periodically (e.g. every few seconds or every few
+  /// thousand requests). Each call changes capacities by at most one step per
+  /// cache and then halves the measured hit counts, so that the controller
+  /// follows shifts in the workload.
+  void rebalance() {
+    if (_caches.empty()) return;
+
+    _enforce_budget();
+    if (!_grow_into_free_budget()) {
+      _trade();
+    }
+
+    for (auto& managed : _caches) {
+      managed.shadow->decay();
+    }
+  }
+
+  /// Sets the total budget.
+  ///
+  /// \param new_budget The new budget.
+  void budget(size_t new_budget) noexcept {
+    _budget = new_budget;
+  }
+
+  /// \returns The total budget.
+  size_t budget() const noexcept {
+    return _budget;
+  }
+
+  /// \returns The part of the budget currently allocated to managed caches.
+  size_t allocated() const {
+    size_t total = 0;
+    for (const auto& managed : _caches) {
+      total += managed.get_capacity() * managed.cost;
+    }
+
+    return total;
+  }
+
+  /// \returns The number of managed caches.
+  size_t managed() const noexcept {
+    return _caches.size();
+  }
+
+ private:
+  /// The access callback feeding a cache's lookups into its simulation.
+  ///
+  /// \tparam Shadow The type of the simulation.
+  template <typename Shadow>
+  struct Feed {
+    template <typename Key>
+    void operator()(const Key& key, bool) const {
+      shadow->access(key);
+    }
+
+    /// The simulation.
+    std::shared_ptr<Shadow> shadow;
+  };
+
+  /// The bookkeeping for a managed cache.
+  struct Managed {
+    /// Returns the capacity of the cache.
+    std::function<size_t()> get_capacity;
+
+    /// Sets the capacity of the cache.
+    std::function<void(size_t)> set_capacity;
+
+    /// Removes the access callback from the cache.
+    std::function<void()> release;
+
+    /// The simulation of the cache's marginal hits.
+    std::shared_ptr<Internal::AbstractShadowStack> shadow;
+
+    /// The cost of one entry of the cache.
+    size_t cost;
+
+    /// The capacity below which the cache is never shrunk.
+    size_t minimum;
+  };
+
+  /// Removes the access callbacks from all managed caches.
+  void _release() {
+    for (auto& managed : _caches) {
+      managed.release();
+    }
+  }
+
+  /// Shrinks the caches with the lowest marginal loss until the allocation
+  /// fits the budget.
+  void _enforce_budget() {
+    while (allocated() > _budget) {
+      auto donor = _lowest_loss(_caches.size());
+      if (donor == _caches.size()) return;
+
+      auto& managed = _caches[donor];
+      const auto capacity = managed.get_capacity();
+      const auto overshoot = allocated() - _budget;
+      const auto excess = (overshoot + managed.cost - 1) / managed.cost;
+      const auto entries = std::max(excess, _step(capacity));
+      _resize(managed, capacity - std::min(entries, _shrinkable(managed)));
+    }
+  }
+
+  /// Grows the caches with the highest marginal gain into unused budget.
+  ///
+  /// \returns True if any cache grew, else false.
+  bool _grow_into_free_budget() {
+    std::vector<size_t> order(_caches.size());
+    for (size_t index = 0; index < order.size(); ++index) {
+      order[index] = index;
+    }
+
+    std::sort(order.begin(), order.end(), [this](size_t first, size_t second) {
+      return _gain(_caches[first]) > _gain(_caches[second]);
+    });
+
+    bool grew = false;
+    for (auto index : order) {
+      auto& managed = _caches[index];
+      if (managed.shadow->ghost_hits() == 0) break;
+
+      const auto capacity = managed.get_capacity();
+      const auto step = _step(capacity);
+      if (allocated() + step * managed.cost > _budget) continue;
+
+      _resize(managed, capacity + step);
+      grew = true;
+    }
+
+    return grew;
+  }
+
+  /// Moves one step of capacity from the cache with the lowest marginal loss
+  /// to the cache with the highest marginal gain, if that pays off.
+  void _trade() {
+    size_t recipient = 0;
+    for (size_t index = 1; index < _caches.size(); ++index) {
+      if (_gain(_caches[index]) > _gain(_caches[recipient])) {
+        recipient = index;
+      }
+    }
+
+    auto& receiving = _caches[recipient];
+    if (receiving.shadow->ghost_hits() == 0) return;
+
+    const auto donor = _lowest_loss(recipient);
+    if (donor == _caches.size()) return;
+
+    auto& donating = _caches[donor];
+    if (_loss(donating) >= _gain(receiving)) return;
+
+    const auto capacity = receiving.get_capacity();
+    const auto step = _step(capacity);
+    const auto units = step * receiving.cost;
+    const auto entries = (units + donating.cost - 1) / donating.cost;
+    if (entries > _shrinkable(donating)) return;
+
+    _resize(donating, donating.get_capacity() - entries);
+    _resize(receiving, capacity + step);
+  }
+
+  /// Finds the cache with the lowest marginal loss that can still shrink.
+  ///
+  /// \param excluded The index of a cache not to consider.
+  /// \returns The index of the cache, or the number of caches if there is none.
+  size_t _lowest_loss(size_t excluded) const {
+    auto best = _caches.size();
+    for (size_t index = 0; index < _caches.size(); ++index) {
+      if (index == excluded || _shrinkable(_caches[index]) == 0) continue;
+      if (best == _caches.size() ||
+          _loss(_caches[index]) < _loss(_caches[best])) {
+        best = index;
+      }
+    }
+
+    return best;
+  }
+
+  /// \returns The hits gained per unit of cost by growing the cache one step.
+  /// \param managed The managed cache.
+  double _gain(const Managed& managed) const {
+    const auto step = _step(managed.get_capacity());
+    return static_cast<double>(managed.shadow->ghost_hits()) /
+           (step * managed.cost);
+  }
+
+  /// \returns The hits lost per unit of cost by shrinking the cache one step.
+  /// \param managed The managed cache.
+  double _loss(const Managed& managed) const {
+    const auto step = _step(managed.get_capacity());
+    return static_cast<double>(managed.shadow->tail_hits()) /
+           (step * managed.cost);
+  }
+
+  /// \returns The number of entries by which the cache may still shrink.
+  /// \param managed The managed cache.
+  static size_t _shrinkable(const Managed& managed) {
+    const auto capacity = managed.get_capacity();
+    return (capacity > managed.minimum) ? capacity - managed.minimum : 0;
+  }
+
+  /// Sets the capacity of a managed cache and of its simulation.
+  ///
+  /// \param managed The managed cache.
+  /// \param capacity The new capacity.
+  static void _resize(Managed& managed, size_t capacity) {
+    managed.set_capacity(capacity);
+    managed.shadow->resize(capacity, _step(capacity));
+  }
+
+  /// \returns The step by which to resize a cache of the given capacity.
+  /// \param capacity The capacity of the cache.
+  static size_t _step(size_t capacity) noexcept {
+    return std::max<size_t>(capacity / Internal::CAPACITY_STEP_DIVISOR, 1);
+  }
+
+  /// The managed caches.
+  std::vector<Managed> _caches;
+
+  /// The total budget.
+  size_t _budget;
+
+  /// The fraction of keys simulated.
+  double _sampling_rate;
+};
+
+namespace Lowercase {
+using capacity_controller = CapacityController;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_CAPACITY_CONTROLLER_HPP
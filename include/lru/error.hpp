@@ -91,6 +91,14 @@ struct NotMonitoring : public std::runtime_error {
   }
 };
 
+/// Exception thrown when a cache is configured with an invalid argument (e.g.
+/// a priority class the cache does not have).
+struct InvalidArgument : public std::invalid_argument {
+  using super = std::invalid_argument;
+  explicit InvalidArgument(const std::string& what) : super(what) {
+  }
+};
+
 namespace Lowercase {
 using key_not_found = KeyNotFound;
 using key_expired = KeyExpired;
@@ -99,6 +107,7 @@ using invalid_iterator_conversion = InvalidIteratorConversion;
 using invalid_iterator = InvalidIterator;
 using unmonitored_key = UnmonitoredKey;
 using not_monitoring = NotMonitoring;
+using invalid_argument = InvalidArgument;
 }  // namespace Lowercase
 
 }  // namespace Error
@@ -0,0 +1,226 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_HASH_HPP
+#define LRU_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#include <lru/internal/hash.hpp>
+
+namespace LRU {
+namespace Internal {
+
+/// \returns Eight bytes read from an unaligned address.
+inline std::uint64_t read64(const unsigned char* bytes) noexcept {
+  std::uint64_t value;
+  std::memcpy(&value, bytes, sizeof value);
+  return value;
+}
+
+/// \returns Four bytes read from an unaligned address.
+inline std::uint64_t read32(const unsigned char* bytes) noexcept {
+  std::uint32_t value;
+  std::memcpy(&value, bytes, sizeof value);
+  return value;
+}
+
+/// Hashes a range of bytes.
+///
+/// This follows the structure of wyhash: sixteen bytes are folded into the
+/// state per 128 bit multiplication, and short inputs (the common case for
+/// keys) are read with at most four overlapping loads and no loop at all.
+///
+/// \param data A pointer to the first byte.
+/// \param length The number of bytes to hash.
+/// \returns The hash of the bytes.
+inline std::uint64_t hash_bytes(const void* data, std::size_t length) noexcept {
+  auto bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t seed = HASH_SECRET_0;
+  std::uint64_t a, b;
+
+  if (length <= 16) {
+    if (length >= 4) {
+      const auto offset = (length >> 3) << 2;
+      a = (read32(bytes) << 32) | read32(bytes + offset);
+      b = (read32(bytes + length - 4) << 32) |
+          read32(bytes + length - 4 - offset);
+    } else if (length > 0) {
+      a = (std::uint64_t(bytes[0]) << 16) |
+          (std::uint64_t(bytes[length >> 1]) << 8) | bytes[length - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    auto remaining = length;
+    for (; remaining > 16; remaining -= 16, bytes += 16) {
+      seed = mum(read64(bytes) ^ HASH_SECRET_1, read64(bytes + 8) ^ seed);
+    }
+    a = read64(bytes + remaining - 16);
+    b = read64(bytes + remaining - 8);
+  }
+
+  return mum(HASH_SECRET_1 ^ length, mum(a ^ HASH_SECRET_1, b ^ seed));
+}
+
+/// Scrambles an integer so that every input bit affects every output bit.
+///
+/// \param value The integer to mix.
+/// \returns The mixed integer.
+inline std::uint64_t mix(std::uint64_t value) noexcept {
+  return mum(value ^ HASH_SECRET_0, HASH_SECRET_1);
+}
+
+}  // namespace Internal
+
+/// A fast hash function for common key types.
+///
+/// `std::hash` is the identity for integers on common standard libraries,
+/// which maps regularly spaced keys to the same few buckets of a power of two
+/// table, and a comparatively slow byte-wise loop for strings. `LRU::Hash`
+/// instead
+///
+/// - mixes integers, enums and pointers with a single 128 bit multiplication,
+/// - hashes strings (and string views) sixteen bytes per multiplication,
+/// - combines the elements of tuples and pairs with the same hashes,
+///
+/// and falls back to `std::hash` for every other type, so custom `std::hash`
+/// specializations keep working.
+///
+/// This is the default hash function of all caches unless `LRU_USE_STD_HASH`
+/// is defined before including the library. Hash values are not stable
+/// across platforms or versions and must not be persisted.
+///
+/// \tparam T The type of the values to hash.
+template <typename T, typename = void>
+struct Hash : std::hash<T> {};
+
+/// Integers and enums.
+template <typename T>
+struct Hash<T,
+            std::enable_if_t<std::is_integral<T>::value ||
+                             std::is_enum<T>::value>> {
+  std::size_t operator()(T value) const noexcept {
+    return static_cast<std::size_t>(
+        Internal::mix(static_cast<std::uint64_t>(value)));
+  }
+};
+
+/// Pointers.
+template <typename T>
+struct Hash<T*> {
+  std::size_t operator()(T* pointer) const noexcept {
+    return static_cast<std::size_t>(
+        Internal::mix(reinterpret_cast<std::uintptr_t>(pointer)));
+  }
+};
+
+// The string hashes are deliberately not `noexcept`: libstdc++ caches the hash
+// codes of keys in the nodes of `std::unordered_map` only for hash functions
+// that may throw (or are known to be slow), and rehashing strings is costly.
+
+/// Strings.
+template <typename Char, typename Traits, typename Allocator>
+struct Hash<std::basic_string<Char, Traits, Allocator>> {
+  std::size_t
+  operator()(const std::basic_string<Char, Traits, Allocator>& string) const {
+    return static_cast<std::size_t>(
+        Internal::hash_bytes(string.data(), string.size() * sizeof(Char)));
+  }
+};
+
+#if __cplusplus >= 201703L
+/// String views.
+template <typename Char, typename Traits>
+struct Hash<std::basic_string_view<Char, Traits>> {
+  std::size_t operator()(std::basic_string_view<Char, Traits> string) const {
+    return static_cast<std::size_t>(
+        Internal::hash_bytes(string.data(), string.size() * sizeof(Char)));
+  }
+};
+#endif
+
+namespace Internal {
+
+/// Hashes any value with `LRU::Hash`.
+struct FastHasher {
+  template <typename T>
+  std::size_t operator()(const T& value) const {
+    return Hash<T>{}(value);
+  }
+};
+
+}  // namespace Internal
+
+/// Tuples, hashed element by element (without copying).
+template <typename... Ts>
+struct Hash<std::tuple<Ts...>> {
+  std::size_t operator()(const std::tuple<Ts...>& tuple) const {
+    return static_cast<std::size_t>(
+        Internal::hash_tuple(tuple,
+                             std::make_index_sequence<sizeof...(Ts)>(),
+                             Internal::FastHasher()));
+  }
+};
+
+/// Pairs.
+template <typename First, typename Second>
+struct Hash<std::pair<First, Second>> {
+  std::size_t operator()(const std::pair<First, Second>& pair) const {
+    const auto first = Internal::FastHasher()(pair.first);
+    const auto second = Internal::FastHasher()(pair.second);
+    return static_cast<std::size_t>(
+        Internal::hash_combine(Internal::hash_combine(2, first), second));
+  }
+};
+
+/// The hash function caches use when none is given.
+#ifdef LRU_USE_STD_HASH
+template <typename Key>
+using DefaultHash = std::hash<Key>;
+#else
+template <typename Key>
+using DefaultHash = Hash<Key>;
+#endif
+
+namespace Lowercase {
+template <typename T>
+using hash = Hash<T>;
+
+template <typename Key>
+using default_hash = DefaultHash<Key>;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_HASH_HPP
@@ -0,0 +1,258 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_HEAVY_HITTERS_HPP
+#define LRU_HEAVY_HITTERS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+#include <lru/error.hpp>
+#include <lru/hash.hpp>
+#include <lru/internal/frequency-buckets.hpp>
+
+namespace LRU {
+
+/// A key reported by a `HeavyHitters` tracker.
+///
+/// \tparam Key The type of the key.
+template <typename Key>
+struct HeavyHitter {
+  using size_t = std::size_t;
+
+  /// The key.
+  Key key;
+
+  /// The estimated number of occurrences of the key. Never an underestimate.
+  size_t count;
+
+  /// The maximum amount by which the count overestimates the true number of
+  /// occurrences of the key.
+  size_t error;
+
+  /// \returns The number of occurrences the key is guaranteed to have had.
+  size_t guaranteed() const noexcept {
+    return count - error;
+  }
+};
+
+/// Discovers the most frequent keys of a stream in bounded memory.
+///
+/// This is an implementation of the *Space-Saving* algorithm (Metwally et
+/// al.). It keeps at most a fixed number of counters. When a key that is not
+/// tracked occurs and all counters are taken, the key with the lowest count
+/// is replaced by the new key, which inherits that count (plus one). Counts
+/// are therefore overestimates, but by at most the inherited count, which is
+/// reported as the error. Any key occurring more than `total() / capacity()`
+/// times is guaranteed to be tracked. Recording an occurrence is O(1).
+/// Occurrences may also be recorded with a weight (the weighted variant of
+/// the algorithm), which is how sampled streams are summarized.
+///
+/// \tparam Key The type of the keys.
+/// \tparam HashFunction The hash function for keys.
+/// \tparam KeyEqual The equality comparison for keys.
+template <typename Key,
+          typename HashFunction = DefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class HeavyHitters {
+ public:
+  using size_t = std::size_t;
+  using HeavyHitterType = HeavyHitter<Key>;
+  using HeavyHitterList = std::vector<HeavyHitterType>;
+
+  /// Constructor.
+  ///
+  /// \param capacity The number of keys to track.
+  /// \param hash The hash function for keys.
+  /// \param equal The equality comparison for keys.
+  /// \throws LRU::Error::InvalidArgument if the capacity is zero.
+  explicit HeavyHitters(size_t capacity,
+                        const HashFunction& hash = HashFunction(),
+                        const KeyEqual& equal = KeyEqual())
+  : _capacity(capacity), _total(0), _handles(0, hash, equal) {
+    if (capacity == 0) {
+      throw LRU::Error::InvalidArgument(
+          "A heavy hitter tracker must track at least one key");
+    }
+  }
+
+  /// Copy constructor.
+  ///
+  /// \param other The tracker to copy.
+  HeavyHitters(const HeavyHitters& other)
+  : _capacity(other._capacity)
+  , _total(other._total)
+  , _buckets(other._buckets)
+  , _handles(0, other._handles.hash_function(), other._handles.key_eq()) {
+    _rehandle();
+  }
+
+  /// Move constructor.
+  HeavyHitters(HeavyHitters&& other) = default;
+
+  /// Copy assignment operator.
+  ///
+  /// \param other The tracker to copy.
+  HeavyHitters& operator=(const HeavyHitters& other) {
+    if (this != &other) {
+      HeavyHitters copy(other);
+      *this = std::move(copy);
+    }
+
+    return *this;
+  }
+
+  /// Move assignment operator.
+  HeavyHitters& operator=(HeavyHitters&& other) = default;
+
+  /// Records occurrences of the key.
+  ///
+  /// Recording a single occurrence is O(1). Recording several at once (e.g.
+  /// for a sampled stream) may skip over the keys with counts in between.
+  ///
+  /// \param key The key that occurred.
+  /// \param occurrences The number of times the key occurred.
+  void record(const Key& key, size_t occurrences = 1) {
+    if (occurrences == 0) return;
+    _total += occurrences;
+
+    auto iterator = _handles.find(key);
+    if (iterator != _handles.end()) {
+      _buckets.increment(iterator->second, occurrences);
+    } else if (_buckets.size() < _capacity) {
+      _handles.emplace(key, _buckets.insert(Counter{key, 0}, occurrences));
+    } else {
+      // Replace the key with the lowest count, inheriting its count.
+      auto handle = _buckets.min();
+      _handles.erase(handle->item.key);
+      handle->item = Counter{key, Buckets::count(handle)};
+      _buckets.increment(handle, occurrences);
+      _handles.emplace(key, handle);
+    }
+  }
+
+  /// \returns The (over-)estimated number of occurrences of the key, or zero
+  /// if it is not tracked.
+  /// \param key The key to look up.
+  size_t count(const Key& key) const {
+    auto iterator = _handles.find(key);
+    if (iterator == _handles.end()) return 0;
+    return Buckets::count(iterator->second);
+  }
+
+  /// \returns True if the key is currently tracked, else false.
+  /// \param key The key to look up.
+  bool contains(const Key& key) const {
+    return _handles.count(key) > 0;
+  }
+
+  /// \returns The tracked keys with the highest counts, highest first.
+  /// \param k The maximum number of keys to return.
+  HeavyHitterList top(size_t k) const {
+    HeavyHitterList list;
+    list.reserve(std::min(k, _buckets.size()));
+
+    for (auto bucket = _buckets.end(); bucket != _buckets.begin();) {
+      --bucket;
+      for (const auto& node : bucket->nodes) {
+        if (list.size() == k) return list;
+        list.push_back({node.item.key, bucket->count, node.item.error});
+      }
+    }
+
+    return list;
+  }
+
+  /// \returns The total number of occurrences recorded.
+  size_t total() const noexcept {
+    return _total;
+  }
+
+  /// \returns The number of keys currently tracked.
+  size_t size() const noexcept {
+    return _buckets.size();
+  }
+
+  /// \returns The maximum number of keys tracked.
+  size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+  /// Forgets all keys and occurrences.
+  void clear() {
+    _buckets.clear();
+    _handles.clear();
+    _total = 0;
+  }
+
+ private:
+  /// The item stored for every tracked key.
+  struct Counter {
+    /// The key.
+    Key key;
+
+    /// The count the key inherited when it replaced another key.
+    size_t error;
+  };
+
+  using Buckets = Internal::FrequencyBuckets<Counter>;
+  using Handle = typename Buckets::Handle;
+  using HandleMap = std::unordered_map<Key, Handle, HashFunction, KeyEqual>;
+
+  /// Rebuilds the map from keys to handles (after a copy).
+  void _rehandle() {
+    _handles.reserve(_buckets.size());
+    for (auto& bucket : _buckets) {
+      for (auto node = bucket.nodes.begin(); node != bucket.nodes.end();
+           ++node) {
+        _handles.emplace(node->item.key, node);
+      }
+    }
+  }
+
+  /// The maximum number of keys tracked.
+  size_t _capacity;
+
+  /// The total number of occurrences recorded.
+  size_t _total;
+
+  /// The counters, ordered by count.
+  Buckets _buckets;
+
+  /// The map from tracked keys to their counters.
+  HandleMap _handles;
+};
+
+namespace Lowercase {
+template <typename... Ts>
+using heavy_hitter = HeavyHitter<Ts...>;
+
+template <typename... Ts>
+using heavy_hitters = HeavyHitters<Ts...>;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_HEAVY_HITTERS_HPP
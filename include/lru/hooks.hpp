@@ -0,0 +1,68 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_HOOKS_HPP
+#define LRU_HOOKS_HPP
+
+namespace LRU {
+
+/// The default compile-time hooks of a cache, which do nothing.
+///
+/// Callbacks registered at runtime (via `hit_callback()` and friends) are
+/// stored as `std::function`s, so every access pays for an indirect call per
+/// callback. When the callbacks are known at compile time, they can instead be
+/// passed to `Cache` or `TimedCache` as a `Hooks` template parameter, whose
+/// `hit()` and `miss()` member functions are called directly on every access
+/// and can thus be inlined into the lookup.
+///
+/// Hooks may be stateful (the cache owns an instance, accessible via
+/// `hooks()`). Custom hooks usually derive from `NoHooks` and define only the
+/// member functions they need:
+///
+/// ```cpp
+/// struct CountMisses : LRU::NoHooks {
+///   template <typename Key>
+///   void miss(const Key&) noexcept { ++misses; }
+///
+///   std::size_t misses = 0;
+/// };
+///
+/// LRU::Cache<int, int, std::hash<int>, std::equal_to<int>, CountMisses> cache;
+/// ```
+struct NoHooks {
+  /// Called on every hit with the key and the value that was found.
+  template <typename Key, typename Value>
+  void hit(const Key&, const Value&) noexcept {
+  }
+
+  /// Called on every miss with the key that was not found.
+  template <typename Key>
+  void miss(const Key&) noexcept {
+  }
+};
+
+namespace Lowercase {
+using no_hooks = NoHooks;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_HOOKS_HPP
@@ -30,9 +30,11 @@
 #include <list>
 #include <memory>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 
+#include <lru/access-hint.hpp>
 #include <lru/insertion-result.hpp>
 #include <lru/internal/base-ordered-iterator.hpp>
 #include <lru/internal/base-unordered-iterator.hpp>
@@ -41,8 +43,12 @@
 #include <lru/internal/last-accessed.hpp>
 #include <lru/internal/optional.hpp>
 #include <lru/internal/statistics-mutator.hpp>
+#include <lru/internal/tracked-information.hpp>
 #include <lru/internal/utility.hpp>
+#include <lru/latency-statistics.hpp>
+#include <lru/memory-arbiter.hpp>
 #include <lru/statistics.hpp>
+#include <lru/tracking.hpp>
 
 namespace LRU {
 namespace Internal {
@@ -57,6 +63,7 @@ namespace Internal {
 #define PUBLIC_BASE_CACHE_MEMBERS               \
   super::is_full;                               \
   using super::is_empty;                        \
+  using super::find;                            \
   using super::clear;                           \
   using super::end;                             \
   using super::cend;                            \
@@ -81,10 +88,13 @@ namespace Internal {
   using super::_erase;                    \
   using super::_erase_lru;                \
   using super::_move_to_front;            \
+  using super::_promote;                  \
+  using super::_time;                     \
   using super::_value_from_result;        \
   using super::_last_accessed_is_ok;      \
   using super::_register_miss;            \
-  using super::_register_hit;
+  using super::_register_hit;             \
+  using super::_register_expiration;
 
 /// The base class for the LRU::Cache and LRU::TimedCache.
 ///
@@ -108,15 +118,20 @@ namespace Internal {
 /// \tparam HashFunction The hash function type for the internal map.
 /// \tparam KeyEqual The type of the key equality function for the internal map.
 /// \tparam TagType The cache tag type of the concrete derived class.
+/// \tparam Hooks The type of the compile-time hooks (see `LRU::NoHooks`).
+/// \tparam Tracking The per-key tracking policy (see `LRU::NoTracking`).
 template <typename Key,
           typename Value,
           template <typename, typename> class InformationType,
           typename HashFunction,
           typename KeyEqual,
-          typename TagType>
+          typename TagType,
+          typename Hooks = NoHooks,
+          typename Tracking = NoTracking>
 class BaseCache {
  protected:
-  using Information = InformationType<Key, Value>;
+  using Information =
+      Internal::TrackedInformation<InformationType<Key, Value>, Tracking>;
   using Queue = Internal::Queue<const Key>;
   using QueueIterator = typename Queue::const_iterator;
 
@@ -124,7 +139,7 @@ class BaseCache {
   using MapIterator = typename Map::iterator;
   using MapConstIterator = typename Map::const_iterator;
 
-  using CallbackManagerType = CallbackManager<Key, Value>;
+  using CallbackManagerType = CallbackManager<Key, Value, Hooks>;
   using HitCallback = typename CallbackManagerType::HitCallback;
   using MissCallback = typename CallbackManagerType::MissCallback;
   using AccessCallback = typename CallbackManagerType::AccessCallback;
@@ -139,6 +154,7 @@ class BaseCache {
   using Tag = TagType;
   using InitializerList = std::initializer_list<std::pair<Key, Value>>;
   using StatisticsPointer = std::shared_ptr<Statistics<Key>>;
+  using LatencyPointer = std::shared_ptr<LatencyStatistics>;
   using size_t = std::size_t;
 
   static constexpr Tag tag() noexcept {
@@ -493,7 +509,8 @@ class BaseCache {
   , _stats(other._stats)
   , _last_accessed(other._last_accessed)
   , _callback_manager(other._callback_manager)
-  , _capacity(other._capacity) {
+  , _capacity(other._capacity)
+  , _latency(other._latency) {
     _reassign_references();
   }
 
@@ -504,7 +521,10 @@ class BaseCache {
   }
 
   /// Copy assignment operator.
-  BaseCache& operator=(const BaseCache& other) noexcept {
+  ///
+  /// If the cache is arbitrated, the arbiter may evict keys (from this or
+  /// other caches) to make room for the copied contents.
+  BaseCache& operator=(const BaseCache& other) {
     if (this != &other) {
       _map = other._map;
       _order = other._order;
@@ -512,21 +532,27 @@ class BaseCache {
       _last_accessed = other._last_accessed;
       _callback_manager = other._callback_manager;
       _capacity = other._capacity;
+      _latency = other._latency;
       _reassign_references();
+      _report_size();
     }
 
     return *this;
   }
 
   /// Move assignment operator.
-  BaseCache& operator=(BaseCache&& other) noexcept {
+  ///
+  /// Like `swap()`, this may evict keys if either cache is arbitrated.
+  BaseCache& operator=(BaseCache&& other) {
     // Following the copy-swap idiom.
     swap(other);
     return *this;
   }
 
   /// Destructor.
-  virtual ~BaseCache() = default;
+  virtual ~BaseCache() {
+    stop_arbitration();
+  }
 
   /// Sets the contents of the cache to a range.
   ///
@@ -567,21 +593,31 @@ class BaseCache {
 
   /// Swaps the contents of the cache with another cache.
   ///
+  /// The arbiter links stay with the cache objects. If either cache is
+  /// arbitrated, its arbiter is told the new size afterwards and may evict
+  /// keys (from this or other caches) to stay within its budget, which
+  /// registers statistics and may allocate. Swapping caches that are not
+  /// arbitrated never throws.
+  ///
   /// \param other The other cache to swap with.
-  virtual void swap(BaseCache& other) noexcept {
+  virtual void swap(BaseCache& other) {
     using std::swap;
 
     swap(_order, other._order);
     swap(_map, other._map);
     swap(_last_accessed, other._last_accessed);
     swap(_capacity, other._capacity);
+    swap(_latency, other._latency);
+
+    _report_size();
+    other._report_size();
   }
 
   /// Swaps the contents of one cache with another cache.
   ///
   /// \param first The first cache to swap.
   /// \param second The second cache to swap.
-  friend void swap(BaseCache& first, BaseCache& second) noexcept {
+  friend void swap(BaseCache& first, BaseCache& second) {
     first.swap(second);
   }
 
@@ -788,6 +824,7 @@ class BaseCache {
       if (_last_accessed_is_ok(key)) {
         _register_hit(key, _last_accessed.value());
         // If this is the last accessed key, it's at the front anyway
+        _touch(_last_accessed.information());
         return true;
       } else {
         return false;
@@ -813,6 +850,7 @@ class BaseCache {
       auto& value = _value_for_last_accessed();
       _register_hit(key, value);
       // If this is the last accessed key, it's at the front anyway
+      _touch(_last_accessed.information());
       return value;
     }
 
@@ -840,6 +878,7 @@ class BaseCache {
       auto& value = _value_for_last_accessed();
       _register_hit(key, value);
       // If this is the last accessed key, it's at the front anyway
+      _touch(_last_accessed.information());
       return value;
     }
 
@@ -875,6 +914,38 @@ class BaseCache {
   /// exists, else the end iterator.
   virtual UnorderedConstIterator find(const Key& key) const = 0;
 
+  /// Attempts to return an iterator to the given key in the cache.
+  ///
+  /// If the access is part of a scan, the key is not moved to the front.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key whose value to look for.
+  /// \param hint The kind of access being made.
+  /// \returns An iterator pointing to the entry with the given key, if one
+  /// exists, else the end iterator.
+  /// \see LRU::AccessHint
+  UnorderedIterator find(const Key& key, AccessHint hint) {
+    if (hint == AccessHint::Normal) return find(key);
+    ScanGuard<BaseCache> guard(*this);
+    return find(key);
+  }
+
+  /// Attempts to return a const iterator to the given key in the cache.
+  ///
+  /// If the access is part of a scan, the key is not moved to the front.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key whose value to look for.
+  /// \param hint The kind of access being made.
+  /// \returns A const iterator pointing to the entry with the given key, if one
+  /// exists, else the end iterator.
+  /// \see LRU::AccessHint
+  UnorderedConstIterator find(const Key& key, AccessHint hint) const {
+    if (hint == AccessHint::Normal) return find(key);
+    ScanGuard<const BaseCache> guard(*this);
+    return find(key);
+  }
+
   /// \copydoc lookup(const Key&)
   virtual Value& operator[](const Key& key) {
     return lookup(key);
@@ -898,6 +969,7 @@ class BaseCache {
   /// key was newly inserted (true) or only updated (false) as well as an
   /// iterator pointing to the entry for the key.
   virtual InsertionResultType insert(const Key& key, const Value& value) {
+    auto timer = _time(Operation::Insert);
     if (_capacity == 0) return {false, end()};
 
     auto iterator = _map.find(key);
@@ -908,20 +980,46 @@ class BaseCache {
     // possibly pop the front if the cache has reached its capacity.
 
     if (iterator == _map.end()) {
+      _reserve_for_new_key();
       auto result = _map.emplace(key, Information(value));
       assert(result.second);
       auto order = _insert_new_key(result.first->first);
       result.first->second.order = order;
+      _stamp(result.first->second);
+      _register_insertion(result.first->second);
+      _report_size();
 
       _last_accessed = result.first;
       return {true, {*this, result.first}};
     } else {
       _move_to_front(iterator, value);
+      _register_overwrite(iterator->second);
       _last_accessed = iterator;
       return {false, {*this, iterator}};
     }
   }
 
+  /// Inserts the given `(key, value)` pair into the cache.
+  ///
+  /// If the access is part of a scan, a new key is inserted at the back of the
+  /// cache (making it the next to be evicted) and an existing key is updated
+  /// without being moved to the front.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key to insert.
+  /// \param value The value to insert with the key.
+  /// \param hint The kind of access being made.
+  /// \returns An `InsertionResult`, holding a boolean indicating whether the
+  /// key was newly inserted (true) or only updated (false) as well as an
+  /// iterator pointing to the entry for the key.
+  /// \see LRU::AccessHint
+  InsertionResultType
+  insert(const Key& key, const Value& value, AccessHint hint) {
+    if (hint == AccessHint::Normal) return insert(key, value);
+    ScanGuard<BaseCache> guard(*this);
+    return insert(key, value);
+  }
+
   /// Inserts a range of `(key, value)` pairs.
   ///
   /// If, at any point, the cache's capacity is reached, the most recently used
@@ -1042,15 +1140,20 @@ class BaseCache {
   InsertionResultType emplace(std::piecewise_construct_t _,
                               const std::tuple<Ks...>& key_arguments,
                               const std::tuple<Vs...>& value_arguments) {
+    auto timer = _time(Operation::Emplace);
     if (_capacity == 0) return {false, end()};
 
     auto key = Internal::construct_from_tuple<Key>(key_arguments);
     auto iterator = _map.find(key);
 
     if (iterator == _map.end()) {
+      _reserve_for_new_key();
       auto result = _map.emplace(std::move(key), Information(value_arguments));
       auto order = _insert_new_key(result.first->first);
       result.first->second.order = order;
+      _stamp(result.first->second);
+      _register_insertion(result.first->second);
+      _report_size();
       assert(result.second);
 
       _last_accessed = result.first;
@@ -1058,6 +1161,7 @@ class BaseCache {
     } else {
       auto value = Internal::construct_from_tuple<Value>(value_arguments);
       _move_to_front(iterator, value);
+      _register_overwrite(iterator->second);
       _last_accessed = iterator;
       return {false, {*this, iterator}};
     }
@@ -1095,15 +1199,18 @@ class BaseCache {
   /// \param key The key to erase.
   /// \returns True if the key was erased, else false.
   virtual bool erase(const Key& key) {
+    auto timer = _time(Operation::Erase);
     // No need to use _last_accessed_is_ok here, because even
     // if it has expired, it's no problem to erase it anyway
     if (_last_accessed == key) {
+      _register_erasure();
       _erase(_last_accessed.key(), _last_accessed.information());
       return true;
     }
 
     auto iterator = _map.find(key);
     if (iterator != _map.end()) {
+      _register_erasure();
       _erase(iterator);
       return true;
     }
@@ -1118,9 +1225,11 @@ class BaseCache {
   virtual void erase(UnorderedConstIterator iterator) {
     /// We have this overload to avoid the extra conversion-construction from
     /// unordered to ordered iterator (and renewed hash lookup)
+    auto timer = _time(Operation::Erase);
     if (iterator == unordered_cend()) {
       throw LRU::Error::InvalidIterator();
     } else {
+      _register_erasure();
       _erase(iterator._iterator);
     }
   }
@@ -1131,9 +1240,11 @@ class BaseCache {
   /// \param iterator The iterator whose key to erase.
   /// \throws LRU::Error::InvalidIterator if the iterator is the end iterator.
   virtual void erase(OrderedConstIterator iterator) {
+    auto timer = _time(Operation::Erase);
     if (iterator == ordered_cend()) {
       throw LRU::Error::InvalidIterator();
     } else {
+      _register_erasure();
       _erase(_map.find(iterator.key()));
     }
   }
@@ -1143,6 +1254,7 @@ class BaseCache {
     _map.clear();
     _order.clear();
     _last_accessed.invalidate();
+    _report_size();
   }
 
   /// Requests shrinkage of the cache to the given size.
@@ -1165,6 +1277,95 @@ class BaseCache {
     }
   }
 
+  /////////////////////////////////////////////////////////////////////////////
+  // SCAN INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// Marks all accesses as scan accesses until the returned guard is
+  /// destroyed.
+  ///
+  /// \returns A guard ending the scan upon destruction.
+  /// \see LRU::AccessHint
+  ScanGuard<BaseCache> scan() {
+    return ScanGuard<BaseCache>(*this);
+  }
+
+  /// Starts a scan (prefer using `scan()` or a `ScanGuard`).
+  ///
+  /// Scans may be nested and last until each has been ended.
+  void begin_scan() const noexcept {
+    _scan_depth += 1;
+  }
+
+  /// Ends a scan started with `begin_scan()`.
+  void end_scan() const noexcept {
+    assert(_scan_depth > 0);
+    if (--_scan_depth == 0) {
+      // The last accessed key need no longer be at the front of the order,
+      // which the shortcuts taken for it assume.
+      _last_accessed.invalidate();
+    }
+  }
+
+  /// \returns True if accesses are currently treated as scan accesses, else
+  /// false.
+  bool is_scanning() const noexcept {
+    return _scan_depth > 0;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // ARBITRATION INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// Makes the cache share the budget of a memory arbiter.
+  ///
+  /// From now on, whenever the cache grows, the arbiter may evict the least
+  /// recently used key of any of its caches to stay within its budget. If the
+  /// cache already belongs to an arbiter, it leaves that arbiter first.
+  ///
+  /// Only caches whose tracking policy stamps accesses (such as
+  /// `LRU::TrackAccesses`) may join an arbiter.
+  ///
+  /// \param arbiter The arbiter to join.
+  /// \param weight_per_entry The weight of a single entry of this cache.
+  void arbitrate(MemoryArbiter& arbiter, size_t weight_per_entry = 1) {
+    static_assert(Tracking::accesses,
+                  "Arbitrated caches must track accesses "
+                  "(e.g. with LRU::TrackAccesses)");
+    stop_arbitration();
+
+    MemoryArbiter::Member member;
+    member.weight = weight_per_entry;
+    member.entries = size();
+    member.tail = [this](MemoryArbiter::Stamp& stamp) {
+      if (_order.empty()) return false;
+      stamp = _map.find(_order.front())->second.last_access;
+      return true;
+    };
+    member.evict = [this] {
+      _erase_lru();
+    };
+    member.detach = [this] {
+      _arbiter.arbiter = nullptr;
+    };
+
+    _arbiter.arbiter = &arbiter;
+    _arbiter.weight = weight_per_entry;
+    _arbiter.id = arbiter.join(std::move(member));
+  }
+
+  /// Leaves the memory arbiter, if the cache belongs to one.
+  void stop_arbitration() {
+    if (_arbiter.arbiter == nullptr) return;
+    _arbiter.arbiter->leave(_arbiter.id);
+    _arbiter.arbiter = nullptr;
+  }
+
+  /// \returns True if the cache belongs to a memory arbiter, else false.
+  bool is_arbitrated() const noexcept {
+    return _arbiter.arbiter != nullptr;
+  }
+
   /////////////////////////////////////////////////////////////////////////////
   // SIZE AND CAPACITY INTERFACE
   /////////////////////////////////////////////////////////////////////////////
@@ -1310,10 +1511,63 @@ class BaseCache {
     return _stats.shared();
   }
 
+  /// Registers the given latency statistics object to record the latencies of
+  /// the cache's operations into.
+  ///
+  /// Like statistics, latency statistics may be shared between caches.
+  ///
+  /// \param latency The latency statistics object to register.
+  void monitor_latency(LatencyPointer latency) {
+    _latency = std::move(latency);
+  }
+
+  /// Starts recording latencies into a new latency statistics object.
+  void monitor_latency() {
+    _latency = std::make_shared<LatencyStatistics>();
+  }
+
+  /// Stops recording latencies.
+  void stop_monitoring_latency() {
+    _latency.reset();
+  }
+
+  /// \returns True if the cache is currently recording latencies, else false.
+  bool is_monitoring_latency() const noexcept {
+    return _latency != nullptr;
+  }
+
+  /// \returns The latency statistics object currently in use by the cache.
+  /// \throws LRU::Error::NotMonitoring if the cache is currently not
+  /// recording latencies.
+  const LatencyStatistics& latency() const {
+    if (!is_monitoring_latency()) {
+      throw LRU::Error::NotMonitoring();
+    }
+    return *_latency;
+  }
+
+  /// \returns A `shared_ptr` to the latency statistics currently in use by the
+  /// cache.
+  const LatencyPointer& shared_latency() const noexcept {
+    return _latency;
+  }
+
   /////////////////////////////////////////////////////////////////////////////
   // CALLBACK INTERFACE
   /////////////////////////////////////////////////////////////////////////////
 
+  /// \returns The compile-time hooks of the cache.
+  /// \see LRU::NoHooks
+  Hooks& hooks() noexcept {
+    return _callback_manager.hooks();
+  }
+
+  /// \returns The compile-time hooks of the cache.
+  /// \see LRU::NoHooks
+  const Hooks& hooks() const noexcept {
+    return _callback_manager.hooks();
+  }
+
   /// Registers a new hit callback.
   ///
   /// \param hit_callback The hit callback function to register with the cache.
@@ -1343,6 +1597,15 @@ class BaseCache {
     _callback_manager.access_callback(std::forward<Callback>(access_callback));
   }
 
+  /// Removes the access callbacks satisfying a predicate.
+  ///
+  /// \param predicate A function taking an access callback and returning
+  ///                  true if it should be removed.
+  template <typename Predicate>
+  void remove_access_callbacks(Predicate predicate) {
+    _callback_manager.remove_access_callbacks(predicate);
+  }
+
   /// Clears all hit callbacks.
   void clear_hit_callbacks() {
     _callback_manager.clear_hit_callbacks();
@@ -1378,6 +1641,44 @@ class BaseCache {
     return _callback_manager.access_callbacks();
   }
 
+  /// Starts invoking hit, miss and access callbacks asynchronously.
+  ///
+  /// Lookups then only copy the key (and, if there are hit callbacks, the
+  /// value) into a bounded queue, which a dedicated thread drains in batches.
+  /// Events arriving while the queue is full are dropped (see
+  /// `dropped_callback_events()`). Callbacks must then be safe to run on
+  /// another thread, and exceptions they throw are swallowed. The access
+  /// callback installed by a `CapacityController` is: it feeds a simulation
+  /// guarded by its own mutex.
+  ///
+  /// \param queue_capacity The capacity of the event queue (rounded up to a
+  ///                       power of two).
+  void dispatch_callbacks_asynchronously(std::size_t queue_capacity = 1024) {
+    _callback_manager.dispatch_asynchronously(queue_capacity);
+  }
+
+  /// Delivers all pending callback events and goes back to invoking
+  /// callbacks synchronously, inside each lookup.
+  void dispatch_callbacks_synchronously() {
+    _callback_manager.dispatch_synchronously();
+  }
+
+  /// \returns True if callbacks are invoked asynchronously, else false.
+  bool is_dispatching_callbacks_asynchronously() const noexcept {
+    return _callback_manager.is_dispatching_asynchronously();
+  }
+
+  /// Blocks until every callback event enqueued so far has been delivered.
+  void flush_callbacks() {
+    _callback_manager.flush();
+  }
+
+  /// \returns The number of callback events dropped because the queue was
+  /// full, since asynchronous dispatch was last enabled.
+  std::size_t dropped_callback_events() const noexcept {
+    return _callback_manager.dropped_events();
+  }
+
  protected:
   // The ordered iterators need to perform lookups without changing
   // the order of elements or affecting statistics.
@@ -1390,9 +1691,11 @@ class BaseCache {
 
   /// Moves the key pointed to by the iterator to the front of the order.
   ///
+  /// During a scan, keys are left where they are.
+  ///
   /// \param iterator The iterator pointing to the key to move.
   virtual void _move_to_front(QueueIterator iterator) const {
-    if (size() == 1) return;
+    if (size() == 1 || is_scanning()) return;
     // Extract the current linked-list node and insert (splice it) at the end
     // The original iterator is not invalidated and now points to the new
     // position (which is still the same node).
@@ -1409,12 +1712,105 @@ class BaseCache {
     // The original iterator is not invalidated and now points to the new
     // position (which is still the same node).
     _move_to_front(iterator->second.order);
+    _stamp(iterator->second);
     iterator->second.value = new_value;
   }
 
+  /// Moves the key of the information to the front of the order and stamps
+  /// the access for the arbiter, if any.
+  ///
+  /// \param information The information of the key to move.
+  void _promote(const Information& information) const {
+    _move_to_front(information.order);
+    _touch(information);
+  }
+
+  /// Stamps a hit on the key of the information, for the arbiter and for the
+  /// lifetime statistics, if any.
+  ///
+  /// \param information The information of the key that was hit.
+  void _touch(const Information& information) const {
+    _stamp(information);
+    auto lifetime = _lifetime_of(information);
+    if (lifetime != nullptr && _stats.tracks_lifetimes()) {
+      lifetime->touched = Internal::Clock::now();
+      lifetime->hits += 1;
+    }
+  }
+
+  /// Stamps an access to the key of the information, if the cache is
+  /// arbitrated.
+  ///
+  /// During a scan, keys keep their stamp (and new keys look as old as
+  /// possible), just like they keep their place in the order.
+  ///
+  /// \param information The information of the accessed key.
+  void _stamp(const Information& information) const {
+    _stamp(information, std::integral_constant<bool, Tracking::accesses>());
+  }
+
+  /// Stamps an access to the key of the information (if the cache is
+  /// arbitrated and tracks accesses).
+  ///
+  /// \param information The information of the accessed key.
+  void _stamp(const Information& information, std::true_type) const {
+    if (_arbiter.arbiter == nullptr || is_scanning()) return;
+    information.last_access = _arbiter.arbiter->tick();
+  }
+
+  /// Does nothing, since the cache does not track accesses.
+  void _stamp(const Information&, std::false_type) const noexcept {
+  }
+
+  /// \returns The lifetime of the key of the information, or null if the cache
+  /// does not track lifetimes.
+  /// \param information The information of the key.
+  Lifetime* _lifetime_of(const Information& information) const noexcept {
+    return _lifetime_of(
+        information, std::integral_constant<bool, Tracking::lifetimes>());
+  }
+
+  /// \copydoc _lifetime_of(const Information&) const
+  Lifetime*
+  _lifetime_of(const Information& information, std::true_type) const noexcept {
+    return &information.lifetime;
+  }
+
+  /// Returns null, since the cache does not track lifetimes.
+  Lifetime* _lifetime_of(const Information&, std::false_type) const noexcept {
+    return nullptr;
+  }
+
+  /// Reports the size of the cache to the arbiter, if any, which evicts keys
+  /// if the cache outgrew the budget.
+  void _report_size() {
+    if (_arbiter.arbiter == nullptr) return;
+    _arbiter.arbiter->resized(_arbiter.id, size());
+  }
+
+  /// Starts timing an operation, if the cache records latencies.
+  ///
+  /// \param operation The operation to time.
+  /// \returns A timer recording the latency when it goes out of scope.
+  Internal::LatencyTimer _time(Operation operation) const {
+    return Internal::LatencyTimer(_latency.get(), operation);
+  }
+
+  /// Asks the arbiter, if any, to make room for a new key.
+  ///
+  /// Nothing needs to be done if the cache is full, since the new key then
+  /// replaces the cache's own least recently used key.
+  void _reserve_for_new_key() {
+    if (_arbiter.arbiter == nullptr || size() >= _capacity) return;
+    _arbiter.arbiter->reserve(_arbiter.weight);
+  }
+
   /// Erases the element most recently inserted into the cache.
   virtual void _erase_lru() {
-    _erase(_map.find(_order.front()));
+    auto timer = _time(Operation::Evict);
+    auto iterator = _map.find(_order.front());
+    _register_eviction(iterator->second);
+    _erase(iterator);
   }
 
   /// Erases the element pointed to by the iterator.
@@ -1427,6 +1823,7 @@ class BaseCache {
 
     _order.erase(iterator->second.order);
     _map.erase(iterator);
+    _report_size();
   }
 
   /// Erases the given key.
@@ -1448,6 +1845,7 @@ class BaseCache {
 
     // Requires an additional hash-lookup, whereas erase(iterator) doesn't
     _map.erase(key);
+    _report_size();
   }
 
   /// Convenience methhod to get the value for an insertion result into a map.
@@ -1506,6 +1904,61 @@ class BaseCache {
     _callback_manager.miss(key);
   }
 
+  /// Registers the insertion of a new key with the statistics, if any.
+  ///
+  /// \param information The information of the new key.
+  void _register_insertion(const Information& information) const {
+    if (!is_monitoring()) return;
+    _stats.register_insertion();
+    auto lifetime = _lifetime_of(information);
+    if (lifetime != nullptr && _stats.tracks_lifetimes()) {
+      lifetime->inserted = lifetime->touched = Internal::Clock::now();
+    }
+  }
+
+  /// Registers the overwrite of a key's value with the statistics, if any.
+  ///
+  /// \param information The information of the overwritten key.
+  void _register_overwrite(const Information& information) const {
+    if (!is_monitoring()) return;
+    _stats.register_overwrite();
+    auto lifetime = _lifetime_of(information);
+    if (lifetime != nullptr && _stats.tracks_lifetimes()) {
+      lifetime->touched = Internal::Clock::now();
+    }
+  }
+
+  /// Registers the eviction of a key with the statistics, if any.
+  ///
+  /// \param information The information of the evicted key.
+  void _register_eviction(const Information& information) const {
+    if (!is_monitoring()) return;
+    _stats.register_eviction();
+
+    // Keys inserted before lifetimes were tracked have no timestamps
+    auto lifetime = _lifetime_of(information);
+    if (lifetime != nullptr && _stats.tracks_lifetimes() &&
+        lifetime->inserted != Internal::Timestamp()) {
+      const auto now = Internal::Clock::now();
+      _stats.register_lifetime(
+          now - lifetime->inserted, now - lifetime->touched, lifetime->hits);
+    }
+  }
+
+  /// Registers the explicit erasure of a key with the statistics, if any.
+  void _register_erasure() const {
+    if (is_monitoring()) {
+      _stats.register_erasure();
+    }
+  }
+
+  /// Registers the clearing of an expired key with the statistics, if any.
+  void _register_expiration() const {
+    if (is_monitoring()) {
+      _stats.register_expiration();
+    }
+  }
+
   /// The common part of both range assignment operators.
   ///
   /// \param range The range to assign to.
@@ -1536,24 +1989,34 @@ class BaseCache {
   /// Inserts a new key into the queue.
   ///
   /// If the cache is full, the LRU node is re-used.
-  /// Else a node is inserted at the order.
+  /// Else a node is inserted at the order. During a scan, the key is placed at
+  /// the back of the order rather than the front.
   ///
   /// \returns The resulting iterator.
   QueueIterator _insert_new_key(const Key& key) {
     if (_is_too_full()) {
       _evict_lru_for(key);
+    } else if (is_scanning()) {
+      _order.emplace_front(key);
     } else {
       _order.emplace_back(key);
     }
 
-    return std::prev(_order.end());
+    return is_scanning() ? _order.begin() : std::prev(_order.end());
   }
 
   /// Evicts the LRU element for the given new key.
   ///
   /// \param key The new key to insert into the queue.
   void _evict_lru_for(const Key& key) {
-    _map.erase(_order.front());
+    auto timer = _time(Operation::Evict);
+    if (_last_accessed == _order.front().get()) {
+      _last_accessed.invalidate();
+    }
+
+    auto iterator = _map.find(_order.front());
+    _register_eviction(iterator->second);
+    _map.erase(iterator);
     _order.front() = std::ref(key);
     _move_to_front(_order.begin());
   }
@@ -1581,6 +2044,15 @@ class BaseCache {
 
   /// The current capacity of the cache.
   size_t _capacity;
+
+  /// The number of scans currently in progress.
+  mutable size_t _scan_depth = 0;
+
+  /// The link to the memory arbiter, if any.
+  Internal::ArbiterLink _arbiter;
+
+  /// The latency statistics to record into, if any.
+  LatencyPointer _latency;
 };
 }  // namespace Internal
 }  // namespace LRU
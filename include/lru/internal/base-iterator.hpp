@@ -23,6 +23,7 @@
 #define LRU_INTERNAL_BASE_ITERATOR_HPP
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 
 #include <lru/entry.hpp>
@@ -60,8 +61,14 @@ template <typename IteratorTag,
           typename Value,
           typename Cache,
           typename UnderlyingIterator>
-class BaseIterator : public std::iterator<IteratorTag, LRU::Entry<Key, Value>> {
+class BaseIterator {
  public:
+  using iterator_category = IteratorTag;
+  using value_type = LRU::Entry<Key, Value>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = value_type*;
+  using reference = value_type&;
+
   using KeyType = Key;
   using ValueType =
       std::conditional_t<std::is_const<Cache>::value, const Value, Value>;
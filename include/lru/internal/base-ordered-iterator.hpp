@@ -125,7 +125,9 @@ class BaseOrderedIterator
     // Atomicity
     _throw_if_at_invalid(unordered_iterator);
     _cache = std::move(unordered_iterator._cache);
-    _entry = std::move(unordered_iterator._entry);
+    if (unordered_iterator._entry) {
+      _entry.emplace(*unordered_iterator._entry);
+    }
     _iterator = std::move(unordered_iterator._iterator->second.order);
   }
 
@@ -0,0 +1,605 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_INTERNAL_BASE_SEGMENTED_CACHE_HPP
+#define LRU_INTERNAL_BASE_SEGMENTED_CACHE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <lru/error.hpp>
+#include <lru/internal/cache-monitor.hpp>
+#include <lru/internal/callback-manager.hpp>
+#include <lru/internal/definitions.hpp>
+#include <lru/internal/last-accessed.hpp>
+#include <lru/internal/statistics-mutator.hpp>
+#include <lru/internal/utility.hpp>
+#include <lru/statistics.hpp>
+
+namespace LRU {
+namespace Internal {
+
+/// The value type of the internal map of segmented caches.
+///
+/// Next to the value and order iterator stored by a regular information
+/// object, this information also records which of the cache's LRU lists (its
+/// segment) the key lives in.
+///
+/// \tparam Key The key type of the information.
+/// \tparam Value The value type of the information.
+template <typename Key, typename Value>
+struct SegmentedInformation {
+  using KeyType = Key;
+  using ValueType = Value;
+  using QueueIterator = typename Internal::Queue<const Key>::const_iterator;
+
+  /// Constructor.
+  ///
+  /// \param value_ The value for the information.
+  /// \param segment_ The index of the segment the key lives in.
+  template <typename AnyValue>
+  SegmentedInformation(AnyValue&& value_, std::size_t segment_)
+  : value(std::forward<AnyValue>(value_)), segment(segment_) {
+  }
+
+  /// The value of the information.
+  Value value;
+
+  /// The index of the segment the key lives in.
+  std::size_t segment;
+
+  /// The order iterator of the information, pointing into its segment.
+  QueueIterator order;
+};
+
+/// The base class for caches that split their keys into several LRU lists.
+///
+/// All keys share a single hash table, but each key belongs to exactly one
+/// *segment* with its own LRU list. Hits and updates move a key to the front of
+/// its own segment only. Which segment to evict from when a new key needs room
+/// is decided by the derived class via `_victim_for()`, which is how priority
+/// classes or per-tenant quotas are implemented on top of this class.
+///
+/// \tparam Key The key type of the cache.
+/// \tparam Value The value type of the cache.
+/// \tparam HashFunction The hash function type for the internal map.
+/// \tparam KeyEqual The type of the key equality function for the internal map.
+template <typename Key,
+          typename Value,
+          typename HashFunction,
+          typename KeyEqual>
+class BaseSegmentedCache : protected CacheMonitor<Key, Value> {
+ protected:
+  using monitoring = CacheMonitor<Key, Value>;
+  using PRIVATE_CACHE_MONITOR_MEMBERS
+
+  using Information = SegmentedInformation<Key, Value>;
+  using Queue = Internal::Queue<const Key>;
+  using QueueIterator = typename Queue::const_iterator;
+
+  using Map = Internal::Map<Key, Information, HashFunction, KeyEqual>;
+  using MapIterator = typename Map::iterator;
+  using MapConstIterator = typename Map::const_iterator;
+
+  using typename monitoring::CallbackManagerType;
+  using HitCallback = typename CallbackManagerType::HitCallback;
+  using MissCallback = typename CallbackManagerType::MissCallback;
+  using AccessCallback = typename CallbackManagerType::AccessCallback;
+  using HitCallbackContainer =
+      typename CallbackManagerType::HitCallbackContainer;
+  using MissCallbackContainer =
+      typename CallbackManagerType::MissCallbackContainer;
+  using AccessCallbackContainer =
+      typename CallbackManagerType::AccessCallbackContainer;
+
+  using LastAccessed = Internal::LastAccessed<Key, Information, KeyEqual>;
+
+  /// Returned by `_victim_for()` if no key needs to be evicted.
+  static constexpr std::size_t NO_VICTIM =
+      std::numeric_limits<std::size_t>::max();
+
+  /// Returned by `_victim_for()` if the new key must not be inserted at all.
+  static constexpr std::size_t REJECT = NO_VICTIM - 1;
+
+ public:
+  using StatisticsPointer = std::shared_ptr<Statistics<Key>>;
+  using size_t = std::size_t;
+
+  /// Constructor.
+  ///
+  /// \param segments The initial number of segments.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  BaseSegmentedCache(size_t segments,
+                     const HashFunction& hash,
+                     const KeyEqual& key_equal)
+  : _map(0, hash, key_equal), _segments(segments), _last_accessed(key_equal) {
+  }
+
+  /// Copy constructor.
+  BaseSegmentedCache(const BaseSegmentedCache& other)
+  : monitoring(other)
+  , _map(other._map)
+  , _segments(other._segments)
+  , _last_accessed(other._last_accessed.key_equal()) {
+    _reassign_references();
+  }
+
+  /// Move constructor.
+  BaseSegmentedCache(BaseSegmentedCache&& other) = default;
+
+  /// Copy assignment operator.
+  BaseSegmentedCache& operator=(const BaseSegmentedCache& other) {
+    if (this != &other) {
+      BaseSegmentedCache copy(other);
+      swap(copy);
+    }
+
+    return *this;
+  }
+
+  /// Move assignment operator.
+  BaseSegmentedCache& operator=(BaseSegmentedCache&& other) = default;
+
+  /// Destructor.
+  virtual ~BaseSegmentedCache() = default;
+
+  /// Swaps the contents of the cache with another cache.
+  ///
+  /// \param other The other cache to swap with.
+  void swap(BaseSegmentedCache& other) noexcept {
+    using std::swap;
+
+    swap(_map, other._map);
+    swap(_segments, other._segments);
+    swap(_stats, other._stats);
+    swap(_last_accessed, other._last_accessed);
+    swap(_callback_manager, other._callback_manager);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // CACHE INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// Tests if the given key is contained in the cache.
+  ///
+  /// If the key is found, it is moved to the front of its segment.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key to check for.
+  /// \returns True if the key is contained in the cache, else false.
+  bool contains(const Key& key) const {
+    if (key == _last_accessed) {
+      // If this is the last accessed key, it's at the front anyway
+      _register_hit(key, _last_accessed.value());
+      return true;
+    }
+
+    return _find(key) != _map.end();
+  }
+
+  /// Looks up the value for the given key.
+  ///
+  /// If the key is found, it is moved to the front of its segment.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key whose value to look for.
+  /// \throws LRU::Error::KeyNotFound if the key is not in the cache.
+  /// \returns The value stored in the cache for the given key.
+  const Value& lookup(const Key& key) const {
+    if (key == _last_accessed) {
+      _register_hit(key, _last_accessed.value());
+      return _last_accessed.value();
+    }
+
+    auto iterator = _find(key);
+    if (iterator == _map.end()) {
+      throw LRU::Error::KeyNotFound();
+    }
+
+    return iterator->second.value;
+  }
+
+  /// \copydoc lookup(const Key&) const
+  Value& lookup(const Key& key) {
+    const auto& self = *this;
+    return const_cast<Value&>(self.lookup(key));
+  }
+
+  /// \copydoc lookup(const Key&)
+  Value& operator[](const Key& key) {
+    return lookup(key);
+  }
+
+  /// \copydoc lookup(const Key&) const
+  const Value& operator[](const Key& key) const {
+    return lookup(key);
+  }
+
+  /// Erases the given key from the cache, if it is present.
+  ///
+  /// \param key The key to erase.
+  /// \returns True if the key was erased, else false.
+  bool erase(const Key& key) {
+    auto iterator = _map.find(key);
+    if (iterator == _map.end()) return false;
+
+    _register_erasure();
+    _erase(iterator);
+    return true;
+  }
+
+  /// Clears the cache entirely.
+  virtual void clear() {
+    _map.clear();
+    for (auto& segment : _segments) {
+      segment.clear();
+    }
+    _last_accessed.invalidate();
+  }
+
+  /// \returns The number of keys present in the cache.
+  size_t size() const noexcept {
+    return _map.size();
+  }
+
+  /// \returns True if the cache contains no elements, else false.
+  bool is_empty() const noexcept {
+    return size() == 0;
+  }
+
+  /// \returns The function used to hash keys.
+  HashFunction hash_function() const {
+    return _map.hash_function();
+  }
+
+  /// \returns The function used to compare keys.
+  KeyEqual key_equal() const {
+    return _map.key_eq();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // STATISTICS INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// \copydoc BaseCache::monitor(const StatisticsPointer&)
+  void monitor(const StatisticsPointer& statistics) {
+    _stats = statistics;
+  }
+
+  /// \copydoc BaseCache::monitor(StatisticsPointer&&)
+  void monitor(StatisticsPointer&& statistics) {
+    _stats = std::move(statistics);
+  }
+
+  /// \copydoc BaseCache::monitor(Args&&...)
+  template <typename... Args,
+            typename = std::enable_if_t<
+                Internal::none_of_type<StatisticsPointer, Args...>>>
+  void monitor(Args&&... args) {
+    _stats = std::make_shared<Statistics<Key>>(std::forward<Args>(args)...);
+  }
+
+  /// Stops any monitoring being performed with a statistics object.
+  void stop_monitoring() {
+    _stats.reset();
+  }
+
+  /// \returns True if the cache is currently monitoring statistics, else
+  /// false.
+  bool is_monitoring() const noexcept {
+    return _stats.has_stats();
+  }
+
+  /// \returns The statistics object currently in use by the cache.
+  /// \throws LRU::Error::NotMonitoring if the cache is currently not
+  /// monitoring.
+  Statistics<Key>& stats() {
+    if (!is_monitoring()) {
+      throw LRU::Error::NotMonitoring();
+    }
+    return _stats.get();
+  }
+
+  /// \copydoc stats()
+  const Statistics<Key>& stats() const {
+    if (!is_monitoring()) {
+      throw LRU::Error::NotMonitoring();
+    }
+    return _stats.get();
+  }
+
+  /// \returns A `shared_ptr` to the statistics currently in use by the cache.
+  StatisticsPointer& shared_stats() {
+    return _stats.shared();
+  }
+
+  /// \returns A `shared_ptr` to the statistics currently in use by the cache.
+  const StatisticsPointer& shared_stats() const {
+    return _stats.shared();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // CALLBACK INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// Registers a new hit callback.
+  ///
+  /// \param hit_callback The hit callback function to register with the cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<HitCallback, Callback>>
+  void hit_callback(Callback&& hit_callback) {
+    _callback_manager.hit_callback(std::forward<Callback>(hit_callback));
+  }
+
+  /// Registers a new miss callback.
+  ///
+  /// \param miss_callback The miss callback function to register with the
+  ///                       cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<MissCallback, Callback>>
+  void miss_callback(Callback&& miss_callback) {
+    _callback_manager.miss_callback(std::forward<Callback>(miss_callback));
+  }
+
+  /// Registers a new access callback.
+  ///
+  /// \param access_callback The access callback function to register with the
+  ///                        cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<AccessCallback, Callback>>
+  void access_callback(Callback&& access_callback) {
+    _callback_manager.access_callback(std::forward<Callback>(access_callback));
+  }
+
+  /// Removes the access callbacks satisfying a predicate.
+  ///
+  /// \param predicate A function taking an access callback and returning
+  ///                  true if it should be removed.
+  template <typename Predicate>
+  void remove_access_callbacks(Predicate predicate) {
+    _callback_manager.remove_access_callbacks(predicate);
+  }
+
+  /// Clears all callbacks.
+  void clear_all_callbacks() {
+    _callback_manager.clear();
+  }
+
+  /// \returns All hit callbacks.
+  const HitCallbackContainer& hit_callbacks() const noexcept {
+    return _callback_manager.hit_callbacks();
+  }
+
+  /// \returns All miss callbacks.
+  const MissCallbackContainer& miss_callbacks() const noexcept {
+    return _callback_manager.miss_callbacks();
+  }
+
+  /// \returns All access callbacks.
+  const AccessCallbackContainer& access_callbacks() const noexcept {
+    return _callback_manager.access_callbacks();
+  }
+
+ protected:
+  /// Determines the segment from which to evict a key, so that a new key can
+  /// be inserted into the given segment.
+  ///
+  /// This method is called repeatedly before every insertion of a new key,
+  /// evicting the least recently used key of the returned segment each time,
+  /// until it returns `NO_VICTIM`. The returned segment must not be empty.
+  ///
+  /// \param segment The segment a new key is to be inserted into.
+  /// \returns The segment to evict from, `NO_VICTIM` if there is room or
+  /// `REJECT` if the key may not displace any other key.
+  virtual size_t _victim_for(size_t segment) const = 0;
+
+  /// Called with the index of a segment after a key was added to it.
+  virtual void _segment_grew(size_t) {
+  }
+
+  /// Called with the index of a segment after a key was removed from it.
+  virtual void _segment_shrunk(size_t) {
+  }
+
+  /// Appends a new, empty segment.
+  ///
+  /// \returns The index of the new segment.
+  size_t _add_segment() {
+    _segments.emplace_back();
+    return _segments.size() - 1;
+  }
+
+  /// Inserts or updates a key in the given segment.
+  ///
+  /// An existing key is moved to the front of the new segment. A new key is
+  /// inserted at the front of the segment, after evicting keys as requested by
+  /// `_victim_for()`.
+  ///
+  /// \param key_argument The argument to construct a key object with.
+  /// \param value_argument The argument to construct a value object with.
+  /// \param segment The segment to insert the key into.
+  /// \returns True if the key was newly inserted, false if it was only updated
+  /// or rejected.
+  template <typename K, typename V>
+  bool _emplace(K&& key_argument, V&& value_argument, size_t segment) {
+    assert(segment < _segments.size());
+
+    Key key(std::forward<K>(key_argument));
+    auto iterator = _map.find(key);
+
+    if (iterator != _map.end()) {
+      auto& information = iterator->second;
+      information.value = Value(std::forward<V>(value_argument));
+      _move_to_front(information, segment);
+      _register_overwrite();
+      _last_accessed = iterator;
+      return false;
+    }
+
+    // Evicting before inserting means the new key is never a victim.
+    for (auto victim = _victim_for(segment); victim != NO_VICTIM;
+         victim = _victim_for(segment)) {
+      if (victim == REJECT) return false;
+      _erase_lru(victim);
+    }
+
+    auto result = _map.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<V>(value_argument), segment));
+    assert(result.second);
+
+    auto& queue = _segments[segment];
+    queue.emplace_back(result.first->first);
+    result.first->second.order = std::prev(queue.end());
+    _last_accessed = result.first;
+    _segment_grew(segment);
+    _register_insertion();
+
+    return true;
+  }
+
+  /// Looks up a key, moves it to the front of its segment and registers a hit
+  /// or miss.
+  ///
+  /// \param key The key to look for.
+  /// \returns An iterator to the key, or the end iterator.
+  MapConstIterator _find(const Key& key) const {
+    auto iterator = _map.find(key);
+    if (iterator != _map.end()) {
+      _register_hit(key, iterator->second.value);
+      _move_to_front(iterator->second);
+      _last_accessed = iterator;
+    } else {
+      _register_miss(key);
+    }
+
+    return iterator;
+  }
+
+  /// Moves the key of the information to the front of its segment.
+  ///
+  /// \param information The information of the key to move.
+  void _move_to_front(const Information& information) const {
+    auto& queue = _segments[information.segment];
+    queue.splice(queue.end(), queue, information.order);
+  }
+
+  /// Moves the key of the information to the front of another segment.
+  ///
+  /// \param information The information of the key to move.
+  /// \param segment The segment to move the key to.
+  void _move_to_front(Information& information, size_t segment) {
+    if (segment == information.segment) {
+      _move_to_front(information);
+      return;
+    }
+
+    auto& queue = _segments[segment];
+    auto& old_queue = _segments[information.segment];
+    queue.splice(queue.end(), old_queue, information.order);
+
+    _segment_shrunk(information.segment);
+    information.segment = segment;
+    _segment_grew(segment);
+  }
+
+  /// Erases the least recently used key of the given segment.
+  ///
+  /// \param segment The segment to evict from.
+  void _erase_lru(size_t segment) {
+    assert(!_segments[segment].empty());
+    _register_eviction();
+    _erase(_map.find(_segments[segment].front()));
+  }
+
+  /// Erases the element pointed to by the iterator.
+  ///
+  /// \param iterator The iterator pointing to the key to erase.
+  void _erase(MapConstIterator iterator) {
+    if (_last_accessed == iterator) {
+      _last_accessed.invalidate();
+    }
+
+    const auto segment = iterator->second.segment;
+    _segments[segment].erase(iterator->second.order);
+    _map.erase(iterator);
+    _segment_shrunk(segment);
+  }
+
+  /// \returns The number of keys in the given segment.
+  /// \param segment The segment to count the keys of.
+  size_t _segment_size(size_t segment) const noexcept {
+    return _segments[segment].size();
+  }
+
+  /// Re-assigns the references in the segments to the keys of the map.
+  ///
+  /// After a copy, the reference (wrappers) in the segments point to the keys
+  /// of the other cache's map, and the order iterators into its segments.
+  void _reassign_references() {
+    for (auto& queue : _segments) {
+      for (auto node = queue.begin(); node != queue.end(); ++node) {
+        auto iterator = _map.find(node->get());
+        *node = std::ref(iterator->first);
+        iterator->second.order = node;
+      }
+    }
+  }
+
+  /// The map from keys to information objects.
+  Map _map;
+
+  /// The LRU list of every segment.
+  mutable std::vector<Queue> _segments;
+
+  /// The last-accessed cache object.
+  mutable LastAccessed _last_accessed;
+};
+
+template <typename Key,
+          typename Value,
+          typename HashFunction,
+          typename KeyEqual>
+constexpr std::size_t
+    BaseSegmentedCache<Key, Value, HashFunction, KeyEqual>::NO_VICTIM;
+
+template <typename Key,
+          typename Value,
+          typename HashFunction,
+          typename KeyEqual>
+constexpr std::size_t
+    BaseSegmentedCache<Key, Value, HashFunction, KeyEqual>::REJECT;
+
+}  // namespace Internal
+}  // namespace LRU
+
+#endif  // LRU_INTERNAL_BASE_SEGMENTED_CACHE_HPP
@@ -36,7 +36,7 @@
 namespace LRU {
 
 // Forward declaration.
-template <typename, typename, typename, typename, typename>
+template <typename, typename, typename, typename, typename, typename, typename>
 class TimedCache;
 
 namespace Internal {
@@ -207,7 +207,13 @@ class BaseUnorderedIterator
   template <typename, typename, typename>
   friend class BaseOrderedIterator;
 
-  template <typename, typename, typename, typename, typename>
+  template <typename,
+            typename,
+            typename,
+            typename,
+            typename,
+            typename,
+            typename>
   friend class LRU::TimedCache;
 };
 }  // namespace Internal
@@ -0,0 +1,115 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_INTERNAL_CACHE_MONITOR_HPP
+#define LRU_INTERNAL_CACHE_MONITOR_HPP
+
+#include <lru/internal/callback-manager.hpp>
+#include <lru/internal/statistics-mutator.hpp>
+
+#define PRIVATE_CACHE_MONITOR_MEMBERS    \
+  monitoring::_stats;                    \
+  using monitoring::_callback_manager;   \
+  using monitoring::_register_hit;       \
+  using monitoring::_register_miss;      \
+  using monitoring::_register_insertion; \
+  using monitoring::_register_overwrite; \
+  using monitoring::_register_eviction;  \
+  using monitoring::_register_erasure;
+
+namespace LRU {
+namespace Internal {
+
+/// The statistics and callbacks of the caches that do not derive from
+/// `BaseCache` (the approximate, LFU and segmented caches).
+///
+/// Owns the statistics mutator and the callback manager and registers the
+/// events of the cache with both, so that each cache only has to say *what*
+/// happened. Derived classes alias it as `monitoring` and pull the members in
+/// via `using PRIVATE_CACHE_MONITOR_MEMBERS`.
+///
+/// \tparam Key The key type of the cache.
+/// \tparam Value The value type of the cache.
+template <typename Key, typename Value>
+class CacheMonitor {
+ protected:
+  using CallbackManagerType = CallbackManager<Key, Value>;
+
+  /// Registers a hit for the key and performs appropriate actions.
+  /// \param key The key to register a hit for.
+  /// \param value The value that was found for the key.
+  void _register_hit(const Key& key, const Value& value) const {
+    if (_stats.has_stats()) {
+      _stats.register_hit(key);
+    }
+
+    _callback_manager.hit(key, value);
+  }
+
+  /// Registers a miss for the key and performs appropriate actions.
+  /// \param key The key to register a miss for.
+  void _register_miss(const Key& key) const {
+    if (_stats.has_stats()) {
+      _stats.register_miss(key);
+    }
+
+    _callback_manager.miss(key);
+  }
+
+  /// Registers the insertion of a new key with the statistics, if any.
+  void _register_insertion() const {
+    if (_stats.has_stats()) {
+      _stats.register_insertion();
+    }
+  }
+
+  /// Registers the overwrite of a key's value with the statistics, if any.
+  void _register_overwrite() const {
+    if (_stats.has_stats()) {
+      _stats.register_overwrite();
+    }
+  }
+
+  /// Registers the eviction of a key with the statistics, if any.
+  void _register_eviction() const {
+    if (_stats.has_stats()) {
+      _stats.register_eviction();
+    }
+  }
+
+  /// Registers the explicit erasure of a key with the statistics, if any.
+  void _register_erasure() const {
+    if (_stats.has_stats()) {
+      _stats.register_erasure();
+    }
+  }
+
+  /// The object to mutate statistics if any are registered.
+  mutable StatisticsMutator<Key> _stats;
+
+  /// The callback manager to store any callbacks.
+  mutable CallbackManagerType _callback_manager;
+};
+
+}  // namespace Internal
+}  // namespace LRU
+
+#endif  // LRU_INTERNAL_CACHE_MONITOR_HPP
@@ -0,0 +1,202 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_INTERNAL_CALLBACK_DISPATCHER_HPP
+#define LRU_INTERNAL_CALLBACK_DISPATCHER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <lru/internal/optional.hpp>
+#include <lru/internal/ring-buffer.hpp>
+
+namespace LRU {
+namespace Internal {
+
+/// Delivers events to a handler on a dedicated thread.
+///
+/// Producers push events into a bounded `RingBuffer` without ever blocking;
+/// when the ring is full, the event is dropped and counted. A background
+/// thread drains the ring in batches and passes each batch to the handler
+/// while holding the dispatcher's mutex, so that whoever owns the state the
+/// handler reads can modify it safely by taking `lock()`.
+///
+/// Exceptions thrown by the handler are swallowed, since there is nobody to
+/// propagate them to.
+///
+/// \tparam Event The type of the events.
+template <typename Event>
+class CallbackDispatcher {
+ public:
+  using Handler = std::function<void(std::vector<Event>&)>;
+
+  /// The maximum number of events handed to the handler at once.
+  static constexpr std::size_t BATCH_SIZE = 64;
+
+  /// Constructor. Starts the dispatch thread.
+  ///
+  /// \param capacity The capacity of the event queue.
+  /// \param handler The handler to pass batches of events to.
+  CallbackDispatcher(std::size_t capacity, Handler handler)
+  : _queue(capacity)
+  , _handler(std::move(handler))
+  , _running(true)
+  , _processed(0)
+  , _dropped(0) {
+    _thread = std::thread([this] { _run(); });
+  }
+
+  CallbackDispatcher(const CallbackDispatcher&) = delete;
+  CallbackDispatcher& operator=(const CallbackDispatcher&) = delete;
+
+  /// Destructor. Delivers all pending events and joins the dispatch thread.
+  ~CallbackDispatcher() {
+    _running.store(false, std::memory_order_release);
+    _thread.join();
+  }
+
+  /// Enqueues an event, or drops it if the queue is full.
+  ///
+  /// \param event The event to enqueue.
+  /// \returns True if the event was enqueued, else false.
+  bool enqueue(Event&& event) {
+    if (_queue.try_push(std::move(event))) return true;
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  /// Blocks until every event enqueued before the call was handled.
+  void flush() {
+    const auto target = _queue.pushed();
+    while (_processed.load(std::memory_order_acquire) < target) {
+      std::this_thread::yield();
+    }
+  }
+
+  /// \returns A lock on the mutex held while the handler runs.
+  std::unique_lock<std::mutex> lock() {
+    return std::unique_lock<std::mutex>(_mutex);
+  }
+
+  /// Replaces the handler. The caller must hold `lock()`.
+  ///
+  /// \param handler The new handler.
+  void handler(Handler handler) {
+    _handler = std::move(handler);
+  }
+
+  /// \returns The number of events dropped because the queue was full.
+  std::size_t dropped() const noexcept {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+  /// \returns The capacity of the event queue.
+  std::size_t capacity() const noexcept {
+    return _queue.capacity();
+  }
+
+ private:
+  /// The body of the dispatch thread.
+  void _run() {
+    std::vector<Event> batch;
+    batch.reserve(BATCH_SIZE);
+
+    auto backoff = std::chrono::microseconds(1);
+    while (true) {
+      const bool running = _running.load(std::memory_order_acquire);
+      _drain(batch);
+
+      if (!batch.empty()) {
+        _handle(batch);
+        backoff = std::chrono::microseconds(1);
+      } else if (!running) {
+        break;
+      } else {
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min(backoff * 2, std::chrono::microseconds(1000));
+      }
+    }
+  }
+
+  /// Moves up to `BATCH_SIZE` events from the queue into the batch.
+  ///
+  /// \param batch The batch to fill.
+  void _drain(std::vector<Event>& batch) {
+    Optional<Event> event;
+    while (batch.size() < BATCH_SIZE && _queue.try_pop(event)) {
+      batch.push_back(std::move(*event));
+      event.reset();
+    }
+  }
+
+  /// Passes a batch to the handler and clears it.
+  ///
+  /// \param batch The batch of events to handle.
+  void _handle(std::vector<Event>& batch) {
+    {
+      std::lock_guard<std::mutex> guard(_mutex);
+      try {
+        _handler(batch);
+      } catch (...) {
+        // Nobody to report to.
+      }
+    }
+
+    _processed.fetch_add(batch.size(), std::memory_order_release);
+    batch.clear();
+  }
+
+  /// The queue of pending events.
+  RingBuffer<Event> _queue;
+
+  /// The handler events are delivered to.
+  Handler _handler;
+
+  /// Held while the handler runs.
+  std::mutex _mutex;
+
+  /// Whether the dispatcher should keep waiting for events.
+  std::atomic<bool> _running;
+
+  /// The number of events handed to the handler so far.
+  std::atomic<std::size_t> _processed;
+
+  /// The number of events dropped because the queue was full.
+  std::atomic<std::size_t> _dropped;
+
+  /// The dispatch thread.
+  std::thread _thread;
+};
+
+template <typename Event>
+constexpr std::size_t CallbackDispatcher<Event>::BATCH_SIZE;
+
+}  // namespace Internal
+}  // namespace LRU
+
+#endif  // LRU_INTERNAL_CALLBACK_DISPATCHER_HPP
@@ -22,10 +22,17 @@
 #ifndef LRU_INTERNAL_CALLBACK_MANAGER_HPP
 #define LRU_INTERNAL_CALLBACK_MANAGER_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <lru/entry.hpp>
+#include <lru/hooks.hpp>
+#include <lru/internal/callback-dispatcher.hpp>
 #include <lru/internal/optional.hpp>
 
 namespace LRU {
@@ -39,8 +46,20 @@ namespace Internal {
 /// 2. Miss callbacks, taking only a key, that was not found in a cache.
 /// 3. Access callbacks, taking a key and a boolean indicating a hit or a miss.
 ///
-/// Callbacks can be added, accessed and cleared.
-template <typename Key, typename Value>
+/// Callbacks can be added, accessed and cleared. Additionally, the manager
+/// owns an instance of compile-time hooks (see `LRU::NoHooks`), which are
+/// called before any callbacks.
+///
+/// By default, callbacks are invoked synchronously inside the lookup that
+/// triggered them. After `dispatch_asynchronously()`, hits and misses are
+/// instead copied into a bounded queue and the callbacks are invoked in
+/// batches on a dedicated thread, so that slow callbacks no longer add to
+/// lookup latency. Hooks are always called synchronously.
+///
+/// \tparam Key The key type of the cache.
+/// \tparam Value The value type of the cache.
+/// \tparam Hooks The type of the compile-time hooks.
+template <typename Key, typename Value, typename Hooks = NoHooks>
 class CallbackManager {
  public:
   using HitCallback = std::function<void(const Key&, const Value&)>;
@@ -51,11 +70,68 @@ class CallbackManager {
   using MissCallbackContainer = std::vector<MissCallback>;
   using AccessCallbackContainer = std::vector<AccessCallback>;
 
+  /// Constructor.
+  CallbackManager() = default;
+
+  /// Copy constructor. The copy dispatches synchronously.
+  ///
+  /// \param other The manager to copy callbacks and hooks from.
+  CallbackManager(const CallbackManager& other) {
+    auto lock = other._lock();
+    _hit_callbacks = other._hit_callbacks;
+    _miss_callbacks = other._miss_callbacks;
+    _access_callbacks = other._access_callbacks;
+    _hooks = other._hooks;
+  }
+
+  /// Move constructor. Takes over the other manager's dispatch mode.
+  ///
+  /// \param other The manager to move from.
+  CallbackManager(CallbackManager&& other) noexcept {
+    _take(std::move(other));
+  }
+
+  /// Copy assignment operator. Keeps this manager's dispatch mode.
+  ///
+  /// \param other The manager to copy callbacks and hooks from.
+  /// \returns The manager.
+  CallbackManager& operator=(const CallbackManager& other) {
+    if (this != &other) {
+      auto lock = _lock();
+      auto other_lock = other._lock();
+      _hit_callbacks = other._hit_callbacks;
+      _miss_callbacks = other._miss_callbacks;
+      _access_callbacks = other._access_callbacks;
+      _hooks = other._hooks;
+    }
+    return *this;
+  }
+
+  /// Move assignment operator. Takes over the other manager's dispatch mode.
+  ///
+  /// \param other The manager to move from.
+  /// \returns The manager.
+  CallbackManager& operator=(CallbackManager&& other) noexcept {
+    if (this != &other) {
+      _dispatcher.reset();
+      _take(std::move(other));
+    }
+    return *this;
+  }
+
   /// Calls all callbacks registered for a hit, with the given key and value.
   ///
   /// \param key The key for which a cache hit ocurred.
   /// \param value The value that was found for the key.
   void hit(const Key& key, const Value& value) {
+    _hooks.hit(key, value);
+    if (_hit_callbacks.empty() && _access_callbacks.empty()) return;
+    if (_dispatcher) {
+      Event event{key, {}, true};
+      if (!_hit_callbacks.empty()) event.value.emplace(value);
+      _dispatcher->enqueue(std::move(event));
+      return;
+    }
     _call_each(_hit_callbacks, key, value);
     _call_each(_access_callbacks, key, true);
   }
@@ -64,16 +140,68 @@ class CallbackManager {
   ///
   /// \param key The key for which a cache miss ocurred.
   void miss(const Key& key) {
+    _hooks.miss(key);
+    if (_miss_callbacks.empty() && _access_callbacks.empty()) return;
+    if (_dispatcher) {
+      _dispatcher->enqueue(Event{key, {}, false});
+      return;
+    }
     _call_each(_miss_callbacks, key);
     _call_each(_access_callbacks, key, false);
   }
 
+  /// Starts invoking callbacks asynchronously, on a dedicated thread.
+  ///
+  /// If already dispatching asynchronously, pending events are first
+  /// delivered and the queue is replaced.
+  ///
+  /// \param capacity The capacity of the event queue. Events arriving while
+  ///                 the queue is full are dropped.
+  void dispatch_asynchronously(std::size_t capacity) {
+    _dispatcher.reset();
+    _dispatcher = std::make_unique<Dispatcher>(capacity, _handler());
+  }
+
+  /// Delivers all pending events and goes back to invoking callbacks
+  /// synchronously.
+  void dispatch_synchronously() {
+    _dispatcher.reset();
+  }
+
+  /// \returns True if callbacks are invoked asynchronously, else false.
+  bool is_dispatching_asynchronously() const noexcept {
+    return static_cast<bool>(_dispatcher);
+  }
+
+  /// Blocks until all events that were enqueued so far have been delivered.
+  /// Does nothing when dispatching synchronously.
+  void flush() {
+    if (_dispatcher) _dispatcher->flush();
+  }
+
+  /// \returns The number of events dropped because the queue was full, since
+  /// asynchronous dispatch was last enabled.
+  std::size_t dropped_events() const noexcept {
+    return _dispatcher ? _dispatcher->dropped() : 0;
+  }
+
+  /// \returns The compile-time hooks.
+  Hooks& hooks() noexcept {
+    return _hooks;
+  }
+
+  /// \returns The compile-time hooks.
+  const Hooks& hooks() const noexcept {
+    return _hooks;
+  }
+
   /// Registers a new hit callback.
   ///
   /// \param hit_callback The hit callback function to register with the
   ///                     manager.
   template <typename Callback>
   void hit_callback(Callback&& hit_callback) {
+    auto lock = _lock();
     _hit_callbacks.emplace_back(std::forward<Callback>(hit_callback));
   }
 
@@ -83,6 +211,7 @@ class CallbackManager {
   ///                      manager.
   template <typename Callback>
   void miss_callback(Callback&& miss_callback) {
+    auto lock = _lock();
     _miss_callbacks.emplace_back(std::forward<Callback>(miss_callback));
   }
 
@@ -92,24 +221,41 @@ class CallbackManager {
   ///                        manager.
   template <typename Callback>
   void access_callback(Callback&& access_callback) {
+    auto lock = _lock();
     _access_callbacks.emplace_back(std::forward<Callback>(access_callback));
   }
 
   /// Clears all hit callbacks.
   void clear_hit_callbacks() {
+    auto lock = _lock();
     _hit_callbacks.clear();
   }
 
   /// Clears all miss callbacks.
   void clear_miss_callbacks() {
+    auto lock = _lock();
     _miss_callbacks.clear();
   }
 
   /// Clears all access callbacks.
   void clear_access_callbacks() {
+    auto lock = _lock();
     _access_callbacks.clear();
   }
 
+  /// Removes the access callbacks satisfying a predicate.
+  ///
+  /// \param predicate A function taking an access callback and returning
+  ///                  true if it should be removed.
+  template <typename Predicate>
+  void remove_access_callbacks(Predicate predicate) {
+    auto lock = _lock();
+    _access_callbacks.erase(std::remove_if(_access_callbacks.begin(),
+                                           _access_callbacks.end(),
+                                           predicate),
+                            _access_callbacks.end());
+  }
+
   /// Clears all callbacks.
   void clear() {
     clear_hit_callbacks();
@@ -133,6 +279,57 @@ class CallbackManager {
   }
 
  private:
+  /// A hit or miss waiting to be delivered to callbacks.
+  struct Event {
+    /// The key that was looked up.
+    Key key;
+
+    /// The value that was found, if there are hit callbacks to pass it to.
+    Optional<Value> value;
+
+    /// Whether the lookup was a hit.
+    bool hit;
+  };
+
+  using Dispatcher = CallbackDispatcher<Event>;
+
+  /// \returns A lock on the dispatcher's mutex, or an empty lock when
+  /// dispatching synchronously.
+  std::unique_lock<std::mutex> _lock() const {
+    if (!_dispatcher) return {};
+    return _dispatcher->lock();
+  }
+
+  /// \returns A handler delivering batches of events to this manager's
+  /// callbacks.
+  typename Dispatcher::Handler _handler() {
+    return [this](std::vector<Event>& batch) {
+      for (auto& event : batch) {
+        if (event.hit) {
+          if (event.value) _call_each(_hit_callbacks, event.key, *event.value);
+          _call_each(_access_callbacks, event.key, true);
+        } else {
+          _call_each(_miss_callbacks, event.key);
+          _call_each(_access_callbacks, event.key, false);
+        }
+      }
+    };
+  }
+
+  /// Moves the callbacks, hooks and dispatcher of another manager into this
+  /// one and points the dispatcher at this manager.
+  ///
+  /// \param other The manager to move from.
+  void _take(CallbackManager&& other) {
+    auto lock = other._lock();
+    _hit_callbacks = std::move(other._hit_callbacks);
+    _miss_callbacks = std::move(other._miss_callbacks);
+    _access_callbacks = std::move(other._access_callbacks);
+    _hooks = std::move(other._hooks);
+    _dispatcher = std::move(other._dispatcher);
+    if (_dispatcher) _dispatcher->handler(_handler());
+  }
+
   /// Calls each function in the given container with the given arguments.
   ///
   /// \param callbacks The container of callbacks to call.
@@ -152,6 +349,13 @@ class CallbackManager {
 
   /// The container of access callbacks registered.
   AccessCallbackContainer _access_callbacks;
+
+  /// The compile-time hooks.
+  Hooks _hooks;
+
+  /// The asynchronous dispatcher, if any. Declared last so that pending
+  /// events are delivered before the callbacks are destroyed.
+  std::unique_ptr<Dispatcher> _dispatcher;
 };
 }  // namespace Internal
 }  // namespace LRU
@@ -35,6 +35,22 @@ namespace Internal {
 /// The default capacity for all caches.
 const std::size_t DEFAULT_CAPACITY = 128;
 
+/// The default number of keys sampled per eviction by approximate caches.
+const std::size_t DEFAULT_SAMPLES = 5;
+
+/// The default number of eviction candidates approximate caches remember.
+const std::size_t DEFAULT_EVICTION_POOL_SIZE = 16;
+
+/// The default number of priority classes of priority caches.
+const std::size_t DEFAULT_PRIORITY_CLASSES = 3;
+
+/// The default fraction of keys simulated by capacity controllers.
+const double DEFAULT_SHADOW_SAMPLING_RATE = 0.1;
+
+/// Capacity controllers resize caches in steps of their capacity divided by
+/// this number.
+const std::size_t CAPACITY_STEP_DIVISOR = 16;
+
 /// The reference type use to store keys in the order queue.
 template <typename T>
 using Reference = std::reference_wrapper<T>;
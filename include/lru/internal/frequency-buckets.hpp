@@ -0,0 +1,279 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_INTERNAL_FREQUENCY_BUCKETS_HPP
+#define LRU_INTERNAL_FREQUENCY_BUCKETS_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <utility>
+
+namespace LRU {
+namespace Internal {
+
+/// A list of items ordered by their access frequency, with O(1) updates.
+///
+/// Items with the same count share a bucket, and buckets are kept in order of
+/// increasing count. Within a bucket, items are ordered by the time they
+/// reached that count (oldest first). Incrementing the count of an item by
+/// one only ever moves it to the neighboring bucket, so every operation
+/// except `decay()` and weighted updates is O(1). This is the classic O(1)
+/// LFU structure (and the "stream summary" of the Space-Saving algorithm).
+///
+/// \tparam T The type of the items.
+template <typename T>
+class FrequencyBuckets {
+ public:
+  struct Bucket;
+  using BucketList = std::list<Bucket>;
+  using BucketIterator = typename BucketList::iterator;
+  using BucketConstIterator = typename BucketList::const_iterator;
+
+  /// An item in a bucket.
+  struct Node {
+    /// The item itself.
+    T item;
+
+    /// The bucket the item lives in.
+    BucketIterator bucket;
+  };
+
+  using NodeList = std::list<Node>;
+
+  /// A handle to an item, stable until the item is erased.
+  using Handle = typename NodeList::iterator;
+
+  /// A bucket of items with the same count.
+  struct Bucket {
+    /// The count of all items in the bucket.
+    std::size_t count;
+
+    /// The items in the bucket, oldest first.
+    NodeList nodes;
+  };
+
+  /// Constructor.
+  FrequencyBuckets() : _size(0) {
+  }
+
+  /// Copy constructor.
+  FrequencyBuckets(const FrequencyBuckets& other)
+  : _buckets(other._buckets), _size(other._size) {
+    _relink();
+  }
+
+  /// Move constructor.
+  FrequencyBuckets(FrequencyBuckets&& other) = default;
+
+  /// Copy assignment operator.
+  FrequencyBuckets& operator=(const FrequencyBuckets& other) {
+    if (this != &other) {
+      FrequencyBuckets copy(other);
+      swap(copy);
+    }
+
+    return *this;
+  }
+
+  /// Move assignment operator.
+  FrequencyBuckets& operator=(FrequencyBuckets&& other) = default;
+
+  /// Swaps the contents of the list with another list.
+  ///
+  /// \param other The other list to swap with.
+  void swap(FrequencyBuckets& other) noexcept {
+    using std::swap;
+    swap(_buckets, other._buckets);
+    swap(_size, other._size);
+  }
+
+  /// Inserts a new item.
+  ///
+  /// \param item The item to insert.
+  /// \param count The initial count of the item.
+  /// \returns A handle to the new item.
+  /// \complexity O(1) for a count of one, else linear in the number of
+  /// buckets with lower counts.
+  Handle insert(const T& item, std::size_t count = 1) {
+    assert(count > 0);
+    auto bucket = _buckets.begin();
+    while (bucket != _buckets.end() && bucket->count < count) {
+      ++bucket;
+    }
+
+    if (bucket == _buckets.end() || bucket->count != count) {
+      bucket = _buckets.emplace(bucket, Bucket{count, NodeList()});
+    }
+
+    bucket->nodes.push_back(Node{item, bucket});
+    _size += 1;
+
+    return std::prev(bucket->nodes.end());
+  }
+
+  /// Increments the count of an item.
+  ///
+  /// \param handle The handle of the item.
+  /// \param amount The amount to add to the count.
+  /// \complexity O(1) for an amount of one, else linear in the number of
+  /// buckets skipped.
+  void increment(Handle handle, std::size_t amount = 1) {
+    auto bucket = handle->bucket;
+    const auto count = bucket->count + amount;
+
+    auto next = std::next(bucket);
+    while (next != _buckets.end() && next->count < count) {
+      ++next;
+    }
+
+    if (next == _buckets.end() || next->count != count) {
+      next = _buckets.emplace(next, Bucket{count, NodeList()});
+    }
+
+    next->nodes.splice(next->nodes.end(), bucket->nodes, handle);
+    handle->bucket = next;
+
+    if (bucket->nodes.empty()) {
+      _buckets.erase(bucket);
+    }
+  }
+
+  /// Erases an item.
+  ///
+  /// \param handle The handle of the item.
+  void erase(Handle handle) {
+    auto bucket = handle->bucket;
+    bucket->nodes.erase(handle);
+    _size -= 1;
+
+    if (bucket->nodes.empty()) {
+      _buckets.erase(bucket);
+    }
+  }
+
+  /// \returns A handle to the oldest item with the lowest count.
+  Handle min() noexcept {
+    assert(!empty());
+    return _buckets.front().nodes.begin();
+  }
+
+  /// \returns The lowest count of any item.
+  std::size_t min_count() const noexcept {
+    assert(!empty());
+    return _buckets.front().count;
+  }
+
+  /// \returns The count of an item.
+  /// \param handle The handle of the item.
+  static std::size_t count(Handle handle) noexcept {
+    return handle->bucket->count;
+  }
+
+  /// Halves the counts of all items (keeping them at least one).
+  ///
+  /// Buckets whose counts become equal are merged, with the items of the
+  /// previously higher bucket placed after the others. Handles stay valid.
+  ///
+  /// \complexity O(N) for N items.
+  void decay() {
+    for (auto bucket = _buckets.begin(); bucket != _buckets.end();) {
+      bucket->count = std::max<std::size_t>(bucket->count / 2, 1);
+
+      if (bucket == _buckets.begin()) {
+        ++bucket;
+        continue;
+      }
+
+      auto previous = std::prev(bucket);
+      if (previous->count != bucket->count) {
+        ++bucket;
+        continue;
+      }
+
+      for (auto& node : bucket->nodes) {
+        node.bucket = previous;
+      }
+
+      previous->nodes.splice(previous->nodes.end(), bucket->nodes);
+      bucket = _buckets.erase(bucket);
+    }
+  }
+
+  /// Removes all items.
+  void clear() noexcept {
+    _buckets.clear();
+    _size = 0;
+  }
+
+  /// \returns The number of items.
+  std::size_t size() const noexcept {
+    return _size;
+  }
+
+  /// \returns True if there are no items, else false.
+  bool empty() const noexcept {
+    return _size == 0;
+  }
+
+  /// \returns An iterator to the bucket with the lowest count.
+  BucketIterator begin() noexcept {
+    return _buckets.begin();
+  }
+
+  /// \returns The past-the-end bucket iterator.
+  BucketIterator end() noexcept {
+    return _buckets.end();
+  }
+
+  /// \returns An iterator to the bucket with the lowest count.
+  BucketConstIterator begin() const noexcept {
+    return _buckets.begin();
+  }
+
+  /// \returns The past-the-end bucket iterator.
+  BucketConstIterator end() const noexcept {
+    return _buckets.end();
+  }
+
+ private:
+  /// Points the nodes of all buckets back at their own buckets (after a copy).
+  void _relink() {
+    for (auto bucket = _buckets.begin(); bucket != _buckets.end(); ++bucket) {
+      for (auto& node : bucket->nodes) {
+        node.bucket = bucket;
+      }
+    }
+  }
+
+  /// The buckets, in order of increasing count.
+  BucketList _buckets;
+
+  /// The total number of items.
+  std::size_t _size;
+};
+
+}  // namespace Internal
+}  // namespace LRU
+
+#endif  // LRU_INTERNAL_FREQUENCY_BUCKETS_HPP
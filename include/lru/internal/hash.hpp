@@ -23,14 +23,94 @@
 #define LRU_INTERNAL_HASH_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace LRU {
+namespace Internal {
+
+/// The constants used by wyhash, which we borrow for our mixing.
+constexpr std::uint64_t HASH_SECRET_0 = 0xa0761d6478bd642fULL;
+constexpr std::uint64_t HASH_SECRET_1 = 0xe7037ed1a0b428dbULL;
+
+/// Multiplies two 64 bit values into a 128 bit product and folds the halves
+/// together with XOR (the "mum" primitive of wyhash).
+///
+/// \param a The first operand.
+/// \param b The second operand.
+/// \returns The XOR of the high and low halves of the product.
+inline std::uint64_t mum(std::uint64_t a, std::uint64_t b) noexcept {
+#ifdef __SIZEOF_INT128__
+  const auto product = static_cast<unsigned __int128>(a) * b;
+  return static_cast<std::uint64_t>(product) ^
+         static_cast<std::uint64_t>(product >> 64);
+#else
+  const std::uint64_t a_low = a & 0xffffffff, a_high = a >> 32;
+  const std::uint64_t b_low = b & 0xffffffff, b_high = b >> 32;
+
+  const auto low_low = a_low * b_low;
+  const auto high_low = a_high * b_low;
+  const auto low_high = a_low * b_high;
+  const auto high_high = a_high * b_high;
+
+  const auto middle = (low_low >> 32) + (high_low & 0xffffffff) + low_high;
+  const auto low = (middle << 32) | (low_low & 0xffffffff);
+  const auto high = high_high + (high_low >> 32) + (middle >> 32);
+
+  return low ^ high;
+#endif
+}
+
+/// Combines a running hash seed with the hash of one more value.
+///
+/// Unlike the additive boost-style combiner, every input bit affects every
+/// output bit, so that tuples of small integers (whose `std::hash` is often
+/// the identity) still spread over all buckets.
+///
+/// \param seed The hash of the values combined so far.
+/// \param value The hash of the next value.
+/// \returns The new seed.
+inline std::uint64_t
+hash_combine(std::uint64_t seed, std::uint64_t value) noexcept {
+  return mum(seed ^ HASH_SECRET_0, value ^ HASH_SECRET_1);
+}
+
+/// Hashes any value with its `std::hash` specialization.
+struct StandardHasher {
+  template <typename T>
+  std::size_t operator()(const T& value) const {
+    return std::hash<T>{}(value);
+  }
+};
+
+/// Hashes all elements of a tuple, in order, without copying them.
+///
+/// \param tuple The tuple to hash.
+/// \param hasher A function object hashing any of the element types.
+/// \returns The combined hash of the tuple's elements.
+template <typename... Ts, std::size_t... Is, typename Hasher>
+std::uint64_t hash_tuple(const std::tuple<Ts...>& tuple,
+                         std::index_sequence<Is...>,
+                         const Hasher& hasher) {
+  std::uint64_t seed = sizeof...(Ts);
+  // Expands to one hash_combine per element, evaluated left to right.
+  using Expander = int[];
+  (void)Expander{
+      0, (seed = hash_combine(seed, hasher(std::get<Is>(tuple))), 0)...};
+  return seed;
+}
+
+}  // namespace Internal
+}  // namespace LRU
 
 /// `std::hash` specialization to allow storing tuples as keys
 /// in `std::unordered_map`.
 ///
-/// Essentially hashes all tuple elements and jumbles the
-/// individual hashes together.
+/// Hashes all tuple elements by reference and mixes the individual hashes
+/// together with `LRU::Internal::hash_combine`.
 namespace std {
 template <typename... Ts>
 struct hash<std::tuple<Ts...>> {
@@ -38,23 +118,10 @@ struct hash<std::tuple<Ts...>> {
   using result_type = std::size_t;
 
   result_type operator()(const argument_type& argument) const {
-    return hash_tuple(argument, std::make_index_sequence<sizeof...(Ts)>());
-  }
-
- private:
-  template <std::size_t I, std::size_t... Is>
-  result_type
-  hash_tuple(const argument_type& tuple, std::index_sequence<I, Is...>) const {
-    auto value = std::get<I>(tuple);
-    auto current = std::hash<decltype(value)>{}(value);
-    auto seed = hash_tuple(tuple, std::index_sequence<Is...>());
-
-    // http://www.boost.org/doc/libs/1_35_0/doc/html/boost/hash_combine_id241013.html
-    return current + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-  }
-
-  result_type hash_tuple(const argument_type&, std::index_sequence<>) const {
-    return 0;
+    return static_cast<result_type>(
+        LRU::Internal::hash_tuple(argument,
+                                  std::make_index_sequence<sizeof...(Ts)>(),
+                                  LRU::Internal::StandardHasher()));
   }
 };
 }  // namespace std
@@ -0,0 +1,70 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_INTERNAL_RANDOM_HPP
+#define LRU_INTERNAL_RANDOM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace LRU {
+namespace Internal {
+
+/// A tiny, fast pseudo-random number generator (xorshift64*).
+///
+/// The caches need random numbers on hot paths (e.g. to sample eviction
+/// candidates), where the quality of `std::mt19937` is unnecessary and its
+/// state (about 5 KB) is far too large to store per cache. This generator
+/// keeps a single word of state and produces a number in a handful of cycles.
+class FastRandom {
+ public:
+  using result_type = std::uint64_t;
+
+  /// Constructor.
+  ///
+  /// \param seed The seed for the generator. Must not be zero.
+  explicit FastRandom(result_type seed = 0x9E3779B97F4A7C15ull) noexcept
+  : _state(seed ? seed : 0x9E3779B97F4A7C15ull) {
+  }
+
+  /// \returns The next pseudo-random number.
+  result_type operator()() noexcept {
+    _state ^= _state >> 12;
+    _state ^= _state << 25;
+    _state ^= _state >> 27;
+    return _state * 0x2545F4914F6CDD1Dull;
+  }
+
+  /// \returns A pseudo-random number in the range [0, bound).
+  /// \param bound The exclusive upper bound for the number. Must not be zero.
+  std::size_t below(std::size_t bound) noexcept {
+    return static_cast<std::size_t>((*this)() % bound);
+  }
+
+ private:
+  /// The state of the generator.
+  result_type _state;
+};
+
+}  // namespace Internal
+}  // namespace LRU
+
+#endif  // LRU_INTERNAL_RANDOM_HPP
@@ -0,0 +1,156 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_INTERNAL_RING_BUFFER_HPP
+#define LRU_INTERNAL_RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include <lru/internal/optional.hpp>
+
+namespace LRU {
+namespace Internal {
+
+/// A bounded, lock-free, multi-producer single-consumer queue.
+///
+/// Every slot carries a sequence number that tells producers and the consumer
+/// whether the slot is free for the current lap around the ring (the scheme of
+/// Dmitry Vyukov's bounded queue). Producers claim positions with a CAS on the
+/// tail; the single consumer owns the head and needs no atomic RMW at all.
+/// Neither side ever blocks: `try_push()` fails when the ring is full and
+/// `try_pop()` fails when it is empty.
+///
+/// \tparam T The type of the elements.
+template <typename T>
+class RingBuffer {
+ public:
+  /// Constructor.
+  ///
+  /// \param capacity The minimum number of elements the ring can hold. It is
+  ///                 rounded up to the next power of two.
+  explicit RingBuffer(std::size_t capacity)
+  : _capacity(_round_up(capacity))
+  , _mask(_capacity - 1)
+  , _slots(new Slot[_capacity])
+  , _tail(0)
+  , _head(0) {
+    for (std::size_t index = 0; index < _capacity; ++index) {
+      _slots[index].sequence.store(index, std::memory_order_relaxed);
+    }
+  }
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  /// Attempts to enqueue an element. May be called from any thread.
+  ///
+  /// \param element The element to enqueue.
+  /// \returns True if the element was enqueued, false if the ring was full.
+  bool try_push(T&& element) {
+    auto position = _tail.load(std::memory_order_relaxed);
+    while (true) {
+      auto& slot = _slots[position & _mask];
+      auto sequence = slot.sequence.load(std::memory_order_acquire);
+      auto difference = static_cast<std::ptrdiff_t>(sequence) -
+                        static_cast<std::ptrdiff_t>(position);
+      if (difference == 0) {
+        if (_tail.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          slot.value.emplace(std::move(element));
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = _tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Attempts to dequeue an element. Must only be called from the (single)
+  /// consumer thread.
+  ///
+  /// \param element The optional to move the dequeued element into.
+  /// \returns True if an element was dequeued, false if the ring was empty.
+  bool try_pop(Optional<T>& element) {
+    auto& slot = _slots[_head & _mask];
+    auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != _head + 1) return false;
+
+    element.emplace(std::move(*slot.value));
+    slot.value.reset();
+    slot.sequence.store(_head + _capacity, std::memory_order_release);
+    ++_head;
+
+    return true;
+  }
+
+  /// \returns The number of elements pushed into the ring so far.
+  std::size_t pushed() const noexcept {
+    return _tail.load(std::memory_order_acquire);
+  }
+
+  /// \returns The number of elements the ring can hold.
+  std::size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+ private:
+  /// A single element of the ring.
+  struct Slot {
+    /// The position (lap) this slot is ready for.
+    std::atomic<std::size_t> sequence;
+
+    /// The element stored in the slot, if any.
+    Optional<T> value;
+  };
+
+  /// \returns The smallest power of two not less than the given capacity.
+  static std::size_t _round_up(std::size_t capacity) noexcept {
+    std::size_t result = 1;
+    while (result < capacity) result <<= 1;
+    return result;
+  }
+
+  /// The number of slots (a power of two).
+  std::size_t _capacity;
+
+  /// `_capacity - 1`, to map positions to slots.
+  std::size_t _mask;
+
+  /// The slots of the ring.
+  std::unique_ptr<Slot[]> _slots;
+
+  /// The next position to be claimed by a producer.
+  std::atomic<std::size_t> _tail;
+
+  /// The next position to be read by the consumer.
+  std::size_t _head;
+};
+
+}  // namespace Internal
+}  // namespace LRU
+
+#endif  // LRU_INTERNAL_RING_BUFFER_HPP
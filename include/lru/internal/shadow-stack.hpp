@@ -0,0 +1,274 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_INTERNAL_SHADOW_STACK_HPP
+#define LRU_INTERNAL_SHADOW_STACK_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+#include <lru/internal/definitions.hpp>
+
+namespace LRU {
+namespace Internal {
+
+/// The type-erased interface of a shadow stack.
+class AbstractShadowStack {
+ public:
+  using size_t = std::size_t;
+
+  /// Destructor.
+  virtual ~AbstractShadowStack() = default;
+
+  /// Sets the capacity the shadow stack simulates.
+  ///
+  /// \param capacity The capacity of the simulated cache.
+  /// \param step The number of slots by which the capacity might change.
+  virtual void resize(size_t capacity, size_t step) = 0;
+
+  /// \returns The number of hits that would be lost if the simulated cache
+  /// shrank by one step.
+  virtual size_t tail_hits() const = 0;
+
+  /// \returns The number of hits that would be gained if the simulated cache
+  /// grew by one step.
+  virtual size_t ghost_hits() const = 0;
+
+  /// Halves the hit counters, so that old measurements fade out.
+  virtual void decay() = 0;
+};
+
+/// A sampled simulation of the tail of an LRU cache and of what lies beyond it.
+///
+/// The shadow stack is fed the keys a real cache is asked for and replays them
+/// against an LRU list of keys only, split into three segments: the *head*
+/// (the capacity minus one step), the *tail* (the last step of the capacity)
+/// and the *ghost* segment (one step beyond the capacity). Hits in the tail
+/// are hits the cache would lose by shrinking one step, hits in the ghost
+/// segment are hits it would gain by growing one step.
+///
+/// To keep the overhead low, only a fixed fraction of keys (chosen by hash, so
+/// that a key is either always or never sampled) is simulated, with all
+/// segments scaled down by the same rate.
+///
+/// Every operation on the stack takes an internal mutex, since the owning
+/// cache may feed it from its asynchronous callback thread while the
+/// controller resizes and reads it from another.
+///
+/// \tparam Key The key type of the simulated cache.
+/// \tparam HashFunction The hash function type for the internal map.
+/// \tparam KeyEqual The type of the key equality function for the internal map.
+template <typename Key, typename HashFunction, typename KeyEqual>
+class ShadowStack : public AbstractShadowStack {
+ public:
+  /// Constructor.
+  ///
+  /// \param sampling_rate The fraction of keys to simulate, in `(0, 1]`.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  explicit ShadowStack(double sampling_rate,
+                       const HashFunction& hash = HashFunction(),
+                       const KeyEqual& key_equal = KeyEqual())
+  : _map(0, hash, key_equal)
+  , _sampling_rate(sampling_rate)
+  , _threshold(_threshold_for(sampling_rate))
+  , _limits{0, 0, 0}
+  , _tail_hits(0)
+  , _ghost_hits(0) {
+  }
+
+  /// Replays an access to the given key.
+  ///
+  /// \param key The key that was accessed.
+  void access(const Key& key) {
+    if (!_is_sampled(key)) return;
+
+    std::lock_guard<std::mutex> guard(_mutex);
+    auto iterator = _map.find(key);
+    if (iterator == _map.end()) {
+      iterator = _map.emplace(key, Entry{HEAD, QueueIterator()}).first;
+      auto& head = _segments[HEAD];
+      head.emplace_back(iterator->first);
+      iterator->second.order = std::prev(head.end());
+    } else {
+      auto& entry = iterator->second;
+      if (entry.segment == TAIL) {
+        _tail_hits += 1;
+      } else if (entry.segment == GHOST) {
+        _ghost_hits += 1;
+      }
+
+      _move(entry, HEAD);
+    }
+
+    _fit();
+  }
+
+  /// \copydoc AbstractShadowStack::resize()
+  void resize(size_t capacity, size_t step) override {
+    std::lock_guard<std::mutex> guard(_mutex);
+    step = std::min(step, capacity);
+    _limits[HEAD] = _scaled(capacity - step);
+    _limits[TAIL] = _scaled(step);
+    _limits[GHOST] = _scaled(step);
+    _fit();
+  }
+
+  /// \copydoc AbstractShadowStack::tail_hits()
+  size_t tail_hits() const override {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _tail_hits;
+  }
+
+  /// \copydoc AbstractShadowStack::ghost_hits()
+  size_t ghost_hits() const override {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _ghost_hits;
+  }
+
+  /// \copydoc AbstractShadowStack::decay()
+  void decay() override {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _tail_hits /= 2;
+    _ghost_hits /= 2;
+  }
+
+  /// \returns The number of keys currently simulated.
+  size_t size() const {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _map.size();
+  }
+
+ private:
+  using Queue = Internal::Queue<const Key>;
+  using QueueIterator = typename Queue::iterator;
+
+  /// The segments of the stack, from most to least recently used.
+  enum Segment { HEAD, TAIL, GHOST, SEGMENTS };
+
+  /// The simulated position of a key.
+  struct Entry {
+    /// The segment the key lives in.
+    Segment segment;
+
+    /// The position of the key in its segment.
+    QueueIterator order;
+  };
+
+  using Map = Internal::Map<Key, Entry, HashFunction, KeyEqual>;
+
+  /// Moves a key to the most recently used end of a segment.
+  ///
+  /// \param entry The entry of the key.
+  /// \param segment The segment to move the key to.
+  void _move(Entry& entry, Segment segment) {
+    auto& queue = _segments[segment];
+    queue.splice(queue.end(), _segments[entry.segment], entry.order);
+    entry.segment = segment;
+  }
+
+  /// Moves keys between segments until every segment respects its limit.
+  ///
+  /// Overflowing keys are demoted from the least recently used end of one
+  /// segment to the most recently used end of the next. If a segment has room
+  /// (because the capacity grew), keys are promoted back the other way.
+  void _fit() {
+    for (int segment = HEAD; segment + 1 < SEGMENTS; ++segment) {
+      auto& queue = _segments[segment];
+      auto& next = _segments[segment + 1];
+
+      while (queue.size() < _limits[segment] && !next.empty()) {
+        auto& entry = _map.find(next.back().get())->second;
+        queue.splice(queue.begin(), next, entry.order);
+        entry.segment = static_cast<Segment>(segment);
+      }
+
+      while (queue.size() > _limits[segment]) {
+        auto& entry = _map.find(queue.front().get())->second;
+        next.splice(next.end(), queue, entry.order);
+        entry.segment = static_cast<Segment>(segment + 1);
+      }
+    }
+
+    auto& ghost = _segments[GHOST];
+    while (ghost.size() > _limits[GHOST]) {
+      auto iterator = _map.find(ghost.front().get());
+      ghost.pop_front();
+      _map.erase(iterator);
+    }
+  }
+
+  /// \returns True if the key is part of the sample, else false.
+  /// \param key The key to check.
+  bool _is_sampled(const Key& key) const {
+    // Mix the hash, since hashes of integers are often the integers themselves.
+    auto hash = static_cast<std::uint64_t>(_map.hash_function()(key));
+    hash *= 0x9E3779B97F4A7C15ull;
+    return (hash >> 32) < _threshold;
+  }
+
+  /// \returns The number of sampled keys in a stretch of the simulated cache.
+  /// \param slots The number of slots in the simulated cache.
+  size_t _scaled(size_t slots) const noexcept {
+    return static_cast<size_t>(std::ceil(slots * _sampling_rate));
+  }
+
+  /// \returns The threshold below which mixed hashes are sampled.
+  /// \param sampling_rate The fraction of keys to sample.
+  static std::uint64_t _threshold_for(double sampling_rate) noexcept {
+    return static_cast<std::uint64_t>(sampling_rate * 4294967296.0);
+  }
+
+  /// The map from simulated keys to their positions.
+  Map _map;
+
+  /// The segments of the stack.
+  Queue _segments[SEGMENTS];
+
+  /// The fraction of keys simulated.
+  double _sampling_rate;
+
+  /// The threshold below which mixed hashes are sampled.
+  std::uint64_t _threshold;
+
+  /// The maximum number of keys in each segment.
+  size_t _limits[SEGMENTS];
+
+  /// The number of hits in the tail segment.
+  size_t _tail_hits;
+
+  /// The number of hits in the ghost segment.
+  size_t _ghost_hits;
+
+  /// Guards all of the above against concurrent feeding and resizing.
+  mutable std::mutex _mutex;
+};
+
+}  // namespace Internal
+}  // namespace LRU
+
+#endif  // LRU_INTERNAL_SHADOW_STACK_HPP
@@ -23,6 +23,7 @@
 #define LRU_STATISTICS_MUTATOR_HPP
 
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <memory>
 #include <utility>
@@ -82,9 +83,24 @@ class StatisticsMutator {
     _stats->_total_accesses += 1;
     _stats->_total_hits += 1;
 
+    const auto weight = _stats->_sample(_stats->_hit_countdown, key);
+    if (weight == 0) return;
+
+    if (_stats->_recent) {
+      const auto now = RecentActivity::Clock::now();
+      _stats->_recent->record(Event::Hit, now, weight);
+    }
+
+    if (_stats->_hot_hits) {
+      _stats->_hot_hits->record(key, weight);
+    }
+
+    // Skip the extra hash lookup entirely if no keys are monitored
+    if (_stats->_key_map.empty()) return;
+
     auto iterator = _stats->_key_map.find(key);
     if (iterator != _stats->_key_map.end()) {
-      iterator->second.hits += 1;
+      iterator->second.hits += weight;
     }
   }
 
@@ -96,12 +112,91 @@ class StatisticsMutator {
 
     _stats->_total_accesses += 1;
 
+    const auto weight = _stats->_sample(_stats->_miss_countdown, key);
+    if (weight == 0) return;
+
+    if (_stats->_recent) {
+      const auto now = RecentActivity::Clock::now();
+      _stats->_recent->record(Event::Miss, now, weight);
+    }
+
+    if (_stats->_hot_misses) {
+      _stats->_hot_misses->record(key, weight);
+    }
+
+    if (_stats->_key_map.empty()) return;
+
     auto iterator = _stats->_key_map.find(key);
     if (iterator != _stats->_key_map.end()) {
-      iterator->second.misses += 1;
+      iterator->second.misses += weight;
     }
   }
 
+  /// Registers the insertion of a new key with the internal statistics.
+  void register_insertion() {
+    assert(has_stats());
+
+    if (_stats->_recent) {
+      _stats->_recent->record(Event::Insertion);
+    }
+  }
+
+  /// Registers the eviction of a key with the internal statistics.
+  void register_eviction() {
+    assert(has_stats());
+
+    _stats->_total_evictions += 1;
+
+    if (_stats->_recent) {
+      _stats->_recent->record(Event::Eviction);
+    }
+  }
+
+  /// Registers the lifetime of an evicted key with the internal statistics.
+  ///
+  /// \param age The time since the key was inserted.
+  /// \param idle_time The time since the last hit on the key.
+  /// \param hits The number of hits on the key.
+  template <typename Duration>
+  void register_lifetime(const Duration& age,
+                         const Duration& idle_time,
+                         std::size_t hits) {
+    assert(tracks_lifetimes());
+
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+
+    using Stats = Statistics<Key>;
+    auto& lifetimes = _stats->_lifetimes;
+    lifetimes[Stats::AGE].record(duration_cast<milliseconds>(age).count());
+    lifetimes[Stats::IDLE_TIME].record(
+        duration_cast<milliseconds>(idle_time).count());
+    lifetimes[Stats::HITS].record(hits);
+  }
+
+  /// Registers the clearing of an expired key with the internal statistics.
+  void register_expiration() {
+    assert(has_stats());
+    _stats->_total_expirations += 1;
+  }
+
+  /// Registers the explicit erasure of a key with the internal statistics.
+  void register_erasure() {
+    assert(has_stats());
+    _stats->_total_erasures += 1;
+  }
+
+  /// Registers the overwrite of a key's value with the internal statistics.
+  void register_overwrite() {
+    assert(has_stats());
+    _stats->_total_overwrites += 1;
+  }
+
+  /// \returns True if the statistics track the lifetimes of keys, else false.
+  bool tracks_lifetimes() const noexcept {
+    return has_stats() && _stats->is_tracking_lifetimes();
+  }
+
   /// \returns A reference to the statistics object.
   Statistics<Key>& get() noexcept {
     assert(has_stats());
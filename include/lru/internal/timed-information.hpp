@@ -106,8 +106,9 @@ struct TimedInformation : public Information<Key, Value> {
     return !(*this == other);
   }
 
-  /// The time at which the key of the information was insterted into a cache.
-  const Timestamp insertion_time;
+  /// The time at which the key of the information was insterted into a cache,
+  /// or its value last overwritten.
+  Timestamp insertion_time;
 };
 
 }  // namespace Internal
@@ -0,0 +1,85 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_INTERNAL_TRACKED_INFORMATION_HPP
+#define LRU_INTERNAL_TRACKED_INFORMATION_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#include <lru/internal/definitions.hpp>
+
+namespace LRU {
+namespace Internal {
+
+/// An information object that additionally stores the stamp of the last access
+/// to its key, for memory arbitration.
+///
+/// \tparam Base The information class to extend.
+template <typename Base>
+struct StampedInformation : public Base {
+  using Base::Base;
+
+  /// The time of the last access to the key, as stamped by a memory arbiter.
+  mutable std::uint64_t last_access = 0;
+};
+
+/// The lifetime of a key, as far as statistics record it upon eviction.
+struct Lifetime {
+  /// The time the key was inserted, if the statistics track lifetimes.
+  Timestamp inserted;
+
+  /// The time of the last hit on (or insertion of) the key.
+  Timestamp touched;
+
+  /// The number of hits on the key.
+  std::uint32_t hits = 0;
+};
+
+/// An information object that additionally stores the lifetime of its key,
+/// for lifetime statistics.
+///
+/// \tparam Base The information class to extend.
+template <typename Base>
+struct LifetimeInformation : public Base {
+  using Base::Base;
+
+  /// The lifetime of the key.
+  mutable Lifetime lifetime;
+};
+
+/// The information class holding the bookkeeping required by a tracking
+/// policy, on top of the given information class.
+///
+/// \tparam Base The information class to extend.
+/// \tparam Tracking The tracking policy (see `LRU::NoTracking`).
+template <typename Base, typename Tracking>
+using TrackedInformation = std::conditional_t<
+    Tracking::lifetimes,
+    LifetimeInformation<std::conditional_t<Tracking::accesses,
+                                           StampedInformation<Base>,
+                                           Base>>,
+    std::conditional_t<Tracking::accesses, StampedInformation<Base>, Base>>;
+
+}  // namespace Internal
+}  // namespace LRU
+
+#endif  // LRU_INTERNAL_TRACKED_INFORMATION_HPP
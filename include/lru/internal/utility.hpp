@@ -25,6 +25,7 @@
 #include <cstddef>
 #include <iterator>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace LRU {
@@ -68,6 +69,50 @@ constexpr T construct_from_tuple(std::tuple<Args...>&& args) {
   return construct_from_tuple<T>(std::move(args), tuple_indices(args));
 }
 
+/// Deduces the return type and (decayed) argument types of a callable.
+///
+/// Works for function pointers, function references and function objects
+/// with a single, non-template call operator (e.g. non-generic lambdas).
+///
+/// \tparam F The type of the callable.
+template <typename F>
+struct FunctionTraits : FunctionTraits<decltype(&std::decay_t<F>::operator())> {
+};
+
+template <typename R, typename... Args>
+struct FunctionTraits<R(Args...)> {
+  using ReturnType = R;
+  using Arguments = std::tuple<std::decay_t<Args>...>;
+};
+
+template <typename R, typename... Args>
+struct FunctionTraits<R (*)(Args...)> : FunctionTraits<R(Args...)> {};
+
+template <typename R, typename... Args>
+struct FunctionTraits<R (&)(Args...)> : FunctionTraits<R(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...)> : FunctionTraits<R(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...) const> : FunctionTraits<R(Args...)> {};
+
+#ifdef __cpp_noexcept_function_type
+template <typename R, typename... Args>
+struct FunctionTraits<R(Args...) noexcept> : FunctionTraits<R(Args...)> {};
+
+template <typename R, typename... Args>
+struct FunctionTraits<R (*)(Args...) noexcept> : FunctionTraits<R(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...) noexcept>
+    : FunctionTraits<R(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...) const noexcept>
+    : FunctionTraits<R(Args...)> {};
+#endif
+
 /// A type trait that disables a template overload if a type is not an iterator.
 ///
 /// \tparam T the type to check.
@@ -0,0 +1,202 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_LATENCY_HISTOGRAM_HPP
+#define LRU_LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace LRU {
+
+/// A histogram of latencies (in nanoseconds) with bounded relative error.
+///
+/// The histogram is log-linear, in the spirit of HDR histograms: values below
+/// `SUB_BUCKETS` are recorded exactly and every power of two above is split
+/// into 16 linear sub-buckets, so any recorded value is known to within about
+/// 6% (1/16) of its magnitude, from single nanoseconds up to about a minute
+/// (larger values are clamped). Recording is a handful of
+/// integer operations and the histogram has a fixed size.
+class LatencyHistogram {
+ public:
+  using size_t = std::size_t;
+  using Count = std::uint64_t;
+  using Nanoseconds = std::uint64_t;
+
+  /// The number of significant bits kept of each value. The leading bit is
+  /// always set, so each power of two gets `SUB_BUCKETS / 2` sub-buckets.
+  static constexpr unsigned SUB_BUCKET_BITS = 5;
+
+  /// The number of values recorded exactly, and twice the number of linear
+  /// sub-buckets per power of two above them.
+  static constexpr Nanoseconds SUB_BUCKETS = Nanoseconds(1) << SUB_BUCKET_BITS;
+
+  /// The largest value that can be recorded without being clamped.
+  static constexpr Nanoseconds MAX_VALUE = (Nanoseconds(1) << 36) - 1;
+
+  /// The total number of buckets.
+  static constexpr size_t BUCKETS = 528;
+
+  /// Constructor.
+  LatencyHistogram() noexcept : _counts{}, _total(0), _sum(0), _max(0) {
+  }
+
+  /// Records a single value.
+  ///
+  /// \param nanoseconds The value to record.
+  void record(Nanoseconds nanoseconds) noexcept {
+    record(nanoseconds, 1);
+  }
+
+  /// Records a value a number of times.
+  ///
+  /// \param nanoseconds The value to record.
+  /// \param count The number of times to record the value.
+  void record(Nanoseconds nanoseconds, Count count) noexcept {
+    _counts[bucket_for(nanoseconds)] += count;
+    _total += count;
+    _sum += nanoseconds * count;
+    _max = std::max(_max, nanoseconds);
+  }
+
+  /// Adds all values recorded by another histogram to this one.
+  ///
+  /// \param other The histogram to merge.
+  void merge(const LatencyHistogram& other) noexcept {
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+      _counts[bucket] += other._counts[bucket];
+    }
+    _total += other._total;
+    _sum += other._sum;
+    _max = std::max(_max, other._max);
+  }
+
+  /// Returns the value below or at which the given fraction of all values
+  /// lie (e.g. `percentile(0.99)` for the p99).
+  ///
+  /// The result is the upper bound of the bucket holding the value of that
+  /// rank, but never greater than the largest value recorded.
+  ///
+  /// \param fraction The fraction of values, in `[0, 1]`.
+  /// \returns The percentile, or zero if no values were recorded.
+  Nanoseconds percentile(double fraction) const noexcept {
+    if (_total == 0) return 0;
+
+    fraction = std::min(std::max(fraction, 0.0), 1.0);
+    const auto rank =
+        std::max<Count>(static_cast<Count>(std::ceil(fraction * _total)), 1);
+
+    Count seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+      seen += _counts[bucket];
+      if (seen >= rank) {
+        return std::min(upper_bound_of(bucket), _max);
+      }
+    }
+
+    return _max;
+  }
+
+  /// \returns The number of recorded values.
+  Count count() const noexcept {
+    return _total;
+  }
+
+  /// \returns The mean of all recorded values, or zero if there are none.
+  double mean() const noexcept {
+    return _total ? static_cast<double>(_sum) / _total : 0;
+  }
+
+  /// \returns The largest recorded value.
+  Nanoseconds max() const noexcept {
+    return _max;
+  }
+
+  /// Clears all recorded values.
+  void reset() noexcept {
+    _counts.fill(0);
+    _total = 0;
+    _sum = 0;
+    _max = 0;
+  }
+
+  /// \returns The index of the bucket for the given value.
+  /// \param nanoseconds The value.
+  static size_t bucket_for(Nanoseconds nanoseconds) noexcept {
+    nanoseconds = std::min(nanoseconds, MAX_VALUE);
+    if (nanoseconds < SUB_BUCKETS) return static_cast<size_t>(nanoseconds);
+
+    // Keep the SUB_BUCKET_BITS most significant bits of the value.
+    const unsigned shift = _most_significant_bit(nanoseconds) -
+                           (SUB_BUCKET_BITS - 1);
+    return static_cast<size_t>(shift * (SUB_BUCKETS / 2) +
+                               (nanoseconds >> shift));
+  }
+
+  /// \returns The largest value that falls into the given bucket.
+  /// \param bucket The index of the bucket.
+  static Nanoseconds upper_bound_of(size_t bucket) noexcept {
+    if (bucket < SUB_BUCKETS) return bucket;
+
+    const auto shift = bucket / (SUB_BUCKETS / 2) - 1;
+    const auto mantissa = bucket - shift * (SUB_BUCKETS / 2);
+    return ((Nanoseconds(mantissa) + 1) << shift) - 1;
+  }
+
+ private:
+  /// \returns The index of the most significant bit set in the value.
+  /// \param value The value, which must not be zero.
+  static unsigned _most_significant_bit(Nanoseconds value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned bit = 0;
+    while (value >>= 1) {
+      bit += 1;
+    }
+
+    return bit;
+#endif
+  }
+
+  /// The number of values recorded in each bucket.
+  std::array<Count, BUCKETS> _counts;
+
+  /// The number of recorded values.
+  Count _total;
+
+  /// The sum of all recorded values.
+  Nanoseconds _sum;
+
+  /// The largest recorded value.
+  Nanoseconds _max;
+};
+
+namespace Lowercase {
+using latency_histogram = LatencyHistogram;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,245 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_LATENCY_STATISTICS_HPP
+#define LRU_LATENCY_STATISTICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <lru/latency-histogram.hpp>
+
+namespace LRU {
+
+/// The cache operations whose latencies can be recorded.
+enum class Operation {
+  Find,
+  Insert,
+  Emplace,
+  Erase,
+  Evict,
+  ClearExpired,
+};
+
+/// Records the latencies of cache operations in per-operation histograms.
+///
+/// Like `Statistics`, a latency statistics object can be shared between
+/// several caches, including caches used from different threads. Threads
+/// record into one of a fixed number of shards, chosen by thread, so recording
+/// never takes a lock and rarely contends on a cache line. The shards are
+/// merged when the histograms are read. The counts of an operation in a shard
+/// are only allocated once the shard records that operation, so an object
+/// used by one thread for lookups only holds a single histogram's worth of
+/// counts.
+class LatencyStatistics {
+ public:
+  using size_t = std::size_t;
+  using Nanoseconds = LatencyHistogram::Nanoseconds;
+
+  /// The number of distinct operations.
+  static constexpr size_t OPERATIONS = 6;
+
+  /// The number of shards the threads are spread across.
+  static constexpr size_t SHARDS = 8;
+
+  /// Constructor.
+  LatencyStatistics() {
+    for (auto& counts : _counts) {
+      counts.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  LatencyStatistics(const LatencyStatistics&) = delete;
+  LatencyStatistics& operator=(const LatencyStatistics&) = delete;
+
+  /// Destructor.
+  ~LatencyStatistics() {
+    for (auto& counts : _counts) {
+      delete counts.load(std::memory_order_relaxed);
+    }
+  }
+
+  /// Records the latency of an operation, in the shard of the calling thread.
+  ///
+  /// \param operation The operation.
+  /// \param nanoseconds The latency of the operation.
+  void record(Operation operation, Nanoseconds nanoseconds) {
+    auto& counts = _counts_for(_shard_of_this_thread(), operation);
+    const auto bucket = LatencyHistogram::bucket_for(nanoseconds);
+    counts[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Merges the shards of all threads into a histogram for the operation.
+  ///
+  /// \param operation The operation.
+  /// \returns The histogram of latencies of the operation.
+  LatencyHistogram histogram(Operation operation) const {
+    LatencyHistogram histogram;
+
+    for (size_t shard = 0; shard < SHARDS; ++shard) {
+      const auto& slot = _slot(shard, operation);
+      const auto* counts = slot.load(std::memory_order_acquire);
+      if (counts == nullptr) continue;
+      for (size_t bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+        const auto count = (*counts)[bucket].load(std::memory_order_relaxed);
+        if (count > 0) {
+          histogram.record(LatencyHistogram::upper_bound_of(bucket), count);
+        }
+      }
+    }
+
+    return histogram;
+  }
+
+  /// \returns The latency below which the given fraction of all recorded
+  /// latencies of the operation lie.
+  /// \param operation The operation.
+  /// \param fraction The fraction, e.g. `0.99` for the p99.
+  Nanoseconds percentile(Operation operation, double fraction) const {
+    return histogram(operation).percentile(fraction);
+  }
+
+  /// Clears the recorded latencies of all operations and threads.
+  ///
+  /// Latencies recorded concurrently with a reset may or may not be cleared.
+  void reset() {
+    for (auto& slot : _counts) {
+      auto* counts = slot.load(std::memory_order_acquire);
+      if (counts == nullptr) continue;
+      for (auto& count : *counts) {
+        count.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  using Counts =
+      std::array<std::atomic<std::uint64_t>, LatencyHistogram::BUCKETS>;
+
+  /// Allocates counts of one operation in one shard, all zero.
+  static Counts* _new_counts() {
+    auto* counts = new Counts();
+    for (auto& count : *counts) {
+      count.store(0, std::memory_order_relaxed);
+    }
+
+    return counts;
+  }
+
+  /// \returns The shard of the calling thread.
+  static size_t _shard_of_this_thread() {
+    static std::atomic<size_t> next_thread(0);
+    thread_local const size_t shard =
+        next_thread.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return shard;
+  }
+
+  /// \returns The slot holding the counts of the operation in the shard.
+  /// \param shard The shard.
+  /// \param operation The operation.
+  std::atomic<Counts*>& _slot(size_t shard, Operation operation) {
+    return _counts[shard * OPERATIONS + static_cast<size_t>(operation)];
+  }
+
+  /// \copydoc _slot(size_t,Operation)
+  const std::atomic<Counts*>& _slot(size_t shard, Operation operation) const {
+    return _counts[shard * OPERATIONS + static_cast<size_t>(operation)];
+  }
+
+  /// \returns The counts of the operation in the shard, allocating them if
+  /// necessary.
+  /// \param shard The shard.
+  /// \param operation The operation.
+  Counts& _counts_for(size_t shard, Operation operation) {
+    auto& slot = _slot(shard, operation);
+    auto* counts = slot.load(std::memory_order_acquire);
+    if (counts != nullptr) return *counts;
+
+    // Threads sharing the shard may race to allocate, only one of them wins.
+    auto* fresh = _new_counts();
+    if (slot.compare_exchange_strong(
+            counts, fresh, std::memory_order_acq_rel)) {
+      return *fresh;
+    }
+
+    delete fresh;
+    return *counts;
+  }
+
+  /// The counts of each operation in each shard, or null if the shard has not
+  /// recorded the operation yet.
+  std::array<std::atomic<Counts*>, SHARDS * OPERATIONS> _counts;
+};
+
+namespace Internal {
+
+/// Records the latency of an operation when it goes out of scope.
+///
+/// Does nothing (not even read the clock) if no statistics are given.
+class LatencyTimer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Constructor.
+  ///
+  /// \param statistics The statistics to record into, or null.
+  /// \param operation The operation to time.
+  LatencyTimer(LatencyStatistics* statistics, Operation operation)
+  : _statistics(statistics), _operation(operation) {
+    if (_statistics) _start = Clock::now();
+  }
+
+  LatencyTimer(const LatencyTimer&) = delete;
+  LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+  /// Destructor, recording the latency.
+  ~LatencyTimer() {
+    if (!_statistics) return;
+    const auto elapsed = Clock::now() - _start;
+    const auto nanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    _statistics->record(_operation, static_cast<std::uint64_t>(nanoseconds));
+  }
+
+ private:
+  /// The statistics to record into, or null.
+  LatencyStatistics* _statistics;
+
+  /// The operation to time.
+  Operation _operation;
+
+  /// The time the operation started.
+  Clock::time_point _start;
+};
+
+}  // namespace Internal
+
+namespace Lowercase {
+using operation = Operation;
+using latency_statistics = LatencyStatistics;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_LATENCY_STATISTICS_HPP
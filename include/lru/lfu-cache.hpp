@@ -0,0 +1,707 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_LFU_CACHE_HPP
+#define LRU_LFU_CACHE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include <lru/cache-tags.hpp>
+#include <lru/error.hpp>
+#include <lru/hash.hpp>
+#include <lru/internal/cache-monitor.hpp>
+#include <lru/internal/callback-manager.hpp>
+#include <lru/internal/definitions.hpp>
+#include <lru/internal/frequency-buckets.hpp>
+#include <lru/internal/last-accessed.hpp>
+#include <lru/internal/statistics-mutator.hpp>
+#include <lru/internal/utility.hpp>
+#include <lru/statistics.hpp>
+
+namespace LRU {
+namespace Internal {
+
+/// The value type of the internal map of an `LfuCache`.
+///
+/// Instead of an iterator into an order queue, this information object stores
+/// a handle to its key in the cache's frequency buckets.
+///
+/// \tparam Key The key type of the information.
+/// \tparam Value The value type of the information.
+template <typename Key, typename Value>
+struct FrequencyInformation {
+  using KeyType = Key;
+  using ValueType = Value;
+  using Buckets = FrequencyBuckets<Reference<const Key>>;
+  using Handle = typename Buckets::Handle;
+
+  /// Constructor.
+  ///
+  /// \param value_ The value for the information.
+  template <typename AnyValue>
+  explicit FrequencyInformation(AnyValue&& value_)
+  : value(std::forward<AnyValue>(value_)) {
+  }
+
+  /// The value of the information.
+  Value value;
+
+  /// The handle of the key in the frequency buckets.
+  Handle handle;
+};
+
+}  // namespace Internal
+
+/// A least-frequently-used (LFU) cache.
+///
+/// Every key counts how often it was accessed, and the key with the lowest
+/// count is evicted first (the least recently used one, on ties). Keys with
+/// the same count are kept in buckets, so hits, insertions and evictions are
+/// all O(1).
+///
+/// Plain LFU never forgets: keys that were popular a long time ago keep their
+/// counts forever. To adapt to shifts in popularity, the cache can halve all
+/// counts after every given number of accesses (see `decay_period()`), which
+/// amounts to an exponential decay of old accesses.
+///
+/// \tparam Key The key type of the cache.
+/// \tparam Value The value type of the cache.
+/// \tparam HashFunction The hash function type for the internal map.
+/// \tparam KeyEqual The type of the key equality function for the internal map.
+template <typename Key,
+          typename Value,
+          typename HashFunction = DefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class LfuCache : private Internal::CacheMonitor<Key, Value> {
+ private:
+  using monitoring = Internal::CacheMonitor<Key, Value>;
+  using PRIVATE_CACHE_MONITOR_MEMBERS
+
+  using Information = Internal::FrequencyInformation<Key, Value>;
+  using Buckets = typename Information::Buckets;
+  using Handle = typename Information::Handle;
+
+  using Map = Internal::Map<Key, Information, HashFunction, KeyEqual>;
+  using MapIterator = typename Map::iterator;
+  using MapConstIterator = typename Map::const_iterator;
+
+  using typename monitoring::CallbackManagerType;
+  using HitCallback = typename CallbackManagerType::HitCallback;
+  using MissCallback = typename CallbackManagerType::MissCallback;
+  using AccessCallback = typename CallbackManagerType::AccessCallback;
+  using HitCallbackContainer =
+      typename CallbackManagerType::HitCallbackContainer;
+  using MissCallbackContainer =
+      typename CallbackManagerType::MissCallbackContainer;
+  using AccessCallbackContainer =
+      typename CallbackManagerType::AccessCallbackContainer;
+
+  using LastAccessed =
+      typename Internal::LastAccessed<Key, Information, KeyEqual>;
+
+ public:
+  using Tag = LRU::Tag::LfuCache;
+  using InitializerList = std::initializer_list<std::pair<Key, Value>>;
+  using StatisticsPointer = std::shared_ptr<Statistics<Key>>;
+  using size_t = std::size_t;
+
+  static constexpr Tag tag() noexcept {
+    return {};
+  }
+
+  /// Constructor.
+  ///
+  /// \param capacity The capacity of the cache.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  explicit LfuCache(size_t capacity = Internal::DEFAULT_CAPACITY,
+                    const HashFunction& hash = HashFunction(),
+                    const KeyEqual& key_equal = KeyEqual())
+  : _map(0, hash, key_equal)
+  , _last_accessed(key_equal)
+  , _capacity(capacity)
+  , _decay_period(0)
+  , _accesses(0) {
+  }
+
+  /// Constructor.
+  ///
+  /// \param capacity The capacity of the cache.
+  /// \param list The initializer list to construct the cache with.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  LfuCache(size_t capacity,
+           InitializerList list,
+           const HashFunction& hash = HashFunction(),
+           const KeyEqual& key_equal = KeyEqual())
+  : LfuCache(capacity, hash, key_equal) {
+    insert(list);
+  }
+
+  /// Constructor.
+  ///
+  /// \param list The initializer list to construct the cache with.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  LfuCache(InitializerList list,
+           const HashFunction& hash = HashFunction(),
+           const KeyEqual& key_equal = KeyEqual())  // NOLINT(runtime/explicit)
+      : LfuCache(list.size(), list, hash, key_equal) {
+  }
+
+  /// Copy constructor.
+  LfuCache(const LfuCache& other)
+  : monitoring(other)
+  , _map(other._map)
+  , _buckets(other._buckets)
+  , _last_accessed(other._last_accessed.key_equal())
+  , _capacity(other._capacity)
+  , _decay_period(other._decay_period)
+  , _accesses(other._accesses) {
+    _reassign_handles();
+  }
+
+  /// Move constructor.
+  LfuCache(LfuCache&& other) = default;
+
+  /// Copy assignment operator.
+  LfuCache& operator=(const LfuCache& other) {
+    if (this != &other) {
+      LfuCache copy(other);
+      swap(copy);
+    }
+
+    return *this;
+  }
+
+  /// Move assignment operator.
+  LfuCache& operator=(LfuCache&& other) = default;
+
+  /// Swaps the contents of the cache with another cache.
+  ///
+  /// \param other The other cache to swap with.
+  void swap(LfuCache& other) noexcept {
+    using std::swap;
+
+    swap(_map, other._map);
+    swap(_buckets, other._buckets);
+    swap(_stats, other._stats);
+    swap(_last_accessed, other._last_accessed);
+    swap(_callback_manager, other._callback_manager);
+    swap(_capacity, other._capacity);
+    swap(_decay_period, other._decay_period);
+    swap(_accesses, other._accesses);
+  }
+
+  /// Swaps the contents of one cache with another cache.
+  ///
+  /// \param first The first cache to swap.
+  /// \param second The second cache to swap.
+  friend void swap(LfuCache& first, LfuCache& second) noexcept {
+    first.swap(second);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // CACHE INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// Tests if the given key is contained in the cache.
+  ///
+  /// If the key is found, its access count is incremented.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key to check for.
+  /// \returns True if the key is contained in the cache, else false.
+  bool contains(const Key& key) const {
+    if (key == _last_accessed) {
+      _touch(_last_accessed.information());
+      _register_hit(key, _last_accessed.value());
+      return true;
+    }
+
+    return _find(key) != _map.end();
+  }
+
+  /// Looks up the value for the given key.
+  ///
+  /// If the key is found, its access count is incremented.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key whose value to look for.
+  /// \throws LRU::Error::KeyNotFound if the key is not in the cache.
+  /// \returns The value stored in the cache for the given key.
+  const Value& lookup(const Key& key) const {
+    if (key == _last_accessed) {
+      _touch(_last_accessed.information());
+      _register_hit(key, _last_accessed.value());
+      return _last_accessed.value();
+    }
+
+    auto iterator = _find(key);
+    if (iterator == _map.end()) {
+      throw LRU::Error::KeyNotFound();
+    }
+
+    return iterator->second.value;
+  }
+
+  /// \copydoc lookup(const Key&) const
+  Value& lookup(const Key& key) {
+    const auto& self = *this;
+    return const_cast<Value&>(self.lookup(key));
+  }
+
+  /// \copydoc lookup(const Key&)
+  Value& operator[](const Key& key) {
+    return lookup(key);
+  }
+
+  /// \copydoc lookup(const Key&) const
+  const Value& operator[](const Key& key) const {
+    return lookup(key);
+  }
+
+  /// Inserts the given `(key, value)` pair into the cache.
+  ///
+  /// If the key is already present, its value is updated and its access count
+  /// is incremented. Otherwise, the key starts out with a count of one, after
+  /// evicting the least frequently used key if the cache is full.
+  ///
+  /// \complexity O(1) expected and amortized.
+  /// \param key The key to insert.
+  /// \param value The value to insert with the key.
+  /// \returns True if the key was newly inserted, false if it was only updated.
+  bool insert(const Key& key, const Value& value) {
+    return emplace(key, value);
+  }
+
+  /// Inserts a range of `(key, value)` pairs.
+  ///
+  /// \param begin The start iterator of the range to insert.
+  /// \param end The end iterator of the range to insert.
+  /// \returns The number of newly inserted keys.
+  template <typename Iterator,
+            typename = Internal::enable_if_iterator_over_pair<Iterator>>
+  size_t insert(Iterator begin, Iterator end) {
+    size_t newly_inserted = 0;
+    for (; begin != end; ++begin) {
+      newly_inserted += insert(begin->first, begin->second);
+    }
+
+    return newly_inserted;
+  }
+
+  /// Inserts a list of `(key, value)` pairs.
+  ///
+  /// \param list The list of pairs to insert.
+  /// \returns The number of newly inserted keys.
+  size_t insert(InitializerList list) {
+    return insert(list.begin(), list.end());
+  }
+
+  /// Emplaces a `(key, value)` pair.
+  ///
+  /// \param key_argument The argument to construct a key object with.
+  /// \param value_argument The argument to construct a value object with.
+  /// \returns True if the key was newly inserted, false if it was only updated.
+  template <typename K, typename V>
+  bool emplace(K&& key_argument, V&& value_argument) {
+    if (_capacity == 0) return false;
+
+    Key key(std::forward<K>(key_argument));
+    auto iterator = _map.find(key);
+
+    if (iterator != _map.end()) {
+      iterator->second.value = Value(std::forward<V>(value_argument));
+      _touch(iterator->second);
+      _register_overwrite();
+      _last_accessed = iterator;
+      return false;
+    }
+
+    // Evicting before inserting means the new key is never the victim.
+    if (size() >= _capacity) {
+      _evict();
+    }
+
+    auto result = _map.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<V>(value_argument)));
+    assert(result.second);
+
+    auto& information = result.first->second;
+    information.handle = _buckets.insert(std::cref(result.first->first));
+    _last_accessed = result.first;
+    _count_access();
+    _register_insertion();
+
+    return true;
+  }
+
+  /// Erases the given key from the cache, if it is present.
+  ///
+  /// \param key The key to erase.
+  /// \returns True if the key was erased, else false.
+  bool erase(const Key& key) {
+    auto iterator = _map.find(key);
+    if (iterator == _map.end()) return false;
+
+    _register_erasure();
+    _erase(iterator);
+    return true;
+  }
+
+  /// Clears the cache entirely.
+  void clear() {
+    _map.clear();
+    _buckets.clear();
+    _last_accessed.invalidate();
+    _accesses = 0;
+  }
+
+  /// Requests shrinkage of the cache to the given size.
+  ///
+  /// If the size is greater than the current size, this is a no-op. Otherwise,
+  /// the least frequently used keys are evicted until the size of the cache is
+  /// reduced to the given size.
+  ///
+  /// \param new_size The size to (maybe) shrink to.
+  void shrink(size_t new_size) {
+    while (size() > new_size) {
+      _evict();
+    }
+  }
+
+  /// Looks up the access count of a key, without counting as an access.
+  ///
+  /// \param key The key whose count to look up.
+  /// \throws LRU::Error::KeyNotFound if the key is not in the cache.
+  /// \returns The (possibly decayed) access count of the key.
+  size_t frequency(const Key& key) const {
+    auto iterator = _map.find(key);
+    if (iterator == _map.end()) {
+      throw LRU::Error::KeyNotFound();
+    }
+
+    return Buckets::count(iterator->second.handle);
+  }
+
+  /// Halves the access counts of all keys.
+  ///
+  /// \complexity O(N) for N keys.
+  void decay() {
+    _buckets.decay();
+    _accesses = 0;
+  }
+
+  /// Sets the number of accesses (hits and insertions) after which all access
+  /// counts are halved automatically.
+  ///
+  /// A period of zero (the default) disables decay. To keep the decay O(1)
+  /// amortized, the period should be at least in the order of the capacity.
+  ///
+  /// \param period The new decay period.
+  void decay_period(size_t period) noexcept {
+    _decay_period = period;
+  }
+
+  /// \returns The number of accesses after which all counts are halved.
+  size_t decay_period() const noexcept {
+    return _decay_period;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // SIZE AND CAPACITY INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// \returns The number of keys present in the cache.
+  size_t size() const noexcept {
+    return _map.size();
+  }
+
+  /// Sets the capacity of the cache to the given value.
+  ///
+  /// If the given capacity is less than the current size of the cache, keys
+  /// are evicted until the size equals the capacity.
+  ///
+  /// \param new_capacity The capacity to shrink or grow to.
+  void capacity(size_t new_capacity) {
+    shrink(new_capacity);
+    _capacity = new_capacity;
+  }
+
+  /// \returns The current capacity of the cache.
+  size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+  /// \returns The number of slots left in the cache.
+  size_t space_left() const noexcept {
+    return _capacity - size();
+  }
+
+  /// \returns True if the cache contains no elements, else false.
+  bool is_empty() const noexcept {
+    return size() == 0;
+  }
+
+  /// \returns True if the cache's size equals its capacity, else false.
+  bool is_full() const noexcept {
+    return size() == _capacity;
+  }
+
+  /// \returns The function used to hash keys.
+  HashFunction hash_function() const {
+    return _map.hash_function();
+  }
+
+  /// \returns The function used to compare keys.
+  KeyEqual key_equal() const {
+    return _map.key_eq();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // STATISTICS INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// \copydoc BaseCache::monitor(const StatisticsPointer&)
+  void monitor(const StatisticsPointer& statistics) {
+    _stats = statistics;
+  }
+
+  /// \copydoc BaseCache::monitor(StatisticsPointer&&)
+  void monitor(StatisticsPointer&& statistics) {
+    _stats = std::move(statistics);
+  }
+
+  /// \copydoc BaseCache::monitor(Args&&...)
+  template <typename... Args,
+            typename = std::enable_if_t<
+                Internal::none_of_type<StatisticsPointer, Args...>>>
+  void monitor(Args&&... args) {
+    _stats = std::make_shared<Statistics<Key>>(std::forward<Args>(args)...);
+  }
+
+  /// Stops any monitoring being performed with a statistics object.
+  void stop_monitoring() {
+    _stats.reset();
+  }
+
+  /// \returns True if the cache is currently monitoring statistics, else
+  /// false.
+  bool is_monitoring() const noexcept {
+    return _stats.has_stats();
+  }
+
+  /// \returns The statistics object currently in use by the cache.
+  /// \throws LRU::Error::NotMonitoring if the cache is currently not
+  /// monitoring.
+  Statistics<Key>& stats() {
+    if (!is_monitoring()) {
+      throw LRU::Error::NotMonitoring();
+    }
+    return _stats.get();
+  }
+
+  /// \copydoc stats()
+  const Statistics<Key>& stats() const {
+    if (!is_monitoring()) {
+      throw LRU::Error::NotMonitoring();
+    }
+    return _stats.get();
+  }
+
+  /// \returns A `shared_ptr` to the statistics currently in use by the cache.
+  StatisticsPointer& shared_stats() {
+    return _stats.shared();
+  }
+
+  /// \returns A `shared_ptr` to the statistics currently in use by the cache.
+  const StatisticsPointer& shared_stats() const {
+    return _stats.shared();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // CALLBACK INTERFACE
+  /////////////////////////////////////////////////////////////////////////////
+
+  /// Registers a new hit callback.
+  ///
+  /// \param hit_callback The hit callback function to register with the cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<HitCallback, Callback>>
+  void hit_callback(Callback&& hit_callback) {
+    _callback_manager.hit_callback(std::forward<Callback>(hit_callback));
+  }
+
+  /// Registers a new miss callback.
+  ///
+  /// \param miss_callback The miss callback function to register with the
+  ///                       cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<MissCallback, Callback>>
+  void miss_callback(Callback&& miss_callback) {
+    _callback_manager.miss_callback(std::forward<Callback>(miss_callback));
+  }
+
+  /// Registers a new access callback.
+  ///
+  /// \param access_callback The access callback function to register with the
+  ///                        cache.
+  template <typename Callback,
+            typename = Internal::enable_if_same<AccessCallback, Callback>>
+  void access_callback(Callback&& access_callback) {
+    _callback_manager.access_callback(std::forward<Callback>(access_callback));
+  }
+
+  /// Removes the access callbacks satisfying a predicate.
+  ///
+  /// \param predicate A function taking an access callback and returning
+  ///                  true if it should be removed.
+  template <typename Predicate>
+  void remove_access_callbacks(Predicate predicate) {
+    _callback_manager.remove_access_callbacks(predicate);
+  }
+
+  /// Clears all callbacks.
+  void clear_all_callbacks() {
+    _callback_manager.clear();
+  }
+
+  /// \returns All hit callbacks.
+  const HitCallbackContainer& hit_callbacks() const noexcept {
+    return _callback_manager.hit_callbacks();
+  }
+
+  /// \returns All miss callbacks.
+  const MissCallbackContainer& miss_callbacks() const noexcept {
+    return _callback_manager.miss_callbacks();
+  }
+
+  /// \returns All access callbacks.
+  const AccessCallbackContainer& access_callbacks() const noexcept {
+    return _callback_manager.access_callbacks();
+  }
+
+ private:
+  /// Looks up a key, increments its access count and registers a hit or miss.
+  ///
+  /// \param key The key to look for.
+  /// \returns An iterator to the key, or the end iterator.
+  MapConstIterator _find(const Key& key) const {
+    auto iterator = _map.find(key);
+    if (iterator != _map.end()) {
+      _touch(iterator->second);
+      _register_hit(key, iterator->second.value);
+      _last_accessed = iterator;
+    } else {
+      _register_miss(key);
+    }
+
+    return iterator;
+  }
+
+  /// Increments the access count of a key.
+  ///
+  /// \param information The information of the key.
+  void _touch(const Information& information) const {
+    _buckets.increment(information.handle);
+    _count_access();
+  }
+
+  /// Counts an access towards the decay period, decaying if it is over.
+  void _count_access() const {
+    if (_decay_period == 0) return;
+    if (++_accesses >= _decay_period) {
+      _buckets.decay();
+      _accesses = 0;
+    }
+  }
+
+  /// Evicts the least frequently used key.
+  void _evict() {
+    _register_eviction();
+    _erase(_map.find(_buckets.min()->item));
+  }
+
+  /// Erases the element pointed to by the iterator.
+  ///
+  /// \param iterator The iterator pointing to the key to erase.
+  void _erase(MapConstIterator iterator) {
+    if (_last_accessed == iterator) {
+      _last_accessed.invalidate();
+    }
+
+    _buckets.erase(iterator->second.handle);
+    _map.erase(iterator);
+  }
+
+  /// Re-assigns the references and handles after a copy.
+  ///
+  /// After a copy, the buckets refer to the keys of the other cache's map, and
+  /// the handles of the map point into the other cache's buckets.
+  void _reassign_handles() {
+    for (auto& bucket : _buckets) {
+      for (auto node = bucket.nodes.begin(); node != bucket.nodes.end();
+           ++node) {
+        auto iterator = _map.find(node->item.get());
+        node->item = std::cref(iterator->first);
+        iterator->second.handle = node;
+      }
+    }
+  }
+
+  /// The map from keys to information objects.
+  Map _map;
+
+  /// The keys, bucketed by their access counts.
+  mutable Buckets _buckets;
+
+  /// The last-accessed cache object.
+  mutable LastAccessed _last_accessed;
+
+  /// The current capacity of the cache.
+  size_t _capacity;
+
+  /// The number of accesses after which all counts are halved (zero to
+  /// disable decay).
+  size_t _decay_period;
+
+  /// The number of accesses since the last decay.
+  mutable size_t _accesses;
+};
+
+namespace Lowercase {
+template <typename... Ts>
+using lfu_cache = LfuCache<Ts...>;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_LFU_CACHE_HPP
@@ -22,12 +22,30 @@
 #ifndef LRU_HPP
 #define LRU_HPP
 
+#include <lru/access-hint.hpp>
+#include <lru/approximate-cache.hpp>
 #include <lru/cache-tags.hpp>
 #include <lru/cache.hpp>
+#include <lru/capacity-controller.hpp>
 #include <lru/error.hpp>
+#include <lru/hash.hpp>
+#include <lru/heavy-hitters.hpp>
+#include <lru/hooks.hpp>
 #include <lru/iterator-tags.hpp>
+#include <lru/latency-histogram.hpp>
+#include <lru/latency-statistics.hpp>
+#include <lru/lfu-cache.hpp>
+#include <lru/memoize.hpp>
+#include <lru/memory-arbiter.hpp>
+#include <lru/memory-pressure-monitor.hpp>
+#include <lru/metrics-exporter.hpp>
+#include <lru/partitioned-cache.hpp>
+#include <lru/priority-cache.hpp>
+#include <lru/recent-activity.hpp>
 #include <lru/statistics.hpp>
+#include <lru/stats-page.hpp>
 #include <lru/timed-cache.hpp>
+#include <lru/tracking.hpp>
 #include <lru/wrap.hpp>
 
 #endif  // LRU_HPP
@@ -0,0 +1,314 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_MEMOIZE_HPP
+#define LRU_MEMOIZE_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <lru/cache.hpp>
+#include <lru/internal/optional.hpp>
+#include <lru/internal/utility.hpp>
+
+namespace LRU {
+
+/// A fixed-size table of values indexed by small non-negative integers.
+///
+/// This is the dense backend of `LRU::memoize_dense`. Lookups are a bounds
+/// check and an array access, with no hashing and no eviction, which makes it
+/// the fastest choice for dynamic programming over a known range of integers.
+///
+/// \tparam Value The type of the values.
+template <typename Value>
+class DenseTable {
+ public:
+  /// Constructor.
+  ///
+  /// \param capacity The number of indices, `[0, capacity)`, the table holds.
+  explicit DenseTable(std::size_t capacity) : _values(capacity), _size(0) {
+  }
+
+  /// \param index The index to look up.
+  /// \returns A pointer to the value at the index, or `nullptr` if there is no
+  /// value for the index (or the index is out of range).
+  template <typename Index>
+  const Value* find(Index index) const noexcept {
+    if (!contains(index)) return nullptr;
+    return &*_values[static_cast<std::size_t>(index)];
+  }
+
+  /// Stores a value for an index. Indices out of range are ignored.
+  ///
+  /// \param index The index to store the value at.
+  /// \param value The value to store.
+  template <typename Index, typename V>
+  void insert(Index index, V&& value) {
+    if (!_in_range(index)) return;
+    auto& slot = _values[static_cast<std::size_t>(index)];
+    if (!slot) _size += 1;
+    slot.emplace(std::forward<V>(value));
+  }
+
+  /// \param index The index to check.
+  /// \returns True if there is a value for the index, else false.
+  template <typename Index>
+  bool contains(Index index) const noexcept {
+    return _in_range(index) &&
+           _values[static_cast<std::size_t>(index)].has_value();
+  }
+
+  /// Removes all values.
+  void clear() {
+    for (auto& value : _values) value.reset();
+    _size = 0;
+  }
+
+  /// \returns The number of values stored.
+  std::size_t size() const noexcept {
+    return _size;
+  }
+
+  /// \returns The number of indices the table holds.
+  std::size_t capacity() const noexcept {
+    return _values.size();
+  }
+
+  /// \returns True if no values are stored, else false.
+  bool is_empty() const noexcept {
+    return _size == 0;
+  }
+
+ private:
+  /// \returns True if the index is within `[0, capacity())`.
+  template <typename Index>
+  bool _in_range(Index index) const noexcept {
+    static_assert(std::is_integral<Index>::value,
+                  "Dense tables must be indexed by integers");
+    return !(index < 0) && static_cast<std::size_t>(index) < _values.size();
+  }
+
+  /// The values, indexed directly.
+  std::vector<Internal::Optional<Value>> _values;
+
+  /// The number of values stored.
+  std::size_t _size;
+};
+
+namespace Internal {
+
+/// Adapts a cache to the interface `RecursiveMemoizedFunction` expects.
+///
+/// \tparam CacheType The type of the cache.
+/// \tparam Value The value type of the cache.
+template <typename CacheType, typename Value>
+struct CacheMemoTable {
+  template <typename... Args>
+  explicit CacheMemoTable(Args&&... args) : table(std::forward<Args>(args)...) {
+  }
+
+  template <typename Key>
+  const Value* find(const Key& key) {
+    auto iterator = table.find(key);
+    if (iterator == table.end()) return nullptr;
+    return &iterator->second;
+  }
+
+  template <typename Key, typename V>
+  void insert(Key&& key, V&& value) {
+    table.emplace(std::forward<Key>(key), std::forward<V>(value));
+  }
+
+  CacheType table;
+};
+
+/// Adapts a `DenseTable` to the interface `RecursiveMemoizedFunction`
+/// expects, using the single argument as the index.
+///
+/// \tparam Value The type of the values.
+template <typename Value>
+struct DenseMemoTable {
+  explicit DenseMemoTable(std::size_t capacity) : table(capacity) {
+  }
+
+  template <typename Index>
+  const Value* find(const std::tuple<Index>& key) const noexcept {
+    return table.find(std::get<0>(key));
+  }
+
+  template <typename Index, typename V>
+  void insert(const std::tuple<Index>& key, V&& value) {
+    table.insert(std::get<0>(key), std::forward<V>(value));
+  }
+
+  DenseTable<Value> table;
+};
+
+}  // namespace Internal
+
+/// A recursive function whose recursive calls go through a memoization table,
+/// as returned by `LRU::memoize` and `LRU::memoize_dense`.
+///
+/// Unlike `LRU::wrap`, which can only cache calls from the outside, the
+/// wrapped function receives this object as its first argument and makes its
+/// recursive calls through it, so that every subproblem is cached:
+///
+/// ```cpp
+/// auto fibonacci = LRU::memoize<long(int)>([](auto& self, int n) -> long {
+///   return n < 2 ? n : self(n - 1) + self(n - 2);
+/// });
+/// ```
+///
+/// \tparam Signature The signature of the function, excluding the self
+///                   argument (e.g. `long(int)`).
+/// \tparam Function The type of the function.
+/// \tparam Table The type of the memoization table adapter.
+template <typename Signature, typename Function, typename Table>
+class RecursiveMemoizedFunction;
+
+template <typename R, typename... Args, typename Function, typename Table>
+class RecursiveMemoizedFunction<R(Args...), Function, Table> {
+ public:
+  using Key = std::tuple<std::decay_t<Args>...>;
+  using ReturnType = std::decay_t<R>;
+
+  static_assert(!std::is_void<ReturnType>::value,
+                "Return type of memoized function must not be void");
+
+  /// Constructor.
+  ///
+  /// \param function The function to memoize, taking this object (by
+  ///                 reference) followed by the arguments.
+  /// \param args Any arguments to forward to the constructor of the table.
+  template <typename... TableArgs>
+  explicit RecursiveMemoizedFunction(Function function, TableArgs&&... args)
+  : _function(std::move(function)), _table(std::forward<TableArgs>(args)...) {
+  }
+
+  /// Calls the function, or returns the memoized result of an earlier call
+  /// with the same arguments.
+  ///
+  /// \param args The arguments to call the function with.
+  /// \returns The result of the function.
+  ReturnType operator()(Args... args) {
+    Key key(args...);
+    if (auto value = _table.find(key)) {
+      return *value;
+    }
+
+    ReturnType value = _function(*this, std::forward<Args>(args)...);
+    _table.insert(std::move(key), value);
+
+    return value;
+  }
+
+  /// \returns The memoization table (a cache or `LRU::DenseTable`).
+  auto& cache() noexcept {
+    return _table.table;
+  }
+
+  /// \returns The memoization table (a cache or `LRU::DenseTable`).
+  const auto& cache() const noexcept {
+    return _table.table;
+  }
+
+  /// Forgets all memoized results.
+  void clear() {
+    _table.table.clear();
+  }
+
+ private:
+  /// The memoized function.
+  Function _function;
+
+  /// The memoization table.
+  Table _table;
+};
+
+/// Memoizes a recursive function with an LRU cache.
+///
+/// The function receives the memoized function as its first argument and must
+/// make all recursive calls through it.
+///
+/// \tparam Signature The signature of the function, excluding the self
+///                   argument (e.g. `long(int)`).
+/// \tparam CacheType The cache template class to use.
+/// \param function The function to memoize.
+/// \param args Any arguments to forward to the cache (e.g. a capacity).
+/// \returns A `RecursiveMemoizedFunction`.
+template <typename Signature,
+          template <typename...> class CacheType = Cache,
+          typename Function,
+          typename... Args>
+auto memoize(Function function, Args&&... args) {
+  using Traits = Internal::FunctionTraits<Signature>;
+  using Key = typename Traits::Arguments;
+  using ReturnType = std::decay_t<typename Traits::ReturnType>;
+  using Table =
+      Internal::CacheMemoTable<CacheType<Key, ReturnType>, ReturnType>;
+
+  return RecursiveMemoizedFunction<Signature, Function, Table>(
+      std::move(function), std::forward<Args>(args)...);
+}
+
+/// Memoizes a recursive function of a single integer argument with a
+/// `LRU::DenseTable`.
+///
+/// Results for arguments in `[0, capacity)` are stored in a plain array,
+/// without hashing or eviction. Results for other arguments are computed but
+/// not memoized.
+///
+/// \tparam Signature The signature of the function, excluding the self
+///                   argument (e.g. `long(int)`).
+/// \param function The function to memoize.
+/// \param capacity The number of arguments, `[0, capacity)`, to memoize.
+/// \returns A `RecursiveMemoizedFunction`.
+template <typename Signature, typename Function>
+auto memoize_dense(Function function, std::size_t capacity) {
+  using Traits = Internal::FunctionTraits<Signature>;
+  using ReturnType = std::decay_t<typename Traits::ReturnType>;
+  using Table = Internal::DenseMemoTable<ReturnType>;
+
+  static_assert(std::tuple_size<typename Traits::Arguments>::value == 1,
+                "Dense memoization requires a single argument");
+  static_assert(std::is_integral<std::tuple_element_t<
+                    0,
+                    typename Traits::Arguments>>::value,
+                "Dense memoization requires an integer argument");
+
+  return RecursiveMemoizedFunction<Signature, Function, Table>(
+      std::move(function), capacity);
+}
+
+namespace Lowercase {
+template <typename Value>
+using dense_table = DenseTable<Value>;
+
+template <typename... Ts>
+using recursive_memoized_function = RecursiveMemoizedFunction<Ts...>;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_MEMOIZE_HPP
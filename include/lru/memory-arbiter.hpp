@@ -0,0 +1,240 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_MEMORY_ARBITER_HPP
+#define LRU_MEMORY_ARBITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <utility>
+
+namespace LRU {
+
+/// Enforces a single memory budget across several caches.
+///
+/// Instead of tuning the capacity of every cache separately, caches join an
+/// arbiter with a weight per entry (e.g. the approximate size of an entry in
+/// bytes). Whenever a cache is about to grow and the combined weight of all
+/// caches would exceed the budget, the arbiter evicts the least recently used
+/// key among *all* caches, i.e. from the cache whose LRU tail was accessed
+/// longest ago. Each cache's own capacity still acts as an upper bound.
+///
+/// Caches join an arbiter with `arbitrate()` and leave it again with
+/// `stop_arbitration()` or when they are destroyed (if the arbiter is
+/// destroyed first, its caches are detached). Copies and moved-to caches are
+/// not arbitrated. Only caches tracking accesses (see `LRU::TrackAccesses`)
+/// can join. Caches report every change of their size, so the arbiter keeps a
+/// running total of the combined weight and only needs to look at all caches
+/// when it must evict. The arbiter is not thread-safe: all of its caches must
+/// be used from the same thread or be synchronized externally.
+class MemoryArbiter {
+ public:
+  using size_t = std::size_t;
+  using Stamp = std::uint64_t;
+
+  /// The arbiter's view of a cache.
+  struct Member {
+    /// The weight of a single entry of the cache.
+    size_t weight;
+
+    /// The number of entries in the cache, as last reported.
+    size_t entries;
+
+    /// Stores the stamp of the cache's LRU key and returns true, or returns
+    /// false if the cache is empty.
+    std::function<bool(Stamp&)> tail;
+
+    /// Evicts the cache's LRU key.
+    std::function<void()> evict;
+
+    /// Detaches the cache from the arbiter.
+    std::function<void()> detach;
+  };
+
+  /// Constructor.
+  ///
+  /// \param budget The budget for the combined weight of all caches.
+  explicit MemoryArbiter(size_t budget)
+  : _budget(budget), _weight(0), _clock(0), _next_id(0) {
+  }
+
+  MemoryArbiter(const MemoryArbiter&) = delete;
+  MemoryArbiter& operator=(const MemoryArbiter&) = delete;
+
+  /// Destructor, detaching all caches.
+  ~MemoryArbiter() {
+    for (auto& member : _members) {
+      member.second.detach();
+    }
+  }
+
+  /// Adds a cache to the arbiter (caches do this in `arbitrate()`).
+  ///
+  /// \param member The arbiter's view of the cache.
+  /// \returns The id of the cache with the arbiter.
+  size_t join(Member member) {
+    const auto id = _next_id++;
+    _weight += member.entries * member.weight;
+    _members.emplace(id, std::move(member));
+    reserve(0);
+    return id;
+  }
+
+  /// Removes a cache from the arbiter.
+  ///
+  /// \param id The id of the cache with the arbiter.
+  void leave(size_t id) {
+    auto iterator = _members.find(id);
+    if (iterator == _members.end()) return;
+    _weight -= iterator->second.entries * iterator->second.weight;
+    _members.erase(iterator);
+  }
+
+  /// Updates the number of entries of a cache, evicting keys if the cache grew
+  /// beyond the budget (caches call this whenever their size changes).
+  ///
+  /// \param id The id of the cache with the arbiter.
+  /// \param entries The new number of entries in the cache.
+  void resized(size_t id, size_t entries) {
+    auto& member = _members.at(id);
+    _weight -= member.entries * member.weight;
+    _weight += entries * member.weight;
+    member.entries = entries;
+    reserve(0);
+  }
+
+  /// Evicts keys until the given weight fits into the budget.
+  ///
+  /// \complexity O(1) if the weight fits, else O(M) per eviction for M caches.
+  /// \param weight The weight about to be added.
+  void reserve(size_t weight) {
+    while (_weight + weight > _budget) {
+      auto victim = _oldest_tail();
+      if (victim == _members.end()) return;
+
+      // Evicting reports the new size of the victim, lowering the weight.
+      const auto previous_weight = _weight;
+      victim->second.evict();
+      if (_weight >= previous_weight) return;
+    }
+  }
+
+  /// \returns A new stamp, later than all previous stamps.
+  Stamp tick() noexcept {
+    return ++_clock;
+  }
+
+  /// Sets the budget, evicting keys if necessary.
+  ///
+  /// \param new_budget The new budget.
+  void budget(size_t new_budget) {
+    _budget = new_budget;
+    reserve(0);
+  }
+
+  /// \returns The budget for the combined weight of all caches.
+  size_t budget() const noexcept {
+    return _budget;
+  }
+
+  /// \returns The combined weight of all caches.
+  size_t weight() const noexcept {
+    return _weight;
+  }
+
+  /// \returns The number of caches the arbiter manages.
+  size_t members() const noexcept {
+    return _members.size();
+  }
+
+ private:
+  using MemberMap = std::map<size_t, Member>;
+
+  /// \returns The cache whose LRU key was accessed longest ago, or the end
+  /// iterator if all caches are empty.
+  MemberMap::iterator _oldest_tail() {
+    auto oldest = _members.end();
+    Stamp oldest_stamp = 0;
+
+    for (auto iterator = _members.begin(); iterator != _members.end();
+         ++iterator) {
+      Stamp stamp;
+      if (!iterator->second.tail(stamp)) continue;
+      if (oldest == _members.end() || stamp < oldest_stamp) {
+        oldest = iterator;
+        oldest_stamp = stamp;
+      }
+    }
+
+    return oldest;
+  }
+
+  /// The caches, by their ids.
+  MemberMap _members;
+
+  /// The budget for the combined weight of all caches.
+  size_t _budget;
+
+  /// The combined weight of all caches.
+  size_t _weight;
+
+  /// The logical clock stamping accesses.
+  Stamp _clock;
+
+  /// The id of the next cache to join.
+  size_t _next_id;
+};
+
+namespace Internal {
+
+/// The link of a cache to the arbiter it joined.
+///
+/// The link belongs to the cache object itself, so copies and moves of a
+/// cache start out unlinked.
+struct ArbiterLink {
+  ArbiterLink() noexcept = default;
+  ArbiterLink(const ArbiterLink&) noexcept {
+  }
+  ArbiterLink& operator=(const ArbiterLink&) noexcept {
+    return *this;
+  }
+
+  /// The arbiter, or null if the cache is not arbitrated.
+  MemoryArbiter* arbiter = nullptr;
+
+  /// The id of the cache with the arbiter.
+  std::size_t id = 0;
+
+  /// The weight of a single entry of the cache.
+  std::size_t weight = 0;
+};
+
+}  // namespace Internal
+
+namespace Lowercase {
+using memory_arbiter = MemoryArbiter;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_MEMORY_ARBITER_HPP
@@ -0,0 +1,351 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_MEMORY_PRESSURE_MONITOR_HPP
+#define LRU_MEMORY_PRESSURE_MONITOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace LRU {
+
+/// A snapshot of the memory pressure signals of the system.
+struct MemoryReading {
+  /// Whether the cgroup's memory usage and limit could be read.
+  bool has_usage = false;
+
+  /// The memory usage of the cgroup as a fraction of its limit.
+  double usage = 0;
+
+  /// Whether the pressure stall information (PSI) could be read.
+  bool has_stall = false;
+
+  /// The share of time (in percent, averaged over 10 seconds) in which some
+  /// tasks were stalled waiting for memory.
+  double stall = 0;
+};
+
+/// The level of memory pressure determined by a `MemoryPressureMonitor`.
+enum class MemoryPressure {
+  /// Pressure has subsided, caches may grow back.
+  Low,
+
+  /// Pressure is moderate (or unknown), caches are left alone.
+  Normal,
+
+  /// Pressure is high, caches are shrunk.
+  High
+};
+
+/// Shrinks caches when the system runs low on memory.
+///
+/// The monitor reads the Linux memory pressure signals: the usage of the
+/// cgroup (v2) the process lives in, relative to its limit (`memory.current`
+/// and `memory.max`, found via `/proc/self/cgroup`), and the pressure stall
+/// information of `/proc/pressure/memory`. Every call to `poll()` compares
+/// these signals to configurable thresholds and shrinks all managed caches by
+/// one step if pressure is high, or grows them back by one step (up to their
+/// original capacity) once pressure has subsided. Between the two thresholds,
+/// caches are left alone, so capacities do not oscillate.
+///
+/// The monitor does not start a thread; call `poll()` periodically (e.g. once
+/// a second). Managed caches must outlive the monitor.
+class MemoryPressureMonitor {
+ public:
+  using size_t = std::size_t;
+
+  /// Constructor.
+  ///
+  /// Watches the cgroup of the process.
+  MemoryPressureMonitor() : MemoryPressureMonitor(cgroup_of_process()) {
+  }
+
+  /// Constructor.
+  ///
+  /// \param cgroup The directory of the cgroup to watch.
+  /// \param psi The file with the pressure stall information for memory.
+  explicit MemoryPressureMonitor(std::string cgroup,
+                                 std::string psi = "/proc/pressure/memory")
+  : _cgroup(std::move(cgroup))
+  , _psi(std::move(psi))
+  , _high_usage(0.9)
+  , _low_usage(0.75)
+  , _high_stall(10)
+  , _low_stall(1)
+  , _step(0.1)
+  , _minimum(0.1) {
+  }
+
+  /// Puts a cache under the control of the monitor.
+  ///
+  /// The cache's current capacity is remembered as the capacity to restore
+  /// once pressure subsides.
+  ///
+  /// \param cache The cache to manage.
+  template <typename Cache>
+  void manage(Cache& cache) {
+    Managed managed;
+    managed.original = cache.capacity();
+    managed.get_capacity = [&cache] { return cache.capacity(); };
+    managed.set_capacity = [&cache](size_t capacity) {
+      cache.capacity(capacity);
+    };
+
+    _caches.push_back(std::move(managed));
+  }
+
+  /// Reads the current signals and shrinks or grows the managed caches.
+  ///
+  /// \returns The pressure determined from the signals.
+  MemoryPressure poll() {
+    return poll(read());
+  }
+
+  /// Shrinks or grows the managed caches according to the given signals.
+  ///
+  /// \param reading The memory pressure signals.
+  /// \returns The pressure determined from the signals.
+  MemoryPressure poll(const MemoryReading& reading) {
+    const auto pressure = assess(reading);
+
+    if (pressure == MemoryPressure::Normal) return pressure;
+
+    for (auto& managed : _caches) {
+      const auto capacity = managed.get_capacity();
+      const auto step = std::max<size_t>(_fraction(managed.original, _step), 1);
+
+      if (pressure == MemoryPressure::High) {
+        const auto floor = _fraction(managed.original, _minimum);
+        if (capacity > floor) {
+          managed.set_capacity(capacity - std::min(capacity - floor, step));
+        }
+      } else if (capacity < managed.original) {
+        managed.set_capacity(std::min(managed.original, capacity + step));
+      }
+    }
+
+    return pressure;
+  }
+
+  /// Determines the pressure level from the given signals.
+  ///
+  /// \param reading The memory pressure signals.
+  /// \returns The pressure level.
+  MemoryPressure assess(const MemoryReading& reading) const noexcept {
+    if (!reading.has_usage && !reading.has_stall) {
+      return MemoryPressure::Normal;
+    }
+
+    if ((reading.has_usage && reading.usage >= _high_usage) ||
+        (reading.has_stall && reading.stall >= _high_stall)) {
+      return MemoryPressure::High;
+    }
+
+    if ((!reading.has_usage || reading.usage < _low_usage) &&
+        (!reading.has_stall || reading.stall < _low_stall)) {
+      return MemoryPressure::Low;
+    }
+
+    return MemoryPressure::Normal;
+  }
+
+  /// Reads the current memory pressure signals.
+  ///
+  /// Signals that cannot be read (e.g. because there is no memory limit or
+  /// the kernel lacks PSI support) are marked as missing.
+  ///
+  /// \returns The memory pressure signals.
+  MemoryReading read() const {
+    MemoryReading reading;
+
+    double current;
+    double maximum;
+    if (_read_number(_cgroup + "/memory.current", current) &&
+        _read_number(_cgroup + "/memory.max", maximum) && maximum > 0) {
+      reading.has_usage = true;
+      reading.usage = current / maximum;
+    }
+
+    std::ifstream psi(_psi);
+    std::string kind;
+    std::string average;
+    // The first line reads "some avg10=0.00 avg60=0.00 avg300=0.00 total=0".
+    if (psi >> kind >> average && kind == "some" &&
+        average.compare(0, 6, "avg10=") == 0) {
+      const char* begin = average.c_str() + 6;
+      char* end;
+      const auto stall = std::strtod(begin, &end);
+      if (end != begin && *end == '\0' && std::isfinite(stall)) {
+        reading.has_stall = true;
+        reading.stall = stall;
+      }
+    }
+
+    return reading;
+  }
+
+  /// Determines the cgroup (v2) directory of the current process.
+  ///
+  /// Inside a container, the process usually lives in its own cgroup at the
+  /// root of the hierarchy, but on a host (e.g. under systemd) it lives in a
+  /// nested cgroup, and the limits of the root cgroup are not the ones that
+  /// apply to it. The cgroup is listed as "0::/path" in `/proc/self/cgroup`.
+  ///
+  /// \param membership The file listing the cgroups of the process.
+  /// \param root The mount point of the cgroup (v2) hierarchy.
+  /// \returns The directory of the cgroup, or the root if it cannot be
+  /// determined.
+  static std::string
+  cgroup_of_process(const std::string& membership = "/proc/self/cgroup",
+                    const std::string& root = "/sys/fs/cgroup") {
+    std::ifstream file(membership);
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.compare(0, 3, "0::") != 0) continue;
+      auto path = line.substr(3);
+      if (path.empty() || path == "/") return root;
+      if (path.front() != '/') path.insert(0, 1, '/');
+      return root + path;
+    }
+
+    return root;
+  }
+
+  /// Restores the original capacities of all managed caches.
+  void restore() {
+    for (auto& managed : _caches) {
+      managed.set_capacity(managed.original);
+    }
+  }
+
+  /// Sets the usage thresholds (as fractions of the cgroup's limit).
+  ///
+  /// \param high The usage at or above which caches are shrunk.
+  /// \param low The usage below which caches grow back.
+  void usage_thresholds(double high, double low) noexcept {
+    _high_usage = high;
+    _low_usage = low;
+  }
+
+  /// Sets the memory stall thresholds (in percent of time over 10 seconds).
+  ///
+  /// \param high The stall time at or above which caches are shrunk.
+  /// \param low The stall time below which caches grow back.
+  void stall_thresholds(double high, double low) noexcept {
+    _high_stall = high;
+    _low_stall = low;
+  }
+
+  /// Sets the fraction of the original capacity by which caches are shrunk or
+  /// grown per poll.
+  ///
+  /// \param fraction The fraction of the original capacity.
+  void step(double fraction) noexcept {
+    _step = fraction;
+  }
+
+  /// Sets the fraction of the original capacity below which caches are never
+  /// shrunk.
+  ///
+  /// \param fraction The fraction of the original capacity.
+  void minimum(double fraction) noexcept {
+    _minimum = fraction;
+  }
+
+  /// \returns The number of managed caches.
+  size_t managed() const noexcept {
+    return _caches.size();
+  }
+
+ private:
+  /// The bookkeeping for a managed cache.
+  struct Managed {
+    /// The capacity of the cache when it was put under management.
+    size_t original;
+
+    /// Returns the capacity of the cache.
+    std::function<size_t()> get_capacity;
+
+    /// Sets the capacity of the cache.
+    std::function<void(size_t)> set_capacity;
+  };
+
+  /// Reads a single number from a file.
+  ///
+  /// \param path The path of the file.
+  /// \param number The number read.
+  /// \returns True if a number could be read, else false (e.g. for "max").
+  static bool _read_number(const std::string& path, double& number) {
+    std::ifstream file(path);
+    return static_cast<bool>(file >> number);
+  }
+
+  /// \returns The given fraction of a capacity, rounded down.
+  /// \param capacity The capacity.
+  /// \param fraction The fraction.
+  static size_t _fraction(size_t capacity, double fraction) noexcept {
+    return static_cast<size_t>(std::floor(capacity * fraction));
+  }
+
+  /// The directory of the cgroup to watch.
+  std::string _cgroup;
+
+  /// The file with the pressure stall information for memory.
+  std::string _psi;
+
+  /// The usage at or above which caches are shrunk.
+  double _high_usage;
+
+  /// The usage below which caches grow back.
+  double _low_usage;
+
+  /// The stall time at or above which caches are shrunk.
+  double _high_stall;
+
+  /// The stall time below which caches grow back.
+  double _low_stall;
+
+  /// The fraction of the original capacity to shrink or grow by per poll.
+  double _step;
+
+  /// The fraction of the original capacity below which caches never shrink.
+  double _minimum;
+
+  /// The managed caches.
+  std::vector<Managed> _caches;
+};
+
+namespace Lowercase {
+using memory_reading = MemoryReading;
+using memory_pressure = MemoryPressure;
+using memory_pressure_monitor = MemoryPressureMonitor;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_MEMORY_PRESSURE_MONITOR_HPP
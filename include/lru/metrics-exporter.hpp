@@ -0,0 +1,446 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_METRICS_EXPORTER_HPP
+#define LRU_METRICS_EXPORTER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <lru/latency-statistics.hpp>
+
+namespace LRU {
+
+/// A snapshot of the metrics of a single cache.
+struct CacheMetrics {
+  using size_t = std::size_t;
+
+  /// The number of keys in the cache.
+  size_t size = 0;
+
+  /// The capacity of the cache.
+  size_t capacity = 0;
+
+  /// True if the cache is monitored, i.e. the counters below are valid.
+  bool is_monitoring = false;
+
+  /// The total number of hits.
+  size_t hits = 0;
+
+  /// The total number of misses.
+  size_t misses = 0;
+
+  /// The total number of evictions.
+  size_t evictions = 0;
+
+  /// The total number of expirations.
+  size_t expirations = 0;
+
+  /// The total number of explicit erasures.
+  size_t erasures = 0;
+
+  /// The total number of overwrites.
+  size_t overwrites = 0;
+
+  /// The latency statistics of the cache, if it records latencies.
+  std::shared_ptr<const LatencyStatistics> latency;
+};
+
+namespace Internal {
+
+/// Stores the latency statistics of a cache that can record latencies.
+template <typename Cache>
+auto snapshot_latency(const Cache& cache, CacheMetrics& metrics, int)
+    -> decltype(cache.shared_latency(), void()) {
+  metrics.latency = cache.shared_latency();
+}
+
+/// Fallback for caches that cannot record latencies.
+template <typename Cache>
+void snapshot_latency(const Cache&, CacheMetrics&, long) {
+}
+
+/// Takes a snapshot of the metrics of a cache.
+///
+/// \param cache The cache.
+/// \returns The snapshot.
+template <typename Cache>
+CacheMetrics snapshot_metrics(const Cache& cache) {
+  CacheMetrics metrics;
+  metrics.size = cache.size();
+  metrics.capacity = cache.capacity();
+
+  if (cache.is_monitoring()) {
+    const auto& stats = cache.stats();
+    metrics.is_monitoring = true;
+    metrics.hits = stats.total_hits();
+    metrics.misses = stats.total_misses();
+    metrics.evictions = stats.total_evictions();
+    metrics.expirations = stats.total_expirations();
+    metrics.erasures = stats.total_erasures();
+    metrics.overwrites = stats.total_overwrites();
+  }
+
+  snapshot_latency(cache, metrics, 0);
+
+  return metrics;
+}
+
+}  // namespace Internal
+
+/// Renders the metrics of caches for monitoring systems.
+///
+/// Caches are registered under a name with `add()`. On each `prometheus()` or
+/// `json()` call, the exporter first takes a quick snapshot of the counters
+/// of every cache (holding the cache's lock, if one was given, only while
+/// copying a handful of integers) and then renders the text without holding
+/// any lock. Latency histograms are merged from their shards without locking,
+/// so reading them never blocks the threads using the cache.
+///
+/// Registered caches must outlive the exporter (or be removed first).
+class MetricsExporter {
+ public:
+  using size_t = std::size_t;
+  using Snapshot = std::function<CacheMetrics()>;
+
+  /// Constructor.
+  ///
+  /// \param prefix The prefix of all metric names.
+  explicit MetricsExporter(std::string prefix = "lru_cache")
+  : _prefix(std::move(prefix)) {
+  }
+
+  /// Registers a cache that is not accessed concurrently with the exporter.
+  ///
+  /// If a cache with the same name was already registered, it is replaced.
+  ///
+  /// \param name The name of the cache, used as the `cache` label.
+  /// \param cache The cache to export.
+  template <typename Cache>
+  void add(const std::string& name, const Cache& cache) {
+    _caches[name] = [&cache] { return Internal::snapshot_metrics(cache); };
+  }
+
+  /// Registers a cache guarded by a lock.
+  ///
+  /// \param name The name of the cache, used as the `cache` label.
+  /// \param cache The cache to export.
+  /// \param lock The lock guarding the cache (any `BasicLockable`).
+  template <typename Cache, typename Lock>
+  void add(const std::string& name, const Cache& cache, Lock& lock) {
+    _caches[name] = [&cache, &lock] {
+      std::lock_guard<Lock> guard(lock);
+      return Internal::snapshot_metrics(cache);
+    };
+  }
+
+  /// Unregisters a cache.
+  ///
+  /// \param name The name of the cache.
+  void remove(const std::string& name) {
+    _caches.erase(name);
+  }
+
+  /// \returns The number of registered caches.
+  size_t size() const noexcept {
+    return _caches.size();
+  }
+
+  /// \returns A snapshot of the metrics of every cache, by name.
+  std::map<std::string, CacheMetrics> snapshot() const {
+    std::map<std::string, CacheMetrics> snapshots;
+    for (const auto& pair : _caches) {
+      snapshots.emplace(pair.first, pair.second());
+    }
+
+    return snapshots;
+  }
+
+  /// \returns The metrics of all caches in the Prometheus text exposition
+  /// format. Latencies are exported as summaries, in seconds.
+  std::string prometheus() const {
+    const auto snapshots = snapshot();
+
+    std::ostringstream out;
+    out << std::setprecision(9);
+
+    _gauge(out, snapshots, "size", "Number of keys in the cache.",
+           &CacheMetrics::size);
+    _gauge(out, snapshots, "capacity", "Maximum number of keys.",
+           &CacheMetrics::capacity);
+
+    _counter(out, snapshots, "hits", "Lookups that found their key.",
+             &CacheMetrics::hits);
+    _counter(out, snapshots, "misses", "Lookups that missed their key.",
+             &CacheMetrics::misses);
+    _counter(out, snapshots, "evictions", "Keys evicted for lack of room.",
+             &CacheMetrics::evictions);
+    _counter(out, snapshots, "expirations", "Expired keys cleared.",
+             &CacheMetrics::expirations);
+    _counter(out, snapshots, "erasures", "Keys erased explicitly.",
+             &CacheMetrics::erasures);
+    _counter(out, snapshots, "overwrites", "Values overwritten.",
+             &CacheMetrics::overwrites);
+
+    _latencies(out, snapshots);
+
+    return out.str();
+  }
+
+  /// \returns The metrics of all caches as a JSON object, keyed by the names
+  /// of the caches. Latency percentiles are given in nanoseconds.
+  std::string json() const {
+    const auto snapshots = snapshot();
+
+    std::ostringstream out;
+    out << std::setprecision(9) << '{';
+
+    bool first = true;
+    for (const auto& pair : snapshots) {
+      const auto& metrics = pair.second;
+      if (!first) out << ',';
+      first = false;
+
+      out << '"' << _escape_json(pair.first) << "\":{";
+      out << "\"size\":" << metrics.size;
+      out << ",\"capacity\":" << metrics.capacity;
+
+      if (metrics.is_monitoring) {
+        out << ",\"hits\":" << metrics.hits;
+        out << ",\"misses\":" << metrics.misses;
+        out << ",\"evictions\":" << metrics.evictions;
+        out << ",\"expirations\":" << metrics.expirations;
+        out << ",\"erasures\":" << metrics.erasures;
+        out << ",\"overwrites\":" << metrics.overwrites;
+      }
+
+      if (metrics.latency) {
+        out << ",\"latency\":{";
+        for (size_t index = 0; index < LatencyStatistics::OPERATIONS;
+             ++index) {
+          const auto operation = static_cast<Operation>(index);
+          const auto histogram = metrics.latency->histogram(operation);
+          if (index > 0) out << ',';
+          out << '"' << _operation_name(operation) << "\":{";
+          out << "\"count\":" << histogram.count();
+          out << ",\"mean\":" << histogram.mean();
+          out << ",\"p50\":" << histogram.percentile(0.5);
+          out << ",\"p90\":" << histogram.percentile(0.9);
+          out << ",\"p99\":" << histogram.percentile(0.99);
+          out << ",\"p999\":" << histogram.percentile(0.999);
+          out << ",\"max\":" << histogram.max() << '}';
+        }
+        out << '}';
+      }
+
+      out << '}';
+    }
+
+    out << '}';
+
+    return out.str();
+  }
+
+ private:
+  using Snapshots = std::map<std::string, CacheMetrics>;
+  using Field = size_t CacheMetrics::*;
+
+  /// Renders a gauge for all caches.
+  ///
+  /// \param out The stream to render into.
+  /// \param snapshots The snapshots of all caches.
+  /// \param name The name of the metric (without prefix).
+  /// \param help The description of the metric.
+  /// \param field The field of the snapshots holding the metric.
+  void _gauge(std::ostream& out,
+              const Snapshots& snapshots,
+              const std::string& name,
+              const std::string& help,
+              Field field) const {
+    const auto metric = _prefix + "_" + name;
+    out << "# HELP " << metric << ' ' << help << '\n';
+    out << "# TYPE " << metric << " gauge\n";
+    for (const auto& pair : snapshots) {
+      out << metric << _labels(pair.first) << ' ' << pair.second.*field
+          << '\n';
+    }
+  }
+
+  /// Renders a counter for all monitored caches.
+  ///
+  /// \param out The stream to render into.
+  /// \param snapshots The snapshots of all caches.
+  /// \param name The name of the metric (without prefix and suffix).
+  /// \param help The description of the metric.
+  /// \param field The field of the snapshots holding the metric.
+  void _counter(std::ostream& out,
+                const Snapshots& snapshots,
+                const std::string& name,
+                const std::string& help,
+                Field field) const {
+    const auto metric = _prefix + "_" + name + "_total";
+    out << "# HELP " << metric << ' ' << help << '\n';
+    out << "# TYPE " << metric << " counter\n";
+    for (const auto& pair : snapshots) {
+      if (!pair.second.is_monitoring) continue;
+      out << metric << _labels(pair.first) << ' ' << pair.second.*field
+          << '\n';
+    }
+  }
+
+  /// Renders the latency summaries of all caches recording latencies.
+  ///
+  /// \param out The stream to render into.
+  /// \param snapshots The snapshots of all caches.
+  void _latencies(std::ostream& out, const Snapshots& snapshots) const {
+    const auto metric = _prefix + "_operation_duration_seconds";
+    out << "# HELP " << metric << " Latency of cache operations.\n";
+    out << "# TYPE " << metric << " summary\n";
+
+    for (const auto& pair : snapshots) {
+      const auto& latency = pair.second.latency;
+      if (!latency) continue;
+
+      for (size_t index = 0; index < LatencyStatistics::OPERATIONS; ++index) {
+        const auto operation = static_cast<Operation>(index);
+        const auto histogram = latency->histogram(operation);
+        const auto labels = _labels(pair.first, _operation_name(operation));
+
+        for (const auto quantile : {0.5, 0.9, 0.99, 0.999}) {
+          out << metric
+              << _labels(pair.first, _operation_name(operation), quantile)
+              << ' ' << histogram.percentile(quantile) / 1e9 << '\n';
+        }
+
+        out << metric << "_sum" << labels << ' '
+            << histogram.mean() * histogram.count() / 1e9 << '\n';
+        out << metric << "_count" << labels << ' ' << histogram.count()
+            << '\n';
+      }
+    }
+  }
+
+  /// \returns The label set for a cache.
+  static std::string _labels(const std::string& cache) {
+    return "{cache=\"" + _escape(cache) + "\"}";
+  }
+
+  /// \returns The label set for an operation of a cache.
+  static std::string _labels(const std::string& cache, const char* operation) {
+    return "{cache=\"" + _escape(cache) + "\",operation=\"" + operation + "\"}";
+  }
+
+  /// \returns The label set for a quantile of an operation of a cache.
+  static std::string
+  _labels(const std::string& cache, const char* operation, double quantile) {
+    std::ostringstream label;
+    label << quantile;
+    return "{cache=\"" + _escape(cache) + "\",operation=\"" + operation +
+           "\",quantile=\"" + label.str() + "\"}";
+  }
+
+  /// \returns The name of an operation.
+  static const char* _operation_name(Operation operation) noexcept {
+    switch (operation) {
+      case Operation::Find: return "find";
+      case Operation::Insert: return "insert";
+      case Operation::Emplace: return "emplace";
+      case Operation::Erase: return "erase";
+      case Operation::Evict: return "evict";
+      case Operation::ClearExpired: return "clear_expired";
+    }
+
+    return "unknown";
+  }
+
+  /// Escapes backslashes, quotes and newlines, as required for Prometheus
+  /// label values.
+  ///
+  /// \param string The string to escape.
+  /// \returns The escaped string.
+  static std::string _escape(const std::string& string) {
+    std::string escaped;
+    escaped.reserve(string.size());
+    for (const auto character : string) {
+      switch (character) {
+        case '\\': escaped += "\\\\"; break;
+        case '"': escaped += "\\\""; break;
+        case '\n': escaped += "\\n"; break;
+        default: escaped += character;
+      }
+    }
+
+    return escaped;
+  }
+
+  /// Escapes a string for use in a JSON string. Unlike label values, JSON
+  /// strings may not contain any control characters.
+  ///
+  /// \param string The string to escape.
+  /// \returns The escaped string.
+  static std::string _escape_json(const std::string& string) {
+    static const char digits[] = "0123456789abcdef";
+
+    std::string escaped;
+    escaped.reserve(string.size());
+    for (const auto character : string) {
+      const auto code = static_cast<unsigned char>(character);
+      if (character == '\\' || character == '"') {
+        escaped += '\\';
+        escaped += character;
+      } else if (character == '\n') {
+        escaped += "\\n";
+      } else if (code < 0x20) {
+        escaped += "\\u00";
+        escaped += digits[code >> 4];
+        escaped += digits[code & 0xf];
+      } else {
+        escaped += character;
+      }
+    }
+
+    return escaped;
+  }
+
+  /// The prefix of all metric names.
+  std::string _prefix;
+
+  /// The snapshot functions of all caches, by name.
+  std::map<std::string, Snapshot> _caches;
+};
+
+namespace Lowercase {
+using cache_metrics = CacheMetrics;
+using metrics_exporter = MetricsExporter;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_METRICS_EXPORTER_HPP
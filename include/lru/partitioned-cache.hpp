@@ -0,0 +1,343 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_PARTITIONED_CACHE_HPP
+#define LRU_PARTITIONED_CACHE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <lru/cache-tags.hpp>
+#include <lru/error.hpp>
+#include <lru/hash.hpp>
+#include <lru/internal/base-segmented-cache.hpp>
+#include <lru/internal/definitions.hpp>
+
+namespace LRU {
+
+/// A cache shared by several partitions (e.g. tenants) with their own quotas.
+///
+/// Every key is inserted into a partition, identified by an arbitrary id. All
+/// partitions share a single hash index, but each partition keeps its own LRU
+/// list and is guaranteed room for as many keys as its quota. Beyond its
+/// quota, a partition may borrow slots from a shared overflow pool.
+///
+/// A partition that is at or above its quota and finds the pool exhausted
+/// replaces its own least recently used key, so a noisy partition can only
+/// ever evict its own keys or keys other partitions borrowed from the pool. If
+/// the pool is overcommitted (e.g. after shrinking it), the partition that
+/// borrowed the most is evicted from first.
+///
+/// Partitions that were never given a quota explicitly are created on first
+/// use with a quota of zero, i.e. they live off the shared pool only.
+///
+/// \tparam Key The key type of the cache.
+/// \tparam Value The value type of the cache.
+/// \tparam PartitionId The type of the ids of the partitions.
+/// \tparam HashFunction The hash function type for the internal map.
+/// \tparam KeyEqual The type of the key equality function for the internal map.
+template <typename Key,
+          typename Value,
+          typename PartitionId = std::size_t,
+          typename HashFunction = DefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class PartitionedCache
+    : public Internal::BaseSegmentedCache<Key, Value, HashFunction, KeyEqual> {
+ private:
+  using super =
+      Internal::BaseSegmentedCache<Key, Value, HashFunction, KeyEqual>;
+  using super::NO_VICTIM;
+  using super::REJECT;
+
+ public:
+  using Tag = LRU::Tag::PartitionedCache;
+  using size_t = std::size_t;
+
+  static constexpr Tag tag() noexcept {
+    return {};
+  }
+
+  /// Constructor.
+  ///
+  /// \param shared_pool The number of slots in the shared overflow pool.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  explicit PartitionedCache(size_t shared_pool = Internal::DEFAULT_CAPACITY,
+                            const HashFunction& hash = HashFunction(),
+                            const KeyEqual& key_equal = KeyEqual())
+  : super(0, hash, key_equal)
+  , _shared_pool(shared_pool)
+  , _borrowed(0)
+  , _total_quota(0) {
+  }
+
+  /// Inserts the given `(key, value)` pair into the given partition.
+  ///
+  /// If the key is already present in the partition, its value is updated. If
+  /// it is present in another partition, it is moved to the given partition,
+  /// as if it had been erased and inserted anew.
+  ///
+  /// \complexity O(1) expected and amortized, O(P) for P partitions if the
+  /// shared pool is overcommitted.
+  /// \param key The key to insert.
+  /// \param value The value to insert with the key.
+  /// \param partition The partition to insert the key into.
+  /// \returns True if the key was newly inserted, false if it was only updated
+  /// or rejected.
+  bool
+  insert(const Key& key, const Value& value, const PartitionId& partition) {
+    return emplace(key, value, partition);
+  }
+
+  /// Emplaces a new `(key, value)` pair into the given partition.
+  ///
+  /// \param key_argument The argument to construct a key object with.
+  /// \param value_argument The argument to construct a value object with.
+  /// \param partition The partition to insert the key into.
+  /// \returns True if the key was newly inserted, false if it was only updated
+  /// or rejected.
+  /// \see insert()
+  template <typename K, typename V>
+  bool emplace(K&& key_argument,
+               V&& value_argument,
+               const PartitionId& partition) {
+    Key key(std::forward<K>(key_argument));
+    const auto segment = _segment_for(partition);
+
+    // Moving a key between partitions must respect the new partition's quota.
+    auto iterator = this->_map.find(key);
+    if (iterator != this->_map.end() && iterator->second.segment != segment) {
+      super::_erase(iterator);
+    }
+
+    return super::_emplace(
+        std::move(key), std::forward<V>(value_argument), segment);
+  }
+
+  /// Looks up the partition of a key, without counting as an access.
+  ///
+  /// \param key The key whose partition to look up.
+  /// \throws LRU::Error::KeyNotFound if the key is not in the cache.
+  /// \returns The id of the partition of the key.
+  const PartitionId& partition_of(const Key& key) const {
+    auto iterator = this->_map.find(key);
+    if (iterator == this->_map.end()) {
+      throw LRU::Error::KeyNotFound();
+    }
+
+    return _partitions[iterator->second.segment].id;
+  }
+
+  /// Sets the quota of a partition, creating the partition if necessary.
+  ///
+  /// Keys the partition holds beyond its new quota count as borrowed from the
+  /// shared pool. If this overcommits the pool, the partition's least recently
+  /// used keys are evicted until it fits again.
+  ///
+  /// \param partition The id of the partition.
+  /// \param quota The number of slots guaranteed to the partition.
+  void quota(const PartitionId& partition, size_t quota) {
+    const auto segment = _segment_for(partition);
+    auto& information = _partitions[segment];
+
+    _borrowed -= _borrowed_by(segment);
+    _total_quota -= information.quota;
+    information.quota = quota;
+    _total_quota += quota;
+    _borrowed += _borrowed_by(segment);
+
+    while (_borrowed > _shared_pool && _borrowed_by(segment) > 0) {
+      super::_erase_lru(segment);
+    }
+  }
+
+  /// \returns The quota of the given partition (zero for unknown partitions).
+  /// \param partition The id of the partition.
+  size_t quota(const PartitionId& partition) const {
+    auto iterator = _segment_of.find(partition);
+    if (iterator == _segment_of.end()) return 0;
+    return _partitions[iterator->second].quota;
+  }
+
+  /// Sets the number of slots in the shared overflow pool.
+  ///
+  /// If the pool shrinks below the number of borrowed slots, keys are evicted
+  /// from the partitions that borrowed the most.
+  ///
+  /// \param new_size The new size of the shared pool.
+  void shared_pool(size_t new_size) {
+    _shared_pool = new_size;
+    while (_borrowed > _shared_pool) {
+      super::_erase_lru(_biggest_borrower());
+    }
+  }
+
+  /// \returns The number of slots in the shared overflow pool.
+  size_t shared_pool() const noexcept {
+    return _shared_pool;
+  }
+
+  /// \returns The number of slots currently borrowed from the shared pool.
+  size_t borrowed() const noexcept {
+    return _borrowed;
+  }
+
+  /// \returns The number of slots the partition borrowed from the shared pool.
+  /// \param partition The id of the partition.
+  size_t borrowed(const PartitionId& partition) const {
+    auto iterator = _segment_of.find(partition);
+    if (iterator == _segment_of.end()) return 0;
+    return _borrowed_by(iterator->second);
+  }
+
+  using super::size;
+
+  /// \returns The number of keys in the given partition.
+  /// \param partition The id of the partition.
+  size_t size(const PartitionId& partition) const {
+    auto iterator = _segment_of.find(partition);
+    if (iterator == _segment_of.end()) return 0;
+    return super::_segment_size(iterator->second);
+  }
+
+  /// \returns The number of partitions.
+  size_t partitions() const noexcept {
+    return _partitions.size();
+  }
+
+  /// \returns The total capacity of the cache, i.e. the sum of all quotas and
+  /// the size of the shared pool.
+  size_t capacity() const noexcept {
+    return _total_quota + _shared_pool;
+  }
+
+  /// \returns True if the cache's size equals its capacity, else false.
+  bool is_full() const noexcept {
+    return size() >= capacity();
+  }
+
+  /// \copydoc Internal::BaseSegmentedCache::clear()
+  void clear() override {
+    super::clear();
+    _borrowed = 0;
+  }
+
+ protected:
+  /// \copydoc Internal::BaseSegmentedCache::_victim_for()
+  size_t _victim_for(size_t segment) const override {
+    if (super::_segment_size(segment) < _partitions[segment].quota) {
+      // Room within the quota is guaranteed, unless the pool is overcommitted.
+      return (_borrowed > _shared_pool) ? _biggest_borrower() : NO_VICTIM;
+    }
+
+    // The new key would have to be borrowed from the pool.
+    if (_borrowed < _shared_pool) return NO_VICTIM;
+    if (super::_segment_size(segment) > 0) return segment;
+
+    return (_borrowed > 0) ? _biggest_borrower() : REJECT;
+  }
+
+  /// \copydoc Internal::BaseSegmentedCache::_segment_grew()
+  void _segment_grew(size_t segment) override {
+    if (super::_segment_size(segment) > _partitions[segment].quota) {
+      ++_borrowed;
+    }
+  }
+
+  /// \copydoc Internal::BaseSegmentedCache::_segment_shrunk()
+  void _segment_shrunk(size_t segment) override {
+    if (super::_segment_size(segment) >= _partitions[segment].quota) {
+      --_borrowed;
+    }
+  }
+
+ private:
+  /// The bookkeeping for a single partition.
+  struct Partition {
+    /// The id of the partition.
+    PartitionId id;
+
+    /// The number of slots guaranteed to the partition.
+    size_t quota;
+  };
+
+  /// Looks up the segment of a partition, creating it if necessary.
+  ///
+  /// \param partition The id of the partition.
+  /// \returns The index of the partition's segment.
+  size_t _segment_for(const PartitionId& partition) {
+    auto iterator = _segment_of.find(partition);
+    if (iterator != _segment_of.end()) return iterator->second;
+
+    const auto segment = super::_add_segment();
+    _partitions.push_back({partition, 0});
+    _segment_of.emplace(partition, segment);
+
+    return segment;
+  }
+
+  /// \returns The number of slots the partition borrowed from the pool.
+  /// \param segment The segment of the partition.
+  size_t _borrowed_by(size_t segment) const noexcept {
+    const auto size = super::_segment_size(segment);
+    const auto quota = _partitions[segment].quota;
+    return (size > quota) ? size - quota : 0;
+  }
+
+  /// \returns The segment of the partition that borrowed the most slots.
+  size_t _biggest_borrower() const noexcept {
+    size_t biggest = 0;
+    for (size_t segment = 1; segment < _partitions.size(); ++segment) {
+      if (_borrowed_by(segment) > _borrowed_by(biggest)) {
+        biggest = segment;
+      }
+    }
+
+    return biggest;
+  }
+
+  /// The partitions, indexed by their segment.
+  std::vector<Partition> _partitions;
+
+  /// The map from partition ids to their segments.
+  std::unordered_map<PartitionId, size_t> _segment_of;
+
+  /// The number of slots in the shared overflow pool.
+  size_t _shared_pool;
+
+  /// The number of slots currently borrowed from the pool.
+  size_t _borrowed;
+
+  /// The sum of the quotas of all partitions.
+  size_t _total_quota;
+};
+
+namespace Lowercase {
+template <typename... Ts>
+using partitioned_cache = PartitionedCache<Ts...>;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_PARTITIONED_CACHE_HPP
@@ -0,0 +1,306 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_PRIORITY_CACHE_HPP
+#define LRU_PRIORITY_CACHE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <lru/cache-tags.hpp>
+#include <lru/error.hpp>
+#include <lru/hash.hpp>
+#include <lru/internal/base-segmented-cache.hpp>
+#include <lru/internal/definitions.hpp>
+
+namespace LRU {
+
+/// A cache whose keys belong to one of several priority classes.
+///
+/// Every key is inserted with a priority (`0` being the lowest and the
+/// default). Each priority class keeps its own LRU list, and keys of lower
+/// classes are always evicted before keys of higher classes. A new key never
+/// displaces a key of a higher class: if the cache is full of keys with
+/// higher priorities, the insertion is rejected.
+///
+/// To keep bursts of high-priority keys from starving the lower classes
+/// completely, each class can be given a minimum share of the capacity (see
+/// `minimum_share()`). Keys of a class that holds no more than its share are
+/// not evicted to make room for other classes.
+///
+/// \tparam Key The key type of the cache.
+/// \tparam Value The value type of the cache.
+/// \tparam HashFunction The hash function type for the internal map.
+/// \tparam KeyEqual The type of the key equality function for the internal map.
+template <typename Key,
+          typename Value,
+          typename HashFunction = DefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class PriorityCache
+    : public Internal::BaseSegmentedCache<Key, Value, HashFunction, KeyEqual> {
+ private:
+  using super =
+      Internal::BaseSegmentedCache<Key, Value, HashFunction, KeyEqual>;
+  using super::NO_VICTIM;
+  using super::REJECT;
+
+ public:
+  using Tag = LRU::Tag::PriorityCache;
+  using size_t = std::size_t;
+  using Priority = std::size_t;
+
+  static constexpr Tag tag() noexcept {
+    return {};
+  }
+
+  /// Constructor.
+  ///
+  /// \param capacity The capacity of the cache.
+  /// \param priorities The number of priority classes.
+  /// \param hash The hash function to use for the internal map.
+  /// \param key_equal The key equality function to use for the internal map.
+  explicit PriorityCache(
+      size_t capacity = Internal::DEFAULT_CAPACITY,
+      size_t priorities = Internal::DEFAULT_PRIORITY_CLASSES,
+      const HashFunction& hash = HashFunction(),
+      const KeyEqual& key_equal = KeyEqual())
+  : super(priorities, hash, key_equal)
+  , _capacity(capacity)
+  , _shares(priorities, 0.0) {
+    assert(priorities > 0);
+  }
+
+  /// Inserts the given `(key, value)` pair into the given priority class.
+  ///
+  /// If the key is already present, its value is updated and it is moved to
+  /// the given priority class. If the cache is full, the least recently used
+  /// key of the lowest class that holds more than its minimum share is evicted
+  /// first (only considering classes up to the given one). If there is no such
+  /// key, the least recently used key of the given class is replaced instead,
+  /// or the insertion is rejected if that class is empty.
+  ///
+  /// \complexity O(P) for P priority classes, O(1) if the cache is not full.
+  /// \param key The key to insert.
+  /// \param value The value to insert with the key.
+  /// \param priority The priority class of the key.
+  /// \throws LRU::Error::InvalidArgument if there is no such priority class.
+  /// \returns True if the key was newly inserted, false if it was only updated
+  /// or rejected.
+  bool insert(const Key& key, const Value& value, Priority priority = 0) {
+    _check_priority(priority);
+    return super::_emplace(key, value, priority);
+  }
+
+  /// Emplaces a new `(key, value)` pair into the given priority class.
+  ///
+  /// \param key_argument The argument to construct a key object with.
+  /// \param value_argument The argument to construct a value object with.
+  /// \param priority The priority class of the key.
+  /// \throws LRU::Error::InvalidArgument if there is no such priority class.
+  /// \returns True if the key was newly inserted, false if it was only updated
+  /// or rejected.
+  /// \see insert()
+  template <typename K, typename V>
+  bool emplace(K&& key_argument, V&& value_argument, Priority priority = 0) {
+    _check_priority(priority);
+    return super::_emplace(std::forward<K>(key_argument),
+                           std::forward<V>(value_argument),
+                           priority);
+  }
+
+  /// Looks up the priority class of a key, without counting as an access.
+  ///
+  /// \param key The key whose priority to look up.
+  /// \throws LRU::Error::KeyNotFound if the key is not in the cache.
+  /// \returns The priority class of the key.
+  Priority priority(const Key& key) const {
+    auto iterator = this->_map.find(key);
+    if (iterator == this->_map.end()) {
+      throw LRU::Error::KeyNotFound();
+    }
+
+    return iterator->second.segment;
+  }
+
+  /// Reserves a fraction of the capacity for the given priority class.
+  ///
+  /// As long as a class holds no more keys than its share, none of its keys
+  /// are evicted to make room for keys of other classes.
+  ///
+  /// \param priority The priority class whose share to set.
+  /// \param fraction The fraction of the capacity to reserve, in `[0, 1]`.
+  /// \throws LRU::Error::InvalidArgument if there is no such priority class or
+  /// the fraction is out of range.
+  void minimum_share(Priority priority, double fraction) {
+    _check_priority(priority);
+    if (fraction < 0 || fraction > 1) {
+      throw LRU::Error::InvalidArgument("Share must lie in [0, 1]");
+    }
+
+    _shares[priority] = fraction;
+  }
+
+  /// \returns The fraction of the capacity reserved for the priority class.
+  /// \param priority The priority class whose share to return.
+  double minimum_share(Priority priority) const {
+    _check_priority(priority);
+    return _shares[priority];
+  }
+
+  /// \returns The number of keys reserved for the priority class.
+  /// \param priority The priority class whose reservation to return.
+  size_t reserved(Priority priority) const {
+    _check_priority(priority);
+    return _reserved(priority);
+  }
+
+  /// \returns The number of priority classes.
+  size_t priorities() const noexcept {
+    return _shares.size();
+  }
+
+  using super::size;
+
+  /// \returns The number of keys in the given priority class.
+  /// \param priority The priority class whose keys to count.
+  size_t size(Priority priority) const {
+    _check_priority(priority);
+    return super::_segment_size(priority);
+  }
+
+  /// Sets the capacity of the cache, evicting keys if necessary.
+  ///
+  /// Keys are evicted from the lowest priority classes first (see `shrink()`).
+  ///
+  /// \param new_capacity The new capacity of the cache.
+  void capacity(size_t new_capacity) {
+    shrink(new_capacity);
+    _capacity = new_capacity;
+  }
+
+  /// \returns The current capacity of the cache.
+  size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+  /// Evicts keys until the size of the cache is at most the given size.
+  ///
+  /// Keys above their class's minimum share go first, lowest class first. Once
+  /// every class is within its share, the lowest non-empty class gives way.
+  ///
+  /// \param new_size The size to shrink the cache to.
+  void shrink(size_t new_size) {
+    while (size() > new_size) {
+      super::_erase_lru(_shrink_victim());
+    }
+  }
+
+  /// \returns The number of slots left in the cache.
+  size_t space_left() const noexcept {
+    return _capacity - size();
+  }
+
+  /// \returns True if the cache's size equals its capacity, else false.
+  bool is_full() const noexcept {
+    return size() >= _capacity;
+  }
+
+ protected:
+  /// \copydoc Internal::BaseSegmentedCache::_victim_for()
+  size_t _victim_for(size_t segment) const override {
+    if (size() < _capacity) return NO_VICTIM;
+    return _lowest_evictable(segment);
+  }
+
+ private:
+  /// Finds the lowest class up to (and including) the given one whose least
+  /// recently used key may be evicted.
+  ///
+  /// \param limit The highest class to consider.
+  /// \returns The class to evict from, or `REJECT` if there is none.
+  size_t _lowest_evictable(Priority limit) const {
+    for (Priority priority = 0; priority <= limit; ++priority) {
+      if (super::_segment_size(priority) > _reserved(priority)) {
+        return priority;
+      }
+    }
+
+    // Every class holds no more than its share, so a key may only replace one
+    // of its own class (reservations are never exceeded by design).
+    if (super::_segment_size(limit) > 0) return limit;
+
+    return REJECT;
+  }
+
+  /// Finds the class to evict from when shrinking a non-empty cache.
+  ///
+  /// Unlike insertion, shrinking may dig into the minimum shares. It still
+  /// prefers the lowest class above its reservation and otherwise falls back
+  /// to the lowest non-empty class, so lower classes are always evicted first.
+  ///
+  /// \returns The class to evict from.
+  Priority _shrink_victim() const {
+    for (Priority priority = 0; priority < priorities(); ++priority) {
+      if (super::_segment_size(priority) > _reserved(priority)) {
+        return priority;
+      }
+    }
+
+    Priority priority = 0;
+    while (super::_segment_size(priority) == 0) ++priority;
+
+    return priority;
+  }
+
+  /// \returns The number of keys reserved for the priority class.
+  /// \param priority The priority class whose reservation to return.
+  size_t _reserved(Priority priority) const noexcept {
+    return static_cast<size_t>(_shares[priority] * _capacity);
+  }
+
+  /// Throws if the priority class does not exist.
+  ///
+  /// \param priority The priority class to check.
+  /// \throws LRU::Error::InvalidArgument if there is no such priority class.
+  void _check_priority(Priority priority) const {
+    if (priority >= priorities()) {
+      throw LRU::Error::InvalidArgument("No such priority class");
+    }
+  }
+
+  /// The current capacity of the cache.
+  size_t _capacity;
+
+  /// The minimum share of the capacity reserved for each priority class.
+  std::vector<double> _shares;
+};
+
+namespace Lowercase {
+template <typename... Ts>
+using priority_cache = PriorityCache<Ts...>;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_PRIORITY_CACHE_HPP
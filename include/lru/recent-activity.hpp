@@ -0,0 +1,278 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_RECENT_ACTIVITY_HPP
+#define LRU_RECENT_ACTIVITY_HPP
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <lru/error.hpp>
+
+namespace LRU {
+
+/// The events whose recent activity is tracked.
+enum class Event {
+  Hit,
+  Miss,
+  Insertion,
+  Eviction,
+};
+
+/// Tracks the recent activity of a cache in a sliding window.
+///
+/// Whereas the totals of a `Statistics` object accumulate since construction,
+/// recent activity answers questions like "what was the hit rate over the
+/// last ten seconds", which is what is needed to notice a sudden collapse of
+/// the hit rate of a long-running cache. For this, events are counted in a
+/// ring of time slots, a quarter of a second wide, spanning the last 64
+/// seconds. Windowed counts are thus accurate up to the width of one slot.
+///
+/// Additionally, exponentially weighted moving averages of the rate of every
+/// event (in events per second) are maintained with time constants of one,
+/// ten and sixty seconds, like the load averages of an operating system.
+class RecentActivity {
+ public:
+  using size_t = std::size_t;
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+  using Seconds = std::chrono::duration<double>;
+
+  /// The number of distinct events.
+  static constexpr size_t EVENTS = 4;
+
+  /// The number of time slots per second.
+  static constexpr std::int64_t SLOTS_PER_SECOND = 4;
+
+  /// The number of time slots in the ring.
+  static constexpr size_t SLOTS = 256;
+
+  /// The number of seconds spanned by the ring.
+  static constexpr std::int64_t SPAN = SLOTS / SLOTS_PER_SECOND;
+
+  /// Constructor.
+  ///
+  /// \param now The current time.
+  explicit RecentActivity(TimePoint now = Clock::now())
+  : _origin(now), _slots(SLOTS) {
+    for (auto& averages : _averages) {
+      averages.fill(0);
+    }
+    _last_update.fill(now);
+  }
+
+  /// Records events.
+  ///
+  /// \param event The event that occurred.
+  /// \param now The time at which the event occurred.
+  /// \param count The number of times the event occurred.
+  void record(Event event, TimePoint now = Clock::now(), size_t count = 1) {
+    const auto tick = _tick_of(now);
+    auto& slot = _slots[tick % SLOTS];
+    if (slot.tick != tick) {
+      slot.tick = tick;
+      slot.counts.fill(0);
+    }
+    slot.counts[_index(event)] += count;
+
+    auto& averages = _averages[_index(event)];
+    auto& last_update = _last_update[_index(event)];
+    for (size_t index = 0; index < averages.size(); ++index) {
+      const auto constant = _time_constant(index);
+      averages[index] = _decayed(averages[index], last_update, now, constant) +
+                        count / constant;
+    }
+    if (now > last_update) last_update = now;
+  }
+
+  /// \returns The number of times the event occurred in the given window.
+  /// \param event The event to count.
+  /// \param window How far to look back. At most `SPAN` seconds.
+  /// \param now The current time.
+  /// \throws LRU::Error::InvalidArgument if the window is longer than the
+  /// span of the ring.
+  template <typename Duration>
+  size_t count(Event event,
+               const Duration& window,
+               TimePoint now = Clock::now()) const {
+    const auto slots = _slots_in(window);
+    const auto tick = _tick_of(now);
+
+    size_t total = 0;
+    for (const auto& slot : _slots) {
+      if (slot.tick <= tick && tick - slot.tick < slots) {
+        total += slot.counts[_index(event)];
+      }
+    }
+
+    return total;
+  }
+
+  /// \returns The number of times the event occurred per second in the
+  /// given window.
+  /// \param event The event to count.
+  /// \param window How far to look back. At most `SPAN` seconds.
+  /// \param now The current time.
+  /// \throws LRU::Error::InvalidArgument if the window is longer than the
+  /// span of the ring.
+  template <typename Duration>
+  double rate(Event event,
+              const Duration& window,
+              TimePoint now = Clock::now()) const {
+    const auto seconds = static_cast<double>(_slots_in(window)) /
+                         SLOTS_PER_SECOND;
+    return count(event, window, now) / seconds;
+  }
+
+  /// \returns The ratio of hits ($\in [0, 1]$) relative to all accesses in
+  /// the given window (NaN if there were none).
+  /// \param window How far to look back. At most `SPAN` seconds.
+  /// \param now The current time.
+  /// \throws LRU::Error::InvalidArgument if the window is longer than the
+  /// span of the ring.
+  template <typename Duration>
+  double hit_rate(const Duration& window, TimePoint now = Clock::now()) const {
+    const auto hits = count(Event::Hit, window, now);
+    const auto misses = count(Event::Miss, window, now);
+    return static_cast<double>(hits) / (hits + misses);
+  }
+
+  /// \returns The exponentially weighted moving average of the rate of the
+  /// event, in events per second.
+  /// \param event The event whose rate to return.
+  /// \param time_constant The time constant of the average. Either one, ten
+  /// or sixty seconds.
+  /// \param now The current time.
+  /// \throws LRU::Error::InvalidArgument if there is no average with the
+  /// given time constant.
+  template <typename Duration>
+  double average_rate(Event event,
+                      const Duration& time_constant,
+                      TimePoint now = Clock::now()) const {
+    const auto seconds = std::chrono::duration_cast<Seconds>(time_constant);
+    for (size_t index = 0; index < AVERAGES; ++index) {
+      if (seconds.count() == _time_constant(index)) {
+        return _decayed(_averages[_index(event)][index],
+                        _last_update[_index(event)],
+                        now,
+                        _time_constant(index));
+      }
+    }
+
+    throw LRU::Error::InvalidArgument(
+        "Averages are only kept for time constants of 1s, 10s and 60s");
+  }
+
+  /// Clears all recent activity.
+  ///
+  /// \param now The current time.
+  void reset(TimePoint now = Clock::now()) {
+    *this = RecentActivity(now);
+  }
+
+ private:
+  /// The number of moving averages per event.
+  static constexpr size_t AVERAGES = 3;
+
+  /// The sentinel tick of a slot that was never used.
+  static constexpr std::uint64_t UNUSED =
+      std::numeric_limits<std::uint64_t>::max();
+
+  using Ticks = std::chrono::duration<std::int64_t,
+                                      std::ratio<1, SLOTS_PER_SECOND>>;
+  using Averages = std::array<double, AVERAGES>;
+
+  /// The counts of all events within one time slot.
+  struct Slot {
+    /// The tick the slot currently holds the counts for.
+    std::uint64_t tick = UNUSED;
+
+    /// The counts of every event.
+    std::array<size_t, EVENTS> counts{};
+  };
+
+  /// \returns The index of an event.
+  static size_t _index(Event event) noexcept {
+    return static_cast<size_t>(event);
+  }
+
+  /// \returns The time constant, in seconds, of the average at the index.
+  static double _time_constant(size_t index) noexcept {
+    return index == 0 ? 1 : index == 1 ? 10 : 60;
+  }
+
+  /// \returns An average decayed from the time of its last update to now.
+  static double _decayed(double average,
+                         TimePoint last_update,
+                         TimePoint now,
+                         double time_constant) noexcept {
+    if (now <= last_update) return average;
+    const auto elapsed =
+        std::chrono::duration_cast<Seconds>(now - last_update).count();
+    return average * std::exp(-elapsed / time_constant);
+  }
+
+  /// \returns The number of slots covered by the window.
+  template <typename Duration>
+  static std::uint64_t _slots_in(const Duration& window) {
+    auto ticks = std::chrono::duration_cast<Ticks>(window);
+    if (ticks < window) ticks += Ticks(1);
+
+    if (ticks.count() > static_cast<std::int64_t>(SLOTS)) {
+      throw LRU::Error::InvalidArgument(
+          "Recent activity is only tracked for the last 64 seconds");
+    }
+
+    return ticks.count() < 1 ? 1 : static_cast<std::uint64_t>(ticks.count());
+  }
+
+  /// \returns The tick (index of the time slot since the origin) of a time.
+  std::uint64_t _tick_of(TimePoint time) const noexcept {
+    if (time <= _origin) return 0;
+    return std::chrono::duration_cast<Ticks>(time - _origin).count();
+  }
+
+  /// The time at which tracking started.
+  TimePoint _origin;
+
+  /// The ring of time slots.
+  std::vector<Slot> _slots;
+
+  /// The moving averages of every event.
+  std::array<Averages, EVENTS> _averages;
+
+  /// The time at which the averages of every event were last updated.
+  std::array<TimePoint, EVENTS> _last_update;
+};
+
+namespace Lowercase {
+using event = Event;
+using recent_activity = RecentActivity;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_RECENT_ACTIVITY_HPP
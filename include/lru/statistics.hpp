@@ -24,15 +24,22 @@
 #define LRU_STATISTICS_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <iterator>
+#include <random>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <lru/error.hpp>
+#include <lru/heavy-hitters.hpp>
+#include <lru/latency-histogram.hpp>
+#include <lru/internal/optional.hpp>
 #include <lru/internal/utility.hpp>
 #include <lru/key-statistics.hpp>
+#include <lru/recent-activity.hpp>
 
 namespace LRU {
 namespace Internal {
@@ -40,6 +47,19 @@ template <typename>
 class StatisticsMutator;
 }
 
+/// The ways in which statistics can sample accesses.
+enum class Sampling {
+  /// Records every n-th access.
+  Periodic,
+
+  /// Records each access with a probability of 1/n.
+  Random,
+
+  /// Records every access to one in n keys, chosen by hash, so that a key is
+  /// either always or never recorded.
+  ByKey,
+};
+
 /// Stores statistics about LRU cache utilization and efficiency.
 ///
 /// The statistics object stores the number of misses and hits were recorded for
@@ -57,7 +77,18 @@ class Statistics {
   using InitializerList = std::initializer_list<Key>;
 
   /// Constructor.
-  Statistics() noexcept : _total_accesses(0), _total_hits(0) {
+  Statistics() noexcept
+  : _total_accesses(0)
+  , _total_hits(0)
+  , _total_evictions(0)
+  , _total_expirations(0)
+  , _total_erasures(0)
+  , _total_overwrites(0)
+  , _sampling_period(1)
+  , _sampling(Sampling::Periodic)
+  , _hit_countdown(1)
+  , _miss_countdown(1)
+  , _key_threshold(_key_threshold_for(1)) {
   }
 
   /// Constructor.
@@ -125,6 +156,28 @@ class Statistics {
     return 1 - hit_rate();
   }
 
+  /// \returns The total number of keys evicted to make room for new keys (or
+  /// to shrink the cache).
+  size_t total_evictions() const noexcept {
+    return _total_evictions;
+  }
+
+  /// \returns The total number of expired keys cleared from the cache.
+  size_t total_expirations() const noexcept {
+    return _total_expirations;
+  }
+
+  /// \returns The total number of keys erased explicitly.
+  size_t total_erasures() const noexcept {
+    return _total_erasures;
+  }
+
+  /// \returns The total number of insertions that overwrote the value of a
+  /// key already in the cache.
+  size_t total_overwrites() const noexcept {
+    return _total_overwrites;
+  }
+
   /// \returns The number of hits for the given key.
   /// \param key The key to retrieve the hits for.
   /// \throws LRU::UnmonitoredKey if the key was not registered for monitoring.
@@ -230,23 +283,304 @@ class Statistics {
     return !_key_map.empty();
   }
 
+  /// Records only a sample of all accesses in the per-key statistics, the
+  /// recent activity and the heavy hitters.
+  ///
+  /// Recording an access for a monitored key or a heavy hitter costs an extra
+  /// hash lookup, which can be significant relative to the cheap lookup in the
+  /// cache itself. With sampling, only one in `period` accesses is recorded,
+  /// and recorded accesses are counted `period` times, so counts are unbiased
+  /// estimates of the true counts. Hits and misses are sampled independently.
+  /// Changing the period only affects accesses recorded from then on. The
+  /// total hit and miss counts are never sampled.
+  ///
+  /// Periodic and random sampling pick accesses, so which keys are recorded
+  /// depends on the order of accesses. `Sampling::ByKey` instead picks keys by
+  /// hash: the counts of a recorded key are exact (times the period), those of
+  /// the other keys stay zero, and heavy hitters are only found among the
+  /// recorded keys.
+  ///
+  /// \param period The sampling period (1 to record every access).
+  /// \param sampling How to choose the accesses to record.
+  /// \throws LRU::Error::InvalidArgument if the period is zero.
+  void sample(size_t period, Sampling sampling = Sampling::Periodic) {
+    if (period == 0) {
+      throw LRU::Error::InvalidArgument("Sampling period must be positive");
+    }
+
+    _sampling_period = period;
+    _sampling = sampling;
+    _key_threshold = _key_threshold_for(period);
+    _hit_countdown = _next_countdown();
+    _miss_countdown = _next_countdown();
+  }
+
+  /// \returns The sampling period (1 if every access is recorded).
+  size_t sampling_period() const noexcept {
+    return _sampling_period;
+  }
+
+  /// \returns How accesses are sampled.
+  Sampling sampling() const noexcept {
+    return _sampling;
+  }
+
+  /// Starts tracking the recent activity of the cache(s), i.e. hits, misses,
+  /// insertions and evictions over the last seconds.
+  ///
+  /// If recent activity was already tracked, this is a no-op.
+  void track_recent_activity() {
+    if (!_recent) _recent.emplace();
+  }
+
+  /// Stops tracking recent activity.
+  void stop_tracking_recent_activity() {
+    _recent.reset();
+  }
+
+  /// \returns True if recent activity is currently being tracked, else false.
+  bool is_tracking_recent_activity() const noexcept {
+    return static_cast<bool>(_recent);
+  }
+
+  /// \returns The recent activity of the cache(s).
+  /// \throws LRU::Error::NotMonitoring if recent activity is not being
+  /// tracked.
+  const RecentActivity& recent() const {
+    if (!_recent) {
+      throw LRU::Error::NotMonitoring();
+    }
+
+    return *_recent;
+  }
+
+  /// Starts recording the lifetimes of evicted keys.
+  ///
+  /// For every evicted key, its age (time since insertion) and idle time
+  /// (time since its last hit), both in milliseconds, as well as its number of
+  /// hits are recorded in histograms. Many young keys being evicted suggest
+  /// the cache is too small; many keys evicted after long idle times or
+  /// without any hits suggest it holds dead weight. Only caches whose tracking
+  /// policy records lifetimes (such as `LRU::TrackLifetimes`) contribute, and
+  /// keys inserted before lifetimes were tracked are not recorded. If lifetimes
+  /// were already tracked, this is a no-op.
+  void track_lifetimes() {
+    if (_lifetimes.empty()) _lifetimes.resize(LIFETIME_HISTOGRAMS);
+  }
+
+  /// Stops recording lifetimes.
+  void stop_tracking_lifetimes() {
+    _lifetimes.clear();
+    _lifetimes.shrink_to_fit();
+  }
+
+  /// \returns True if lifetimes are currently being recorded, else false.
+  bool is_tracking_lifetimes() const noexcept {
+    return !_lifetimes.empty();
+  }
+
+  /// \returns The histogram of the ages (in milliseconds) of evicted keys.
+  /// \throws LRU::Error::NotMonitoring if lifetimes are not being tracked.
+  const LatencyHistogram& age_at_eviction() const {
+    return _lifetime(AGE);
+  }
+
+  /// \returns The histogram of the idle times (in milliseconds) of evicted
+  /// keys.
+  /// \throws LRU::Error::NotMonitoring if lifetimes are not being tracked.
+  const LatencyHistogram& idle_time_at_eviction() const {
+    return _lifetime(IDLE_TIME);
+  }
+
+  /// \returns The histogram of the number of hits of evicted keys.
+  /// \throws LRU::Error::NotMonitoring if lifetimes are not being tracked.
+  const LatencyHistogram& hits_at_eviction() const {
+    return _lifetime(HITS);
+  }
+
+  /// Starts discovering the keys with the most hits and the most misses.
+  ///
+  /// Unlike monitoring keys, this does not require knowing the keys in
+  /// advance. Each of hits and misses is tracked in a bounded sketch of the
+  /// given capacity (see `HeavyHitters`), which reliably finds every key
+  /// accounting for more than `1 / capacity` of all hits (or misses). If heavy
+  /// hitters were already tracked, they are reset.
+  ///
+  /// \param capacity The number of keys to track for each of hits and misses.
+  void track_heavy_hitters(size_t capacity) {
+    _hot_hits.emplace(capacity);
+    _hot_misses.emplace(capacity);
+  }
+
+  /// Stops discovering heavy hitters.
+  void stop_tracking_heavy_hitters() {
+    _hot_hits.reset();
+    _hot_misses.reset();
+  }
+
+  /// \returns True if heavy hitters are currently being tracked, else false.
+  bool is_tracking_heavy_hitters() const noexcept {
+    return static_cast<bool>(_hot_hits);
+  }
+
+  /// \returns The tracker of the keys with the most hits.
+  /// \throws LRU::Error::NotMonitoring if heavy hitters are not being tracked.
+  const HeavyHitters<Key>& heavy_hits() const {
+    if (!_hot_hits) {
+      throw LRU::Error::NotMonitoring();
+    }
+
+    return *_hot_hits;
+  }
+
+  /// \returns The tracker of the keys with the most misses.
+  /// \throws LRU::Error::NotMonitoring if heavy hitters are not being tracked.
+  const HeavyHitters<Key>& heavy_misses() const {
+    if (!_hot_misses) {
+      throw LRU::Error::NotMonitoring();
+    }
+
+    return *_hot_misses;
+  }
+
+  /// \returns The (at most) `k` keys with the most hits, most hits first.
+  /// \param k The number of keys to return.
+  /// \throws LRU::Error::NotMonitoring if heavy hitters are not being tracked.
+  std::vector<HeavyHitter<Key>> top_hits(size_t k) const {
+    return heavy_hits().top(k);
+  }
+
+  /// \returns The (at most) `k` keys with the most misses, most misses first.
+  /// \param k The number of keys to return.
+  /// \throws LRU::Error::NotMonitoring if heavy hitters are not being tracked.
+  std::vector<HeavyHitter<Key>> top_misses(size_t k) const {
+    return heavy_misses().top(k);
+  }
+
  private:
   template <typename>
   friend class Internal::StatisticsMutator;
 
   using HitMap = std::unordered_map<Key, KeyStatistics>;
 
+  /// The indices of the lifetime histograms.
+  enum LifetimeHistogram { AGE, IDLE_TIME, HITS, LIFETIME_HISTOGRAMS };
+
+  /// \returns The lifetime histogram at the given index.
+  /// \throws LRU::Error::NotMonitoring if lifetimes are not being tracked.
+  const LatencyHistogram& _lifetime(LifetimeHistogram index) const {
+    if (_lifetimes.empty()) {
+      throw LRU::Error::NotMonitoring();
+    }
+
+    return _lifetimes[index];
+  }
+
+  /// Decides whether to record the current access.
+  ///
+  /// Hits and misses are counted down separately, so that periodic sampling
+  /// cannot lock onto a pattern in which hits and misses alternate.
+  ///
+  /// \param countdown The countdown of the kind of the access.
+  /// \param key The key accessed.
+  /// \returns The number of accesses the current access stands for if it is
+  /// to be recorded, else zero.
+  size_t _sample(size_t& countdown, const Key& key) {
+    if (_sampling == Sampling::ByKey) {
+      return _is_sampled(key) ? _sampling_period : 0;
+    }
+
+    if (--countdown > 0) return 0;
+    countdown = _next_countdown();
+    return _sampling_period;
+  }
+
+  /// \returns True if accesses to the key are recorded when sampling by key,
+  /// else false.
+  /// \param key The key to check.
+  bool _is_sampled(const Key& key) const {
+    // Mix the hash, since hashes of integers are often the integers themselves.
+    auto hash = static_cast<std::uint64_t>(_key_map.hash_function()(key));
+    hash *= 0x9E3779B97F4A7C15ull;
+    return (hash >> 32) < _key_threshold;
+  }
+
+  /// \returns The threshold below which mixed hashes are sampled.
+  /// \param period The sampling period.
+  static std::uint64_t _key_threshold_for(size_t period) noexcept {
+    return (std::uint64_t(1) << 32) / period;
+  }
+
+  /// \returns The number of accesses until the next one to record.
+  size_t _next_countdown() {
+    if (_sampling != Sampling::Random || _sampling_period == 1) {
+      return _sampling_period;
+    }
+
+    // The gaps between accesses recorded with probability p are
+    // geometrically distributed, so drawing the gap saves drawing a random
+    // number for every single access.
+    std::geometric_distribution<size_t> gap(1.0 / _sampling_period);
+    return gap(_random) + 1;
+  }
+
   /// The total number of accesses made for any key.
   size_t _total_accesses;
 
   /// The total number of htis made for any key.
   size_t _total_hits;
 
+  /// The total number of keys evicted.
+  size_t _total_evictions;
+
+  /// The total number of expired keys cleared.
+  size_t _total_expirations;
+
+  /// The total number of keys erased explicitly.
+  size_t _total_erasures;
+
+  /// The total number of values overwritten.
+  size_t _total_overwrites;
+
   /// The map to keep track of statistics for monitored keys.
   HitMap _key_map;
+
+  /// The histograms of the age, idle time and hits of evicted keys, if
+  /// lifetimes are tracked (else empty). Kept out of line, since they are
+  /// comparatively large.
+  std::vector<LatencyHistogram> _lifetimes;
+
+  /// The sampling period.
+  size_t _sampling_period;
+
+  /// How accesses are sampled.
+  Sampling _sampling;
+
+  /// The number of hits until the next one to record.
+  size_t _hit_countdown;
+
+  /// The number of misses until the next one to record.
+  size_t _miss_countdown;
+
+  /// The threshold below which mixed key hashes are sampled by key.
+  std::uint64_t _key_threshold;
+
+  /// The random number generator for random sampling.
+  std::minstd_rand _random;
+
+  /// The recent activity, if it is being tracked.
+  Internal::Optional<RecentActivity> _recent;
+
+  /// The keys with the most hits, if heavy hitters are being tracked.
+  Internal::Optional<HeavyHitters<Key>> _hot_hits;
+
+  /// The keys with the most misses, if heavy hitters are being tracked.
+  Internal::Optional<HeavyHitters<Key>> _hot_misses;
 };
 
 namespace Lowercase {
+using sampling = Sampling;
+
 template <typename... Ts>
 using statistics = Statistics<Ts...>;
 }  // namespace Lowercase
@@ -0,0 +1,510 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_STATS_PAGE_HPP
+#define LRU_STATS_PAGE_HPP
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <lru/error.hpp>
+#include <lru/metrics-exporter.hpp>
+
+namespace LRU {
+namespace Internal {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "The stats page requires lock-free 64-bit atomics");
+
+/// The layout of a stats page, shared between the serving process and any
+/// monitoring agents reading it.
+///
+/// The page starts with a header, followed by a fixed number of slots, one
+/// per cache. Every slot is guarded by a sequence lock: the writer makes the
+/// sequence odd before and even again after updating the slot, and readers
+/// retry until they see the same even sequence before and after reading. All
+/// fields are atomics, so torn reads are impossible (just retried).
+namespace StatsPageLayout {
+
+/// The magic bytes at the start of every stats page.
+constexpr char MAGIC[8] = {'L', 'R', 'U', 'S', 'T', 'A', 'T', 'S'};
+
+/// The version of the layout.
+constexpr std::uint32_t VERSION = 1;
+
+/// The maximum length of a cache name (in 64-bit words).
+constexpr std::size_t NAME_WORDS = 6;
+
+/// The maximum length of a cache name (in bytes).
+constexpr std::size_t NAME_LENGTH = NAME_WORDS * sizeof(std::uint64_t);
+
+/// The metrics stored per cache, in order.
+enum Field {
+  SIZE,
+  CAPACITY,
+  IS_MONITORING,
+  HITS,
+  MISSES,
+  EVICTIONS,
+  EXPIRATIONS,
+  ERASURES,
+  OVERWRITES,
+  FIELDS
+};
+
+/// The header of a stats page.
+struct Header {
+  /// The magic bytes.
+  char magic[8];
+
+  /// The version of the layout.
+  std::uint32_t version;
+
+  /// The number of slots.
+  std::uint32_t slots;
+};
+
+/// The slot of a single cache.
+struct Slot {
+  /// The sequence lock (odd while the slot is being written).
+  std::atomic<std::uint64_t> sequence;
+
+  /// The name of the cache, padded with zeros (empty if the slot is free).
+  std::atomic<std::uint64_t> name[NAME_WORDS];
+
+  /// The metrics of the cache.
+  std::atomic<std::uint64_t> fields[FIELDS];
+};
+
+/// \returns The size of a stats page with the given number of slots.
+inline std::size_t size_of(std::size_t slots) noexcept {
+  return sizeof(Header) + slots * sizeof(Slot);
+}
+
+/// \returns The slots of a stats page.
+inline Slot* slots_of(void* page) noexcept {
+  return reinterpret_cast<Slot*>(static_cast<char*>(page) + sizeof(Header));
+}
+
+}  // namespace StatsPageLayout
+
+/// A memory-mapped file, unmapped on destruction.
+class MappedFile {
+ public:
+  /// Constructor.
+  ///
+  /// \param path The path of the file.
+  /// \param size The number of bytes to map (zero for the whole file).
+  /// \param writable Whether to map the file writable (creating it).
+  MappedFile(const std::string& path, std::size_t size, bool writable)
+  : _address(nullptr), _size(size) {
+    const int descriptor =
+        writable ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                 : ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) _fail("open", path);
+
+    struct stat status;
+    if (writable) {
+      if (::ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+        ::close(descriptor);
+        _fail("ftruncate", path);
+      }
+    } else if (::fstat(descriptor, &status) == 0) {
+      _size = static_cast<std::size_t>(status.st_size);
+    }
+
+    const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    auto address =
+        ::mmap(nullptr, _size, protection, MAP_SHARED, descriptor, 0);
+    ::close(descriptor);
+    if (address == MAP_FAILED) _fail("mmap", path);
+
+    _address = address;
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// Destructor, unmapping the file.
+  ~MappedFile() {
+    if (_address) ::munmap(_address, _size);
+  }
+
+  /// \returns The start of the mapping.
+  void* address() const noexcept {
+    return _address;
+  }
+
+  /// \returns The size of the mapping.
+  std::size_t size() const noexcept {
+    return _size;
+  }
+
+ private:
+  /// Throws a system error for the last failed system call.
+  [[noreturn]] static void
+  _fail(const std::string& call, const std::string& path) {
+    throw std::system_error(
+        errno, std::generic_category(), call + " failed for " + path);
+  }
+
+  /// The start of the mapping.
+  void* _address;
+
+  /// The size of the mapping.
+  std::size_t _size;
+};
+
+}  // namespace Internal
+
+/// Publishes the counters of caches into a memory-mapped file.
+///
+/// Exporting metrics from inside a latency-critical process (serving scrape
+/// requests, formatting text) can be avoided altogether by publishing the raw
+/// counters into a stats page instead: a file with a fixed layout (see
+/// `Internal::StatsPageLayout`), mapped into memory. A separate monitoring
+/// agent maps the same file with a `StatsPageReader` and reads the counters
+/// whenever it likes, without any interaction with the serving process. Each
+/// cache's slot is guarded by a sequence lock, so neither side ever blocks.
+///
+/// Caches are registered with `add()`, and `publish()` copies their current
+/// counters into the page (e.g. from a timer, once a second). Registered
+/// caches must outlive the page (or be removed first). The page is not
+/// thread-safe itself; `add()`, `remove()` and `publish()` must be
+/// synchronized externally.
+class StatsPage {
+ public:
+  using size_t = std::size_t;
+
+  /// Constructor, creating (or truncating) the stats page.
+  ///
+  /// The page is first created under a temporary name and then renamed, so
+  /// readers never see a partially initialized page.
+  ///
+  /// \param path The path of the file to publish into.
+  /// \param slots The maximum number of caches.
+  /// \throws std::system_error if the file cannot be created or mapped.
+  explicit StatsPage(const std::string& path, size_t slots = 64)
+  : _file(path + ".tmp", Internal::StatsPageLayout::size_of(slots), true)
+  , _snapshots(slots) {
+    using namespace Internal::StatsPageLayout;
+
+    auto header = new (_file.address()) Header();
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version = VERSION;
+    header->slots = static_cast<std::uint32_t>(slots);
+
+    auto first = slots_of(_file.address());
+    for (size_t index = 0; index < slots; ++index) {
+      auto slot = new (first + index) Slot;
+      slot->sequence.store(0, std::memory_order_relaxed);
+      _write(*slot, std::string(), CacheMetrics());
+    }
+
+    if (std::rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+      throw std::system_error(
+          errno, std::generic_category(), "rename failed for " + path);
+    }
+  }
+
+  StatsPage(const StatsPage&) = delete;
+  StatsPage& operator=(const StatsPage&) = delete;
+
+  /// Registers a cache that is not accessed concurrently with `publish()`.
+  ///
+  /// \param name The name of the cache (at most 48 bytes).
+  /// \param cache The cache to publish.
+  /// \throws LRU::Error::InvalidArgument if the name is empty, too long or
+  /// already taken, or if all slots are taken.
+  template <typename Cache>
+  void add(const std::string& name, const Cache& cache) {
+    _add(name, [&cache] { return Internal::snapshot_metrics(cache); });
+  }
+
+  /// Registers a cache guarded by a lock.
+  ///
+  /// \param name The name of the cache (at most 48 bytes).
+  /// \param cache The cache to publish.
+  /// \param lock The lock guarding the cache (any `BasicLockable`).
+  /// \throws LRU::Error::InvalidArgument if the name is empty, too long or
+  /// already taken, or if all slots are taken.
+  template <typename Cache, typename Lock>
+  void add(const std::string& name, const Cache& cache, Lock& lock) {
+    _add(name, [&cache, &lock] {
+      std::lock_guard<Lock> guard(lock);
+      return Internal::snapshot_metrics(cache);
+    });
+  }
+
+  /// Unregisters a cache, freeing its slot.
+  ///
+  /// \param name The name of the cache.
+  void remove(const std::string& name) {
+    for (size_t index = 0; index < _snapshots.size(); ++index) {
+      if (_snapshots[index].name == name) {
+        _snapshots[index] = Registration();
+        _write(_slot(index), std::string(), CacheMetrics());
+      }
+    }
+  }
+
+  /// Copies the current counters of all registered caches into the page.
+  void publish() {
+    for (size_t index = 0; index < _snapshots.size(); ++index) {
+      const auto& registration = _snapshots[index];
+      if (!registration.snapshot) continue;
+      _write(_slot(index), registration.name, registration.snapshot());
+    }
+  }
+
+  /// \returns The maximum number of caches.
+  size_t slots() const noexcept {
+    return _snapshots.size();
+  }
+
+ private:
+  using Slot = Internal::StatsPageLayout::Slot;
+
+  /// A registered cache.
+  struct Registration {
+    /// The name of the cache.
+    std::string name;
+
+    /// Returns the current metrics of the cache.
+    std::function<CacheMetrics()> snapshot;
+  };
+
+  /// Registers a cache in the first free slot.
+  ///
+  /// \param name The name of the cache.
+  /// \param snapshot Returns the current metrics of the cache.
+  void _add(const std::string& name, std::function<CacheMetrics()> snapshot) {
+    using Internal::StatsPageLayout::NAME_LENGTH;
+    if (name.empty() || name.size() > NAME_LENGTH) {
+      throw LRU::Error::InvalidArgument(
+          "Stats page names must have between 1 and 48 bytes");
+    }
+
+    Registration* free = nullptr;
+    for (auto& registration : _snapshots) {
+      if (registration.name == name) {
+        throw LRU::Error::InvalidArgument("Name already taken: " + name);
+      }
+      if (!free && registration.name.empty()) free = &registration;
+    }
+
+    if (!free) {
+      throw LRU::Error::InvalidArgument("All slots of the stats page taken");
+    }
+
+    free->name = name;
+    free->snapshot = std::move(snapshot);
+    _write(_slot(free - _snapshots.data()), name, free->snapshot());
+  }
+
+  /// \returns The slot at the given index.
+  Slot& _slot(size_t index) noexcept {
+    return Internal::StatsPageLayout::slots_of(_file.address())[index];
+  }
+
+  /// Writes the name and metrics of a cache into a slot.
+  ///
+  /// \param slot The slot to write into.
+  /// \param name The name of the cache.
+  /// \param metrics The metrics of the cache.
+  static void
+  _write(Slot& slot, const std::string& name, const CacheMetrics& metrics) {
+    using namespace Internal::StatsPageLayout;
+
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::uint64_t words[NAME_WORDS] = {};
+    std::memcpy(words, name.data(), name.size());
+    for (size_t word = 0; word < NAME_WORDS; ++word) {
+      slot.name[word].store(words[word], std::memory_order_relaxed);
+    }
+
+    const std::uint64_t fields[FIELDS] = {metrics.size,
+                                          metrics.capacity,
+                                          metrics.is_monitoring,
+                                          metrics.hits,
+                                          metrics.misses,
+                                          metrics.evictions,
+                                          metrics.expirations,
+                                          metrics.erasures,
+                                          metrics.overwrites};
+    for (size_t field = 0; field < FIELDS; ++field) {
+      slot.fields[field].store(fields[field], std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  /// The mapped stats page.
+  Internal::MappedFile _file;
+
+  /// The registered caches, by slot.
+  std::vector<Registration> _snapshots;
+};
+
+/// Reads the counters published into a stats page by another process.
+class StatsPageReader {
+ public:
+  using size_t = std::size_t;
+
+  /// Constructor, mapping the stats page.
+  ///
+  /// \param path The path of the stats page.
+  /// \throws std::system_error if the file cannot be opened or mapped.
+  /// \throws LRU::Error::InvalidArgument if the file is not a stats page.
+  explicit StatsPageReader(const std::string& path) : _file(path, 0, false) {
+    using namespace Internal::StatsPageLayout;
+
+    const auto header = static_cast<const Header*>(_file.address());
+    if (_file.size() < sizeof(Header) ||
+        std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->version != VERSION ||
+        _file.size() < size_of(header->slots)) {
+      throw LRU::Error::InvalidArgument("Not a stats page: " + path);
+    }
+
+    _slots = header->slots;
+  }
+
+  /// Reads a consistent snapshot of every published cache.
+  ///
+  /// \returns The metrics of every cache, by name.
+  std::map<std::string, CacheMetrics> read() const {
+    using namespace Internal::StatsPageLayout;
+
+    std::map<std::string, CacheMetrics> snapshots;
+    const auto slots = slots_of(_file.address());
+
+    for (size_t index = 0; index < _slots; ++index) {
+      std::string name;
+      CacheMetrics metrics;
+      if (_read(slots[index], name, metrics) && !name.empty()) {
+        snapshots.emplace(std::move(name), metrics);
+      }
+    }
+
+    return snapshots;
+  }
+
+  /// \returns The number of slots of the page.
+  size_t slots() const noexcept {
+    return _slots;
+  }
+
+ private:
+  using Slot = Internal::StatsPageLayout::Slot;
+
+  /// The maximum number of attempts to read a slot being written.
+  static constexpr int ATTEMPTS = 1000;
+
+  /// Reads a slot under its sequence lock.
+  ///
+  /// \param slot The slot to read.
+  /// \param name Set to the name of the cache.
+  /// \param metrics Set to the metrics of the cache.
+  /// \returns True if a consistent snapshot was read, false if the slot was
+  /// being written during every attempt (e.g. because the writing process
+  /// died halfway through a write).
+  static bool
+  _read(const Slot& slot, std::string& name, CacheMetrics& metrics) {
+    using namespace Internal::StatsPageLayout;
+
+    for (int attempt = 0; attempt < ATTEMPTS; ++attempt) {
+      if (attempt > 0) std::this_thread::yield();
+
+      const auto before = slot.sequence.load(std::memory_order_acquire);
+      if (before % 2 == 1) continue;
+
+      std::uint64_t words[NAME_WORDS];
+      for (size_t word = 0; word < NAME_WORDS; ++word) {
+        words[word] = slot.name[word].load(std::memory_order_relaxed);
+      }
+
+      std::uint64_t fields[FIELDS];
+      for (size_t field = 0; field < FIELDS; ++field) {
+        fields[field] = slot.fields[field].load(std::memory_order_relaxed);
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+
+      const auto characters = reinterpret_cast<const char*>(words);
+      name.assign(characters, ::strnlen(characters, NAME_LENGTH));
+
+      metrics.size = fields[SIZE];
+      metrics.capacity = fields[CAPACITY];
+      metrics.is_monitoring = fields[IS_MONITORING] != 0;
+      metrics.hits = fields[HITS];
+      metrics.misses = fields[MISSES];
+      metrics.evictions = fields[EVICTIONS];
+      metrics.expirations = fields[EXPIRATIONS];
+      metrics.erasures = fields[ERASURES];
+      metrics.overwrites = fields[OVERWRITES];
+
+      return true;
+    }
+
+    return false;
+  }
+
+  /// The mapped stats page.
+  Internal::MappedFile _file;
+
+  /// The number of slots of the page.
+  size_t _slots;
+};
+
+namespace Lowercase {
+using stats_page = StatsPage;
+using stats_page_reader = StatsPageReader;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // defined(__unix__) || defined(__APPLE__)
+
+#endif  // LRU_STATS_PAGE_HPP
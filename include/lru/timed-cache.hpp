@@ -34,6 +34,7 @@
 #include <utility>
 
 #include <lru/error.hpp>
+#include <lru/hash.hpp>
 #include <lru/internal/base-cache.hpp>
 #include <lru/internal/last-accessed.hpp>
 #include <lru/internal/timed-information.hpp>
@@ -43,13 +44,17 @@ namespace Internal {
 template <typename Key,
           typename Value,
           typename HashFunction,
-          typename KeyEqual>
+          typename KeyEqual,
+          typename Hooks,
+          typename Tracking>
 using TimedCacheBase = BaseCache<Key,
                                  Value,
                                  Internal::TimedInformation,
                                  HashFunction,
                                  KeyEqual,
-                                 Tag::TimedCache>;
+                                 Tag::TimedCache,
+                                 Hooks,
+                                 Tracking>;
 }  // namespace Internal
 
 
@@ -62,18 +67,26 @@ using TimedCacheBase = BaseCache<Key,
 /// the time after which a key in the cache is said to be "expired". Once a key
 /// has expired, the cache will behave as if the key were not present in the
 /// cache at all and, for example, return false on calls to `contains()` or
-/// throw on calls to `lookup()`.
+/// throw on calls to `lookup()`. Overwriting the value of a key (e.g. by
+/// inserting the key again) restarts its time to live.
 ///
 /// \see LRU::Cache
 template <typename Key,
           typename Value,
           typename Duration = std::chrono::duration<double, std::milli>,
-          typename HashFunction = std::hash<Key>,
-          typename KeyEqual = std::equal_to<Key>>
-class TimedCache
-    : public Internal::TimedCacheBase<Key, Value, HashFunction, KeyEqual> {
+          typename HashFunction = DefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Hooks = NoHooks,
+          typename Tracking = NoTracking>
+class TimedCache : public Internal::TimedCacheBase<Key,
+                                                   Value,
+                                                   HashFunction,
+                                                   KeyEqual,
+                                                   Hooks,
+                                                   Tracking> {
  private:
-  using super = Internal::TimedCacheBase<Key, Value, HashFunction, KeyEqual>;
+  using super = Internal::
+      TimedCacheBase<Key, Value, HashFunction, KeyEqual, Hooks, Tracking>;
   using PRIVATE_BASE_CACHE_MEMBERS;
 
  public:
@@ -178,7 +191,7 @@ class TimedCache
   }
 
   /// \copydoc BaseCache::swap
-  void swap(TimedCache& other) noexcept {
+  void swap(TimedCache& other) {
     using std::swap;
 
     super::swap(other);
@@ -189,17 +202,18 @@ class TimedCache
   ///
   /// \param first The first cache to swap.
   /// \param second The second cache to swap.
-  friend void swap(TimedCache& first, TimedCache& second) noexcept {
+  friend void swap(TimedCache& first, TimedCache& second) {
     first.swap(second);
   }
 
   /// \copydoc BaseCache::find(const Key&)
   UnorderedIterator find(const Key& key) override {
+    auto timer = _time(Operation::Find);
     auto iterator = _map.find(key);
     if (iterator != _map.end()) {
       if (!_has_expired(iterator->second)) {
         _register_hit(key, iterator->second.value);
-        _move_to_front(iterator->second.order);
+        _promote(iterator->second);
         _last_accessed = iterator;
         return {*this, iterator};
       }
@@ -212,11 +226,12 @@ class TimedCache
 
   /// \copydoc BaseCache::find(const Key&) const
   UnorderedConstIterator find(const Key& key) const override {
+    auto timer = _time(Operation::Find);
     auto iterator = _map.find(key);
     if (iterator != _map.end()) {
       if (!_has_expired(iterator->second)) {
         _register_hit(key, iterator->second.value);
-        _move_to_front(iterator->second.order);
+        _promote(iterator->second);
         _last_accessed = iterator;
         return {*this, iterator};
       }
@@ -250,6 +265,7 @@ class TimedCache
     // Either way, in the worst case the entire cache has expired and
     // we would have to do O(N) erasures.
 
+    auto timer = _time(Operation::ClearExpired);
     if (is_empty()) return 0;
 
     auto iterator = _order.begin();
@@ -262,6 +278,7 @@ class TimedCache
       // after will not have, so we can stop.
       if (!_has_expired(map_iterator->second)) break;
 
+      _register_expiration();
       _erase(map_iterator);
 
       iterator = _order.begin();
@@ -338,6 +355,19 @@ class TimedCache
  private:
   using Clock = Internal::Clock;
 
+  /// Moves the key to the front of the order and assigns a new value.
+  ///
+  /// Since the value is fresh, the key's time to live restarts. Otherwise,
+  /// overwriting an expired key (which is still in the map) would store a
+  /// value that has already expired.
+  ///
+  /// \param iterator The iterator pointing to the key to move.
+  /// \param new_value The updated value to move the key with.
+  void _move_to_front(MapIterator iterator, const Value& new_value) override {
+    iterator->second.insertion_time = Clock::now();
+    super::_move_to_front(iterator, new_value);
+  }
+
   /// \returns True if the last accessed object is valid.
   /// \details Next to performing the base cache's action, this method also
   /// checks for expiration of the last accessed key.
@@ -0,0 +1,77 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#ifndef LRU_TRACKING_HPP
+#define LRU_TRACKING_HPP
+
+namespace LRU {
+
+/// The default tracking policy of a cache, which keeps no per-key bookkeeping.
+///
+/// Every key of a cache stores its value and its place in the order, nothing
+/// more. Features that need to know more about each key (such as the time of
+/// its last access) are enabled by passing another tracking policy to `Cache`
+/// or `TimedCache` as a `Tracking` template parameter, so that caches which do
+/// not use these features do not pay for them in memory.
+struct NoTracking {
+  /// Whether keys are stamped on every access, as needed to join a
+  /// `MemoryArbiter`.
+  static constexpr bool accesses = false;
+
+  /// Whether keys remember their insertion time, last hit and number of hits,
+  /// as needed for statistics to record the lifetimes of evicted keys.
+  static constexpr bool lifetimes = false;
+};
+
+/// A tracking policy stamping every access to a key.
+///
+/// Caches with this policy can join a `MemoryArbiter`, at the cost of eight
+/// bytes per key.
+struct TrackAccesses {
+  static constexpr bool accesses = true;
+  static constexpr bool lifetimes = false;
+};
+
+/// A tracking policy recording the lifetime of every key.
+///
+/// Caches with this policy feed their statistics' lifetime histograms (see
+/// `Statistics::track_lifetimes()`), at the cost of about 24 bytes per key.
+struct TrackLifetimes {
+  static constexpr bool accesses = false;
+  static constexpr bool lifetimes = true;
+};
+
+/// A tracking policy combining `TrackAccesses` and `TrackLifetimes`.
+struct TrackAll {
+  static constexpr bool accesses = true;
+  static constexpr bool lifetimes = true;
+};
+
+namespace Lowercase {
+using no_tracking = NoTracking;
+using track_accesses = TrackAccesses;
+using track_lifetimes = TrackLifetimes;
+using track_all = TrackAll;
+}  // namespace Lowercase
+
+}  // namespace LRU
+
+#endif  // LRU_TRACKING_HPP
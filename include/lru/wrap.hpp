@@ -22,16 +22,428 @@
 #ifndef LRU_WRAP_HPP
 #define LRU_WRAP_HPP
 
+#include <chrono>
 #include <cstddef>
+#include <exception>
+#include <functional>
 #include <tuple>
 #include <type_traits>
 #include <utility>
 
 #include <lru/cache.hpp>
 #include <lru/internal/hash.hpp>
+#include <lru/internal/optional.hpp>
 #include <lru/internal/utility.hpp>
+#include <lru/statistics.hpp>
+#include <lru/timed-cache.hpp>
 
 namespace LRU {
+namespace Internal {
+
+/// The default key projection of `MemoizedFunction`, which uses the tuple of
+/// all arguments as the key.
+///
+/// \tparam Arguments The tuple of (decayed) argument types.
+template <typename Arguments>
+struct TupleProjection {
+  template <typename... Ts>
+  Arguments operator()(const Ts&... arguments) const {
+    return Arguments(arguments...);
+  }
+};
+
+/// Determines the key type a projection produces from a function's arguments.
+///
+/// \tparam Projection The type of the projection.
+/// \tparam Arguments The tuple of (decayed) argument types.
+template <typename Projection, typename Arguments>
+struct ProjectedKey;
+
+template <typename Projection, typename... Ts>
+struct ProjectedKey<Projection, std::tuple<Ts...>> {
+  using type = std::decay_t<decltype(
+      std::declval<const Projection&>()(std::declval<const Ts&>()...))>;
+};
+
+}  // namespace Internal
+
+/// A key projection for `LRU::wrap`, created with `LRU::key_by`.
+///
+/// \tparam Projection The type of the projection function.
+template <typename Projection>
+struct KeyProjection {
+  /// The function computing the cache key from the arguments.
+  Projection projection;
+};
+
+/// Makes `LRU::wrap` key its cache by the result of a projection of the
+/// arguments, rather than by all arguments.
+///
+/// The projection is called with the arguments as const references and must
+/// return a hashable key that determines the result of the function. The full
+/// arguments are only passed on to the function on a miss.
+///
+/// ```cpp
+/// auto render = LRU::wrap(render_page,
+///                         LRU::key_by([](const Request& r) { return r.id; }));
+/// ```
+///
+/// \param projection The function computing the key from the arguments.
+/// \returns A `KeyProjection` to pass to `LRU::wrap`.
+template <typename Projection>
+KeyProjection<Projection> key_by(Projection projection) {
+  return {std::move(projection)};
+}
+
+/// A function with its own LRU cache, as returned by `LRU::wrap`.
+///
+/// Calls whose arguments were seen before are answered from the cache, all
+/// others are forwarded to the original function and their result is
+/// inserted. Every instance owns its cache, which lives exactly as long as the
+/// instance and can be inspected and controlled through `cache()` and the
+/// convenience methods below.
+///
+/// \tparam Function The type of the wrapped function.
+/// \tparam CacheType The type of the cache, mapping keys to the (decayed)
+///                   return type.
+/// \tparam Projection The type of the function computing keys from the
+///                    arguments. By default, keys are tuples of all
+///                    (decayed) arguments.
+template <typename Function,
+          typename CacheType,
+          typename Projection = Internal::TupleProjection<
+              typename Internal::FunctionTraits<Function>::Arguments>>
+class MemoizedFunction {
+ public:
+  using Traits = Internal::FunctionTraits<Function>;
+  using ArgumentTypes = typename Traits::Arguments;
+  using Key = typename Internal::ProjectedKey<Projection, ArgumentTypes>::type;
+  using ReturnType = std::decay_t<typename Traits::ReturnType>;
+  using ErrorPredicate = std::function<bool(const ReturnType&)>;
+
+  static_assert(!std::is_void<ReturnType>::value,
+                "Return type of wrapped function must not be void");
+
+  /// Constructor.
+  ///
+  /// \param function The function to wrap.
+  /// \param projection The function computing keys from the arguments.
+  /// \param args Any arguments to forward to the constructor of the cache.
+  template <typename... Args>
+  MemoizedFunction(Function function, Projection projection, Args&&... args)
+  : _function(std::move(function))
+  , _projection(std::move(projection))
+  , _cache(std::forward<Args>(args)...) {
+  }
+
+  /// Calls the function, or returns the cached result of an earlier call with
+  /// the same arguments.
+  ///
+  /// \param arguments The arguments to call the function with.
+  /// \returns The result of the function.
+  template <typename... Arguments>
+  ReturnType operator()(Arguments&&... arguments) {
+    Key key = _projection(arguments...);
+    auto iterator = _cache.find(key);
+
+    if (iterator != _cache.end()) {
+      return iterator->second;
+    }
+
+    if (auto error = _recent_error(key)) {
+      return *error;
+    }
+
+    const auto start = _start_measuring();
+    auto value = _call(key, std::forward<Arguments>(arguments)...);
+    if (auto error = _register_error(key, value)) {
+      return *error;
+    }
+
+    if (_admits(start)) {
+      _cache.emplace(std::move(key), value);
+    }
+
+    return value;
+  }
+
+  /// Like the call operator, but returns a reference to the cached result
+  /// instead of a copy, and moves a newly computed result into the cache.
+  ///
+  /// Use this for functions returning large objects, where copying the result
+  /// would be most of the cost of a hit. The reference is only guaranteed to
+  /// stay valid until the next call to (or modification of) the memoized
+  /// function, since the entry may then be evicted.
+  ///
+  /// \param arguments The arguments to call the function with.
+  /// \returns A reference to the result of the function.
+  template <typename... Arguments>
+  const ReturnType& reference(Arguments&&... arguments) {
+    Key key = _projection(arguments...);
+    auto iterator = _cache.find(key);
+
+    if (iterator != _cache.end()) {
+      return iterator->second;
+    }
+
+    if (auto error = _recent_error(key)) {
+      return *error;
+    }
+
+    const auto start = _start_measuring();
+    auto value = _call(key, std::forward<Arguments>(arguments)...);
+    if (auto error = _register_error(key, value)) {
+      return *error;
+    }
+
+    // Without capacity (or when the result is not admitted), the value has to
+    // be kept alive here instead.
+    if (!_admits(start) || _cache.capacity() == 0) {
+      _uncached.emplace(std::move(value));
+      return *_uncached;
+    }
+
+    auto result = _cache.emplace(std::move(key), std::move(value));
+    return result.iterator()->second;
+  }
+
+  /// \returns The cache of the function.
+  CacheType& cache() noexcept {
+    return _cache;
+  }
+
+  /// \returns The cache of the function.
+  const CacheType& cache() const noexcept {
+    return _cache;
+  }
+
+  /// \returns The statistics of the cache.
+  /// \throws LRU::Error::NotMonitoring if the cache is not monitoring (see
+  /// `cache().monitor()`).
+  const Statistics<Key>& stats() const {
+    return _cache.stats();
+  }
+
+  /// Starts caching exceptions thrown by the function.
+  ///
+  /// Normally, nothing is cached when the function throws, so a failing input
+  /// is retried on every call. With error caching, the exception is stored in
+  /// a separate timed cache and rethrown for calls with the same key until its
+  /// (usually short) time to live has expired. Failing inputs are thus retried
+  /// at a bounded rate, which protects whatever the function calls into.
+  ///
+  /// \param time_to_live How long to remember an error.
+  /// \param capacity The maximum number of errors to remember.
+  template <typename Duration>
+  void cache_errors(const Duration& time_to_live,
+                    std::size_t capacity = Internal::DEFAULT_CAPACITY) {
+    _errors.emplace(time_to_live, capacity);
+    _is_error = nullptr;
+  }
+
+  /// Starts caching exceptions as well as results that represent errors.
+  ///
+  /// Results for which the predicate returns true (e.g. an `expected` holding
+  /// an error) are stored along with exceptions in the error cache, with its
+  /// time to live, instead of in the regular cache.
+  ///
+  /// \param is_error A predicate returning true for results that are errors.
+  /// \param time_to_live How long to remember an error.
+  /// \param capacity The maximum number of errors to remember.
+  /// \see cache_errors()
+  template <typename Predicate, typename Duration>
+  void cache_error_results(Predicate is_error,
+                           const Duration& time_to_live,
+                           std::size_t capacity = Internal::DEFAULT_CAPACITY) {
+    cache_errors(time_to_live, capacity);
+    _is_error = std::move(is_error);
+  }
+
+  /// Stops caching errors and forgets all cached errors.
+  void stop_caching_errors() {
+    _errors.reset();
+    _is_error = nullptr;
+  }
+
+  /// \returns True if errors are cached, else false.
+  bool is_caching_errors() const noexcept {
+    return _errors.has_value();
+  }
+
+  /// \returns The number of errors currently remembered.
+  std::size_t cached_errors() const noexcept {
+    return _errors ? _errors->size() : 0;
+  }
+
+  /// Only caches results that took at least the given time to compute.
+  ///
+  /// Functions are often cheap for most inputs and expensive for a few.
+  /// Caching every result then wastes capacity on entries that save nothing.
+  /// With an admission threshold, the wall time of every call to the original
+  /// function is measured, and only results that were slower than the
+  /// threshold are inserted into the cache.
+  ///
+  /// \param threshold The minimum time a call must take for its result to be
+  ///                  cached. Zero admits all results (the default).
+  template <typename Duration>
+  void admit_if_slower_than(const Duration& threshold) {
+    _admission_threshold =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(threshold);
+  }
+
+  /// Caches all results again, regardless of their cost.
+  void admit_all() noexcept {
+    _admission_threshold = std::chrono::nanoseconds::zero();
+  }
+
+  /// \returns The admission threshold (zero if all results are admitted).
+  std::chrono::nanoseconds admission_threshold() const noexcept {
+    return _admission_threshold;
+  }
+
+  /// \returns The number of results not cached because they were computed
+  /// faster than the admission threshold.
+  std::size_t rejected_admissions() const noexcept {
+    return _rejected_admissions;
+  }
+
+  /// Forgets all cached results and errors.
+  void clear() {
+    _cache.clear();
+    if (_errors) _errors->clear();
+  }
+
+  /// \returns The capacity of the cache.
+  std::size_t capacity() const noexcept {
+    return _cache.capacity();
+  }
+
+  /// Sets the capacity of the cache.
+  ///
+  /// \param new_capacity The new capacity.
+  void capacity(std::size_t new_capacity) {
+    _cache.capacity(new_capacity);
+  }
+
+ private:
+  /// An error remembered for a key: either an exception or an error result.
+  struct Failure {
+    bool operator==(const Failure& other) const {
+      return exception == other.exception && result == other.result;
+    }
+
+    bool operator!=(const Failure& other) const {
+      return !(*this == other);
+    }
+
+    /// The exception thrown, if any.
+    std::exception_ptr exception;
+
+    /// The error result returned, if no exception was thrown.
+    Internal::Optional<ReturnType> result;
+  };
+
+  using ErrorCache = TimedCache<Key, Failure>;
+
+  using Clock = std::chrono::steady_clock;
+
+  /// \returns The current time if results are admitted by cost, else a
+  /// default-constructed time point (to avoid reading the clock).
+  Clock::time_point _start_measuring() const {
+    if (_admission_threshold == std::chrono::nanoseconds::zero()) return {};
+    return Clock::now();
+  }
+
+  /// Decides whether to cache a result computed since the given time.
+  ///
+  /// \param start The time the computation started.
+  /// \returns True if the result should be cached, else false.
+  bool _admits(Clock::time_point start) {
+    if (_admission_threshold == std::chrono::nanoseconds::zero()) return true;
+    if (Clock::now() - start >= _admission_threshold) return true;
+
+    _rejected_admissions += 1;
+    return false;
+  }
+
+  /// Looks up a recent error for the key, rethrowing it if it was an
+  /// exception.
+  ///
+  /// \param key The key to look up.
+  /// \returns The error result for the key, or `nullptr` if there is none.
+  const ReturnType* _recent_error(const Key& key) {
+    if (!_errors) return nullptr;
+
+    auto iterator = _errors->find(key);
+    if (iterator == _errors->end()) return nullptr;
+
+    const auto& error = iterator->second;
+    if (error.exception) std::rethrow_exception(error.exception);
+
+    return &*error.result;
+  }
+
+  /// Calls the function, remembering any exception it throws if errors are
+  /// cached.
+  ///
+  /// \param key The key of the call.
+  /// \param arguments The arguments to call the function with.
+  /// \returns The result of the function.
+  template <typename... Arguments>
+  ReturnType _call(const Key& key, Arguments&&... arguments) {
+    if (!_errors) return _function(std::forward<Arguments>(arguments)...);
+
+    try {
+      return _function(std::forward<Arguments>(arguments)...);
+    } catch (...) {
+      _errors->emplace(key, Failure{std::current_exception(), {}});
+      throw;
+    }
+  }
+
+  /// Remembers a result in the error cache if it represents an error.
+  ///
+  /// \param key The key of the call.
+  /// \param value The result of the call.
+  /// \returns The remembered error result, or `nullptr` if the result is not
+  /// an error.
+  const ReturnType* _register_error(const Key& key, const ReturnType& value) {
+    if (!_is_error || !_is_error(value)) return nullptr;
+
+    if (_errors->capacity() == 0) {
+      _uncached.emplace(value);
+      return &*_uncached;
+    }
+
+    auto result = _errors->emplace(key, Failure{nullptr, value});
+    return &*result.iterator()->second.result;
+  }
+
+  /// The wrapped function.
+  Function _function;
+
+  /// The function computing keys from the arguments.
+  Projection _projection;
+
+  /// The cache of results, keyed by arguments.
+  CacheType _cache;
+
+  /// The last result that could not be cached (see `reference()`).
+  Internal::Optional<ReturnType> _uncached;
+
+  /// The cache of recent errors, if errors are cached.
+  Internal::Optional<ErrorCache> _errors;
+
+  /// The predicate identifying error results, if any.
+  ErrorPredicate _is_error;
+
+  /// The minimum time a call must take for its result to be cached.
+  std::chrono::nanoseconds _admission_threshold =
+      std::chrono::nanoseconds::zero();
+
+  /// The number of results not cached because they were too cheap.
+  std::size_t _rejected_admissions = 0;
+};
 
 /// Wraps a function with a "shallow" LRU cache.
 ///
@@ -40,42 +452,55 @@ namespace LRU {
 /// that recursive calls to the same function are not cached, since those
 /// will call the original function symbol, not the wrapped one.
 ///
+/// The argument and return types are deduced from the function, which must
+/// thus not be overloaded or a generic lambda. Each returned function owns a
+/// separate cache.
+///
 /// \tparam CacheType The cache template class to use.
 /// \param original_function The function to wrap.
 /// \param args Any arguments to forward to the cache.
-/// \returns A new function with a shallow LRU cache.
+/// \returns A `MemoizedFunction` wrapping the original function.
 template <typename Function,
           template <typename...> class CacheType = Cache,
           typename... Args>
 auto wrap(Function original_function, Args&&... args) {
-  return [
-    original_function,
-    cache_args = std::forward_as_tuple(std::forward<Args>(args)...)
-  ](auto&&... arguments) mutable {
-    using Arguments = std::tuple<std::decay_t<decltype(arguments)>...>;
-    using ReturnType = decltype(
-        original_function(std::forward<decltype(arguments)>(arguments)...));
-
-    static_assert(!std::is_void<ReturnType>::value,
-                  "Return type of wrapped function must not be void");
-
-    static auto cache =
-        Internal::construct_from_tuple<CacheType<Arguments, ReturnType>>(
-            cache_args);
-
-    auto key = std::make_tuple(arguments...);
-    auto iterator = cache.find(key);
+  using Traits = Internal::FunctionTraits<Function>;
+  using Arguments = typename Traits::Arguments;
+  using ReturnType = std::decay_t<typename Traits::ReturnType>;
+  using Projection = Internal::TupleProjection<Arguments>;
+  using Memoized =
+      MemoizedFunction<Function, CacheType<Arguments, ReturnType>, Projection>;
 
-    if (iterator != cache.end()) {
-      return iterator->second;
-    }
+  return Memoized(std::move(original_function),
+                  Projection(),
+                  std::forward<Args>(args)...);
+}
 
-    auto value =
-        original_function(std::forward<decltype(arguments)>(arguments)...);
-    cache.emplace(key, value);
+/// Wraps a function with a "shallow" LRU cache keyed by a projection of the
+/// arguments.
+///
+/// \tparam CacheType The cache template class to use.
+/// \param original_function The function to wrap.
+/// \param key The projection computing cache keys (see `LRU::key_by`).
+/// \param args Any arguments to forward to the cache.
+/// \returns A `MemoizedFunction` wrapping the original function.
+template <typename Function,
+          template <typename...> class CacheType = Cache,
+          typename Projection,
+          typename... Args>
+auto wrap(Function original_function,
+          KeyProjection<Projection> key,
+          Args&&... args) {
+  using Traits = Internal::FunctionTraits<Function>;
+  using Arguments = typename Traits::Arguments;
+  using Key = typename Internal::ProjectedKey<Projection, Arguments>::type;
+  using ReturnType = std::decay_t<typename Traits::ReturnType>;
+  using Memoized =
+      MemoizedFunction<Function, CacheType<Key, ReturnType>, Projection>;
 
-    return value;
-  };
+  return Memoized(std::move(original_function),
+                  std::move(key.projection),
+                  std::forward<Args>(args)...);
 }
 
 /// Wraps a function with a "shallow" LRU timed cache.
@@ -86,14 +511,49 @@ auto wrap(Function original_function, Args&&... args) {
 /// will call the original function symbol, not the wrapped one.
 ///
 /// \param original_function The function to wrap.
+/// \param duration The time to live of cached results.
 /// \param args Any arguments to forward to the cache.
-/// \returns A new function with a shallow LRU cache.
+/// \returns A `MemoizedFunction` wrapping the original function.
 template <typename Function, typename Duration, typename... Args>
 auto timed_wrap(Function original_function, Duration duration, Args&&... args) {
   return wrap<Function, TimedCache>(
       original_function, duration, std::forward<Args>(args)...);
 }
 
+/// Wraps a function with a "shallow" LRU timed cache keyed by a projection of
+/// the arguments.
+///
+/// The projection may be passed before or after the time to live, i.e.
+/// `timed_wrap(f, ttl, key_by(...))` is the same as
+/// `timed_wrap(f, key_by(...), ttl)`.
+///
+/// \param original_function The function to wrap.
+/// \param duration The time to live of cached results.
+/// \param key The projection computing cache keys (see `LRU::key_by`).
+/// \param args Any further arguments to forward to the cache.
+/// \returns A `MemoizedFunction` wrapping the original function.
+template <typename Function,
+          typename Duration,
+          typename Projection,
+          typename... Args>
+auto timed_wrap(Function original_function,
+                Duration duration,
+                KeyProjection<Projection> key,
+                Args&&... args) {
+  return wrap<Function, TimedCache>(original_function,
+                                    std::move(key),
+                                    duration,
+                                    std::forward<Args>(args)...);
+}
+
+namespace Lowercase {
+template <typename Projection>
+using key_projection = KeyProjection<Projection>;
+
+template <typename... Ts>
+using memoized_function = MemoizedFunction<Ts...>;
+}  // namespace Lowercase
+
 }  //  namespace LRU
 
 #endif  // LRU_WRAP_HPP
@@ -0,0 +1,188 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <cstddef>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+struct ApproximateCacheTest : public ::testing::Test {
+  ApproximateCache<int, int> cache;
+};
+
+TEST_F(ApproximateCacheTest, ContainsAfterInsertion) {
+  ASSERT_TRUE(cache.is_empty());
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(cache.insert(i, i * i));
+    EXPECT_EQ(cache.size(), i + 1);
+    EXPECT_TRUE(cache.contains(i));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(cache[i], i * i);
+  }
+}
+
+TEST_F(ApproximateCacheTest, InsertUpdatesExistingKeys) {
+  EXPECT_TRUE(cache.insert(1, 1));
+  EXPECT_FALSE(cache.insert(1, 2));
+  EXPECT_FALSE(cache.emplace(1, 3));
+
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.lookup(1), 3);
+}
+
+TEST_F(ApproximateCacheTest, LookupThrowsForMissingKeys) {
+  EXPECT_THROW(cache.lookup(1), LRU::Error::KeyNotFound);
+  cache.insert(1, 1);
+  cache.erase(1);
+  EXPECT_THROW(cache.lookup(1), LRU::Error::KeyNotFound);
+}
+
+TEST_F(ApproximateCacheTest, NeverExceedsCapacity) {
+  cache.capacity(10);
+
+  for (int i = 0; i < 1000; ++i) {
+    cache.insert(i, i);
+    ASSERT_LE(cache.size(), 10);
+    ASSERT_TRUE(cache.contains(i));
+  }
+
+  EXPECT_TRUE(cache.is_full());
+}
+
+TEST_F(ApproximateCacheTest, EvictsKeysThatWereNotUsedRecently) {
+  cache.capacity(100);
+  for (int i = 0; i < 100; ++i) {
+    cache.insert(i, i);
+  }
+
+  // Keep half of the keys hot while streaming through new keys.
+  for (int i = 100; i < 150; ++i) {
+    for (int hot = 0; hot < 50; ++hot) {
+      cache.contains(hot);
+    }
+    cache.insert(i, i);
+  }
+
+  std::size_t hot_keys_left = 0;
+  for (int hot = 0; hot < 50; ++hot) {
+    hot_keys_left += cache.contains(hot);
+  }
+
+  // With perfect LRU, all hot keys would remain. The approximation should come
+  // very close to that.
+  EXPECT_GE(hot_keys_left, 45);
+}
+
+TEST_F(ApproximateCacheTest, WorksWithCapacityOfOne) {
+  ApproximateCache<std::string, int> small(1);
+
+  small.insert("one", 1);
+  small.insert("two", 2);
+
+  EXPECT_EQ(small.size(), 1);
+  EXPECT_FALSE(small.contains("one"));
+  EXPECT_TRUE(small.contains("two"));
+}
+
+TEST_F(ApproximateCacheTest, ShrinkingAndCapacityEvict) {
+  for (int i = 0; i < 100; ++i) {
+    cache.insert(i, i);
+  }
+
+  cache.shrink(50);
+  EXPECT_EQ(cache.size(), 50);
+
+  cache.capacity(10);
+  EXPECT_EQ(cache.size(), 10);
+  EXPECT_EQ(cache.capacity(), 10);
+
+  cache.shrink(0);
+  EXPECT_TRUE(cache.is_empty());
+}
+
+TEST_F(ApproximateCacheTest, CopiesAreIndependent) {
+  cache.capacity(10);
+  for (int i = 0; i < 10; ++i) {
+    cache.insert(i, i);
+  }
+
+  auto copy = cache;
+  for (int i = 10; i < 100; ++i) {
+    copy.insert(i, i);
+  }
+
+  EXPECT_EQ(copy.size(), 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(cache.lookup(i), i);
+  }
+}
+
+TEST_F(ApproximateCacheTest, RegistersStatistics) {
+  cache.monitor(1);
+
+  cache.insert(1, 1);
+  cache.contains(1);
+  cache.contains(2);
+  cache.lookup(1);
+
+  EXPECT_EQ(cache.stats().total_accesses(), 3);
+  EXPECT_EQ(cache.stats().total_hits(), 2);
+  EXPECT_EQ(cache.stats().hits_for(1), 2);
+
+  cache.insert(1, 2);
+  cache.capacity(2);
+  for (int i = 2; i <= 4; ++i) {
+    cache.insert(i, i);
+  }
+  cache.erase(4);
+
+  EXPECT_EQ(cache.stats().total_overwrites(), 1);
+  EXPECT_EQ(cache.stats().total_evictions(), 2);
+  EXPECT_EQ(cache.stats().total_erasures(), 1);
+}
+
+TEST_F(ApproximateCacheTest, ScansDoNotFlushTheCache) {
+  cache.capacity(100);
+  for (int i = 0; i < 100; ++i) {
+    cache.insert(i, i);
+  }
+
+  {
+    auto guard = cache.scan();
+    for (int i = 100; i < 1000; ++i) {
+      cache.insert(i, i);
+    }
+  }
+
+  std::size_t original_keys_left = 0;
+  for (int i = 0; i < 100; ++i) {
+    original_keys_left += cache.contains(i);
+  }
+
+  EXPECT_GE(original_keys_left, 95);
+}
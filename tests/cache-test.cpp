@@ -127,8 +127,14 @@ TEST(CacheConstructionTest, UsesCustomHashFunction) {
 
   EXPECT_EQ(mock_hash_call_count, 0);
 
-  cache.contains(5);
-  EXPECT_EQ(mock_hash_call_count, 1);
+  cache.insert(5, 1);
+  EXPECT_GT(mock_hash_call_count, 0);
+
+  // libstdc++ may scan an empty table without hashing, so only count
+  // lookups once the cache holds a key (and not the last accessed one).
+  const auto calls_after_insert = mock_hash_call_count;
+  ASSERT_FALSE(cache.contains(6));
+  EXPECT_EQ(mock_hash_call_count, calls_after_insert + 1);
 }
 
 TEST(CacheConstructionTest, UsesCustomKeyEqual) {
@@ -543,3 +549,56 @@ TEST_F(CacheTest, LookupsMoveElementsToFront) {
   EXPECT_EQ(cache.front(), "one");
   EXPECT_EQ(cache.back(), "three");
 }
+
+TEST_F(CacheTest, ScanHitsDoNotMoveElementsToFront) {
+  cache.capacity(2);
+  cache.insert({{"one", 1}, {"two", 2}});
+
+  auto iterator = cache.find("one", AccessHint::Scan);
+  ASSERT_NE(iterator, cache.end());
+  EXPECT_EQ(iterator->value(), 1);
+  EXPECT_EQ(cache.back(), "one");
+
+  cache.emplace("three", 3);
+
+  EXPECT_FALSE(cache.contains("one"));
+  EXPECT_TRUE(cache.contains("two"));
+  EXPECT_TRUE(cache.contains("three"));
+}
+
+TEST_F(CacheTest, ScanInsertionsDoNotFlushTheCache) {
+  cache.capacity(3);
+  cache.insert({{"one", 1}, {"two", 2}});
+
+  {
+    auto guard = cache.scan();
+    EXPECT_TRUE(cache.is_scanning());
+
+    for (int i = 0; i < 100; ++i) {
+      cache.insert(std::to_string(100 + i), i);
+      ASSERT_EQ(cache.back(), std::to_string(100 + i));
+    }
+  }
+
+  EXPECT_FALSE(cache.is_scanning());
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache.back(), "199");
+
+  // Outside of the scan, insertions go to the front again.
+  cache.insert("new", 0, AccessHint::Normal);
+  EXPECT_EQ(cache.front(), "new");
+
+  EXPECT_TRUE(cache.contains("one"));
+  EXPECT_TRUE(cache.contains("two"));
+  EXPECT_FALSE(cache.contains("199"));
+}
+
+TEST_F(CacheTest, ScanUpdatesDoNotMoveElementsToFront) {
+  cache.insert({{"one", 1}, {"two", 2}});
+
+  cache.insert("one", 3, AccessHint::Scan);
+
+  EXPECT_EQ(cache.back(), "one");
+  EXPECT_EQ(cache.front(), "two");
+  EXPECT_EQ(cache.lookup("one"), 3);
+}
@@ -20,6 +20,11 @@
 /// IN THE SOFTWARE.
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -153,3 +158,150 @@ TEST_F(CallbackTest, CallbacksAreNotCalledAfterBeingCleared) {
   ASSERT_EQ(miss, 1);
   ASSERT_EQ(access, 2);
 }
+
+namespace {
+struct CountingHooks : public NoHooks {
+  template <typename Key, typename Value>
+  void hit(const Key&, const Value&) noexcept {
+    hits += 1;
+  }
+
+  template <typename Key>
+  void miss(const Key&) noexcept {
+    misses += 1;
+  }
+
+  int hits = 0;
+  int misses = 0;
+};
+}  // namespace
+
+TEST(CallbackHooksTest, HooksGetCalledOnCache) {
+  Cache<int, int, std::hash<int>, std::equal_to<int>, CountingHooks> cache;
+
+  cache.emplace(0, 0);
+  cache.contains(0);
+  cache.find(0);
+  cache.find(1);
+
+  EXPECT_EQ(cache.hooks().hits, 2);
+  EXPECT_EQ(cache.hooks().misses, 1);
+}
+
+TEST(CallbackHooksTest, HooksGetCalledOnTimedCache) {
+  using Duration = std::chrono::duration<double, std::milli>;
+  TimedCache<int,
+             int,
+             Duration,
+             std::hash<int>,
+             std::equal_to<int>,
+             CountingHooks>
+      cache(std::chrono::seconds(1));
+
+  cache.emplace(0, 0);
+  cache.contains(0);
+  cache.contains(1);
+  cache.find(2);
+
+  EXPECT_EQ(cache.hooks().hits, 1);
+  EXPECT_EQ(cache.hooks().misses, 2);
+}
+
+TEST(CallbackHooksTest, HooksAndCallbacksAreBothCalled) {
+  Cache<int, int, std::hash<int>, std::equal_to<int>, CountingHooks> cache;
+  int hit = 0, miss = 0;
+  cache.hit_callback([&hit](auto&, auto&) { hit += 1; });
+  cache.miss_callback([&miss](auto&) { miss += 1; });
+
+  cache.emplace(0, 0);
+  cache.contains(0);
+  cache.find(1);
+
+  EXPECT_EQ(hit, 1);
+  EXPECT_EQ(miss, 1);
+  EXPECT_EQ(cache.hooks().hits, 1);
+  EXPECT_EQ(cache.hooks().misses, 1);
+
+  cache.clear_all_callbacks();
+  cache.contains(0);
+
+  EXPECT_EQ(hit, 1);
+  EXPECT_EQ(cache.hooks().hits, 2);
+}
+
+TEST_F(CallbackTest, AsynchronousCallbacksGetCalledOnAnotherThread) {
+  std::vector<int> hits, misses;
+  std::thread::id thread;
+  cache.hit_callback([&](auto& key, auto& value) {
+    hits.push_back(key + value);
+    thread = std::this_thread::get_id();
+  });
+  cache.miss_callback([&misses](auto& key) { misses.push_back(key); });
+
+  cache.dispatch_callbacks_asynchronously();
+  ASSERT_TRUE(cache.is_dispatching_callbacks_asynchronously());
+
+  cache.emplace(1, 10);
+  cache.contains(1);
+  cache.find(2);
+  cache.find(1);
+
+  cache.flush_callbacks();
+
+  EXPECT_EQ(hits, std::vector<int>({11, 11}));
+  EXPECT_EQ(misses, std::vector<int>({2}));
+  EXPECT_NE(thread, std::this_thread::get_id());
+  EXPECT_EQ(cache.dropped_callback_events(), 0);
+}
+
+TEST_F(CallbackTest, GoingBackToSynchronousDispatchDeliversPendingEvents) {
+  int access = 0;
+  cache.access_callback([&access](auto&, bool) { access += 1; });
+
+  cache.dispatch_callbacks_asynchronously();
+  for (int i = 0; i < 100; ++i) {
+    cache.contains(i);
+  }
+  cache.dispatch_callbacks_synchronously();
+
+  EXPECT_FALSE(cache.is_dispatching_callbacks_asynchronously());
+  EXPECT_EQ(access, 100);
+
+  cache.contains(0);
+  EXPECT_EQ(access, 101);
+}
+
+TEST_F(CallbackTest, AsynchronousDispatchDropsEventsWhenTheQueueIsFull) {
+  std::atomic<bool> blocked(true);
+  std::atomic<int> misses(0);
+  cache.miss_callback([&](auto&) {
+    while (blocked) std::this_thread::yield();
+    misses += 1;
+  });
+
+  cache.dispatch_callbacks_asynchronously(4);
+  for (int i = 0; i < 100; ++i) {
+    cache.contains(i);
+  }
+  blocked = false;
+  cache.flush_callbacks();
+
+  EXPECT_GT(cache.dropped_callback_events(), 0);
+  EXPECT_EQ(misses + cache.dropped_callback_events(), 100);
+}
+
+TEST_F(CallbackTest, CopiedCacheDispatchesSynchronously) {
+  int hit = 0;
+  cache.hit_callback([&hit](auto&, auto&) { hit += 1; });
+  cache.dispatch_callbacks_asynchronously();
+  cache.emplace(0, 0);
+
+  auto other = cache;
+  ASSERT_FALSE(other.is_dispatching_callbacks_asynchronously());
+  other.contains(0);
+  EXPECT_EQ(hit, 1);
+
+  cache.contains(0);
+  cache.flush_callbacks();
+  EXPECT_EQ(hit, 2);
+}
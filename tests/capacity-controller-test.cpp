@@ -0,0 +1,146 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <cstddef>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+struct CapacityControllerTest : public ::testing::Test {
+  CapacityControllerTest() : first(10), second(10), controller(20, 1.0) {
+    controller.manage(first);
+    controller.manage(second);
+  }
+
+  // Loops over the given number of keys, inserting keys on misses.
+  template <typename Cache>
+  void loop(Cache& cache, int keys, int rounds = 5) {
+    for (int round = 0; round < rounds; ++round) {
+      for (int key = 0; key < keys; ++key) {
+        if (!cache.contains(key)) cache.insert(key, key);
+      }
+    }
+  }
+
+  // The caches must outlive the controller.
+  Cache<int, int> first;
+  Cache<int, int> second;
+  CapacityController controller;
+};
+
+TEST_F(CapacityControllerTest, ManagesCaches) {
+  EXPECT_EQ(controller.managed(), 2);
+  EXPECT_EQ(controller.budget(), 20);
+  EXPECT_EQ(controller.allocated(), 20);
+}
+
+TEST_F(CapacityControllerTest, MovesCapacityToCachesWithHigherMarginalGain) {
+  for (int i = 0; i < 3; ++i) {
+    // One more slot would turn all misses of the first cache into hits, while
+    // the second cache does not need all of its slots.
+    loop(first, first.capacity() + 1);
+    loop(second, 5);
+    controller.rebalance();
+  }
+
+  EXPECT_GT(first.capacity(), 10);
+  EXPECT_LT(second.capacity(), 10);
+  EXPECT_EQ(controller.allocated(), 20);
+}
+
+TEST_F(CapacityControllerTest, DoesNotTradeWithoutMarginalGain) {
+  loop(first, 5);
+  loop(second, 5);
+  controller.rebalance();
+
+  EXPECT_EQ(first.capacity(), 10);
+  EXPECT_EQ(second.capacity(), 10);
+}
+
+TEST_F(CapacityControllerTest, GrowsIntoFreeBudget) {
+  controller.budget(30);
+
+  loop(first, 11);
+  loop(second, 5);
+  controller.rebalance();
+
+  EXPECT_EQ(first.capacity(), 11);
+  EXPECT_EQ(second.capacity(), 10);
+}
+
+TEST_F(CapacityControllerTest, ShrinksCachesToFitTheBudget) {
+  loop(first, 10);
+  loop(second, 5);
+
+  controller.budget(12);
+  controller.rebalance();
+
+  EXPECT_LE(controller.allocated(), 12);
+  EXPECT_GE(first.capacity(), 1);
+  EXPECT_GE(second.capacity(), 1);
+}
+
+TEST_F(CapacityControllerTest, RespectsMinimumCapacities) {
+  Cache<int, int> cache(10);
+  CapacityController other(4, 1.0);
+  other.manage(cache, 1, 8);
+
+  other.rebalance();
+  EXPECT_EQ(cache.capacity(), 8);
+}
+
+TEST_F(CapacityControllerTest, RemovesAccessCallbacksWhenDestroyed) {
+  Cache<int, int> cache(10);
+  cache.access_callback([](const int&, bool) {});
+
+  {
+    CapacityController other(10, 1.0);
+    other.manage(cache);
+    EXPECT_EQ(cache.access_callbacks().size(), 2);
+
+    CapacityController moved(std::move(other));
+    EXPECT_EQ(moved.managed(), 1);
+  }
+
+  EXPECT_EQ(cache.access_callbacks().size(), 1);
+}
+
+TEST_F(CapacityControllerTest, RebalancesUnderAsynchronousDispatch) {
+  first.dispatch_callbacks_asynchronously(1 << 12);
+  controller.budget(30);
+
+  // Rebalancing races with the dispatcher thread feeding the simulation.
+  for (int i = 0; i < 10; ++i) {
+    loop(first, 11);
+    controller.rebalance();
+  }
+
+  first.flush_callbacks();
+  loop(first, first.capacity() + 1);
+  first.flush_callbacks();
+  controller.rebalance();
+
+  EXPECT_GT(first.capacity(), 10);
+  EXPECT_LE(controller.allocated(), 30);
+}
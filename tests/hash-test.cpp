@@ -0,0 +1,172 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+namespace {
+struct CopyCounter {
+  static std::size_t copies;
+
+  CopyCounter() = default;
+  CopyCounter(const CopyCounter&) {
+    copies += 1;
+  }
+
+  bool operator==(const CopyCounter&) const {
+    return true;
+  }
+};
+
+std::size_t CopyCounter::copies = 0;
+}  // namespace
+
+namespace std {
+template <>
+struct hash<CopyCounter> {
+  std::size_t operator()(const CopyCounter&) const {
+    return 42;
+  }
+};
+}  // namespace std
+
+TEST(HashTest, TupleHashDoesNotCopyElements) {
+  std::tuple<CopyCounter, int, CopyCounter> tuple;
+  CopyCounter::copies = 0;
+
+  std::hash<decltype(tuple)>{}(tuple);
+
+  EXPECT_EQ(CopyCounter::copies, 0);
+}
+
+TEST(HashTest, TupleHashIsDeterministic) {
+  auto tuple = std::make_tuple(1, std::string("two"), 3.0);
+  std::hash<decltype(tuple)> hash;
+
+  EXPECT_EQ(hash(tuple), hash(std::make_tuple(1, std::string("two"), 3.0)));
+}
+
+TEST(HashTest, TupleHashDependsOnOrder) {
+  std::hash<std::tuple<int, int>> hash;
+  EXPECT_NE(hash(std::make_tuple(1, 2)), hash(std::make_tuple(2, 1)));
+}
+
+TEST(HashTest, SmallIntegerTuplesDoNotCollide) {
+  std::hash<std::tuple<int, int, int>> hash;
+  std::unordered_set<std::size_t> hashes;
+
+  for (int i = 0; i < 32; ++i) {
+    for (int j = 0; j < 32; ++j) {
+      for (int k = 0; k < 32; ++k) {
+        hashes.insert(hash(std::make_tuple(i, j, k)));
+      }
+    }
+  }
+
+  EXPECT_EQ(hashes.size(), 32 * 32 * 32);
+}
+
+TEST(HashTest, SmallIntegerTuplesSpreadOverLowBits) {
+  std::hash<std::tuple<int, int>> hash;
+  std::unordered_set<std::size_t> buckets;
+
+  for (int i = 0; i < 16; ++i) {
+    for (int j = 0; j < 16; ++j) {
+      buckets.insert(hash(std::make_tuple(i, j)) & 1023);
+    }
+  }
+
+  // 256 keys thrown into 1024 buckets should occupy most of 256 buckets.
+  EXPECT_GT(buckets.size(), 200);
+}
+
+TEST(HashTest, FastIntegerHashSpreadsStridedKeys) {
+  Hash<int> hash;
+  std::unordered_set<std::size_t> buckets;
+
+  // Multiples of 1024 all land in bucket zero under an identity hash.
+  for (int i = 0; i < 256; ++i) {
+    buckets.insert(hash(i * 1024) & 1023);
+  }
+
+  EXPECT_GT(buckets.size(), 200);
+}
+
+TEST(HashTest, FastStringHashDistinguishesStringsOfAllLengths) {
+  Hash<std::string> hash;
+  std::unordered_set<std::size_t> hashes;
+
+  std::string string;
+  for (int length = 0; length < 100; ++length) {
+    hashes.insert(hash(string));
+    for (char c = 'a'; c <= 'z'; ++c) {
+      hashes.insert(hash(string + c));
+    }
+    string += 'x';
+  }
+
+  EXPECT_EQ(hashes.size(), 100 + 100 * 26 - 99);
+}
+
+TEST(HashTest, FastStringHashOnlyDependsOnContents) {
+  Hash<std::string> hash;
+  std::string first(40, 'a'), second(40, 'a');
+
+  EXPECT_EQ(hash(first), hash(second));
+  second[39] = 'b';
+  EXPECT_NE(hash(first), hash(second));
+  second[39] = 'a';
+  second[0] = 'b';
+  EXPECT_NE(hash(first), hash(second));
+}
+
+TEST(HashTest, FastHashFallsBackToStdHash) {
+  EXPECT_EQ(Hash<CopyCounter>{}(CopyCounter()), 42);
+  EXPECT_EQ(Hash<double>{}(1.5), std::hash<double>{}(1.5));
+}
+
+TEST(HashTest, FastTupleHashDoesNotCopyElements) {
+  std::tuple<CopyCounter, std::string> tuple;
+  CopyCounter::copies = 0;
+
+  Hash<decltype(tuple)>{}(tuple);
+
+  EXPECT_EQ(CopyCounter::copies, 0);
+}
+
+TEST(HashTest, CachesUseTheFastHashByDefault) {
+  Cache<std::string, int> cache;
+  EXPECT_TRUE((std::is_same<decltype(cache.hash_function()),
+                            Hash<std::string>>::value));
+
+  cache.emplace("key", 1);
+  EXPECT_TRUE(cache.contains("key"));
+}
@@ -0,0 +1,155 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <cstddef>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+TEST(HeavyHittersTest, CountsExactlyWhileBelowCapacity) {
+  HeavyHitters<std::string> hitters(3);
+  hitters.record("a");
+  hitters.record("b");
+  hitters.record("a");
+
+  EXPECT_EQ(hitters.size(), 2);
+  EXPECT_EQ(hitters.total(), 3);
+  EXPECT_EQ(hitters.count("a"), 2);
+  EXPECT_EQ(hitters.count("b"), 1);
+  EXPECT_EQ(hitters.count("c"), 0);
+
+  auto top = hitters.top(5);
+  ASSERT_EQ(top.size(), 2);
+  EXPECT_EQ(top[0].key, "a");
+  EXPECT_EQ(top[0].count, 2);
+  EXPECT_EQ(top[0].error, 0);
+  EXPECT_EQ(top[1].key, "b");
+}
+
+TEST(HeavyHittersTest, NewKeysReplaceTheLeastFrequentKey) {
+  HeavyHitters<int> hitters(2);
+  hitters.record(1);
+  hitters.record(1);
+  hitters.record(2);
+  hitters.record(3);
+
+  EXPECT_FALSE(hitters.contains(2));
+  EXPECT_TRUE(hitters.contains(3));
+  EXPECT_EQ(hitters.count(3), 2);
+
+  auto top = hitters.top(2);
+  EXPECT_EQ(top[1].key, 3);
+  EXPECT_EQ(top[1].error, 1);
+  EXPECT_EQ(top[1].guaranteed(), 1);
+}
+
+TEST(HeavyHittersTest, RecordsWeightedOccurrences) {
+  HeavyHitters<int> hitters(2);
+  hitters.record(1, 5);
+  hitters.record(2);
+  hitters.record(2, 3);
+  hitters.record(3, 2);
+
+  EXPECT_EQ(hitters.total(), 11);
+  EXPECT_EQ(hitters.count(1), 5);
+  EXPECT_FALSE(hitters.contains(2));
+  EXPECT_EQ(hitters.count(3), 6);
+
+  auto top = hitters.top(2);
+  EXPECT_EQ(top[0].key, 3);
+  EXPECT_EQ(top[0].error, 4);
+  EXPECT_EQ(top[1].key, 1);
+}
+
+TEST(HeavyHittersTest, FindsFrequentKeysInALongTail) {
+  HeavyHitters<int> hitters(16);
+
+  // Three hot keys among many cold ones.
+  for (int round = 0; round < 1000; ++round) {
+    hitters.record(-1);
+    hitters.record(-2);
+    if (round % 2 == 0) hitters.record(-3);
+    hitters.record(round);
+    hitters.record(round + 100000);
+  }
+
+  auto top = hitters.top(3);
+  ASSERT_EQ(top.size(), 3);
+  EXPECT_EQ(top[2].key, -3);
+  EXPECT_GE(top[0].guaranteed(), 900);
+  EXPECT_LE(top[2].error, hitters.total() / hitters.capacity());
+  EXPECT_EQ(hitters.size(), 16);
+}
+
+TEST(HeavyHittersTest, CopiesAreIndependent) {
+  HeavyHitters<int> hitters(4);
+  hitters.record(1);
+
+  auto copy = hitters;
+  copy.record(1);
+  copy.record(2);
+
+  EXPECT_EQ(hitters.count(1), 1);
+  EXPECT_EQ(copy.count(1), 2);
+  EXPECT_EQ(copy.top(1)[0].key, 1);
+
+  hitters.clear();
+  EXPECT_EQ(hitters.size(), 0);
+  EXPECT_EQ(hitters.total(), 0);
+}
+
+TEST(HeavyHittersTest, ThrowsForZeroCapacity) {
+  EXPECT_THROW(HeavyHitters<int>(0), Error::InvalidArgument);
+}
+
+TEST(HeavyHittersTest, StatisticsDiscoverHotHitsAndMisses) {
+  Cache<int, int> cache(8);
+  cache.monitor();
+  EXPECT_THROW(cache.stats().top_hits(1), Error::NotMonitoring);
+
+  cache.stats().track_heavy_hitters(4);
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+
+  for (int i = 0; i < 10; ++i) {
+    cache.find(1);
+    cache.find(i % 2 == 0 ? 2 : 1);
+    cache.find(42);
+  }
+
+  auto hits = cache.stats().top_hits(2);
+  ASSERT_EQ(hits.size(), 2);
+  EXPECT_EQ(hits[0].key, 1);
+  EXPECT_EQ(hits[0].count, 15);
+  EXPECT_EQ(hits[1].key, 2);
+
+  auto misses = cache.stats().top_misses(1);
+  ASSERT_EQ(misses.size(), 1);
+  EXPECT_EQ(misses[0].key, 42);
+  EXPECT_EQ(misses[0].count, 10);
+
+  cache.stats().stop_tracking_heavy_hitters();
+  EXPECT_FALSE(cache.stats().is_tracking_heavy_hitters());
+}
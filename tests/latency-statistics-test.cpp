@@ -0,0 +1,169 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+TEST(LatencyHistogramTest, SmallValuesHaveExactBuckets) {
+  for (LatencyHistogram::Nanoseconds value = 0; value < 32; ++value) {
+    const auto bucket = LatencyHistogram::bucket_for(value);
+    EXPECT_EQ(LatencyHistogram::upper_bound_of(bucket), value);
+  }
+}
+
+TEST(LatencyHistogramTest, BucketsBoundTheirValues) {
+  for (LatencyHistogram::Nanoseconds value = 1; value < (1ull << 36);
+       value = value * 3 + 1) {
+    const auto bucket = LatencyHistogram::bucket_for(value);
+    const auto upper = LatencyHistogram::upper_bound_of(bucket);
+    EXPECT_GE(upper, value);
+    // Relative error is bounded by the sub-bucket resolution.
+    EXPECT_LE(upper - value, value / 16);
+  }
+}
+
+TEST(LatencyHistogramTest, HugeValuesAreClamped) {
+  const auto bucket = LatencyHistogram::bucket_for(~0ull);
+  EXPECT_EQ(bucket, LatencyHistogram::BUCKETS - 1);
+}
+
+TEST(LatencyHistogramTest, ComputesPercentiles) {
+  LatencyHistogram histogram;
+  for (LatencyHistogram::Nanoseconds value = 1; value <= 100; ++value) {
+    histogram.record(value * 1000);
+  }
+
+  EXPECT_EQ(histogram.count(), 100);
+  EXPECT_EQ(histogram.max(), 100000);
+  EXPECT_NEAR(histogram.percentile(0.5), 50000, 50000 / 16);
+  EXPECT_NEAR(histogram.percentile(0.99), 99000, 99000 / 16);
+  EXPECT_NEAR(histogram.mean(), 50500, 1);
+}
+
+TEST(LatencyHistogramTest, MergesHistograms) {
+  LatencyHistogram first, second;
+  first.record(10, 3);
+  second.record(20, 1);
+
+  first.merge(second);
+
+  EXPECT_EQ(first.count(), 4);
+  EXPECT_EQ(first.max(), 20);
+  EXPECT_EQ(first.percentile(0.75), 10);
+  EXPECT_EQ(first.percentile(1), 20);
+
+  first.reset();
+  EXPECT_EQ(first.count(), 0);
+  EXPECT_EQ(first.percentile(0.5), 0);
+}
+
+TEST(LatencyStatisticsTest, MergesShardsOfAllThreads) {
+  LatencyStatistics statistics;
+
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < 4; ++thread) {
+    threads.emplace_back([&statistics] {
+      for (std::size_t i = 0; i < 1000; ++i) {
+        statistics.record(Operation::Find, 10);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  statistics.record(Operation::Insert, 5);
+
+  EXPECT_EQ(statistics.histogram(Operation::Find).count(), 4000);
+  EXPECT_EQ(statistics.percentile(Operation::Find, 0.5), 10);
+  EXPECT_EQ(statistics.histogram(Operation::Insert).count(), 1);
+  EXPECT_EQ(statistics.histogram(Operation::Erase).count(), 0);
+
+  statistics.reset();
+  EXPECT_EQ(statistics.histogram(Operation::Find).count(), 0);
+}
+
+TEST(LatencyStatisticsTest, ThreadsShareShardsBeyondTheShardCount) {
+  LatencyStatistics statistics;
+  const auto thread_count = 3 * LatencyStatistics::SHARDS;
+
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < thread_count; ++thread) {
+    threads.emplace_back([&statistics] {
+      for (std::size_t i = 0; i < 1000; ++i) {
+        statistics.record(Operation::Find, 10);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(statistics.histogram(Operation::Find).count(), 1000 * thread_count);
+}
+
+TEST(LatencyStatisticsTest, CachesRecordTheirOperations) {
+  Cache<int, int> cache(2);
+  EXPECT_FALSE(cache.is_monitoring_latency());
+  EXPECT_THROW(cache.latency(), LRU::Error::NotMonitoring);
+
+  cache.monitor_latency();
+  EXPECT_TRUE(cache.is_monitoring_latency());
+
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  cache.emplace(3, 3);
+  cache.contains(1);
+  cache.find(2);
+  cache.erase(3);
+
+  const auto& latency = cache.latency();
+  EXPECT_EQ(latency.histogram(Operation::Insert).count(), 2);
+  EXPECT_EQ(latency.histogram(Operation::Emplace).count(), 1);
+  EXPECT_EQ(latency.histogram(Operation::Evict).count(), 1);
+  EXPECT_EQ(latency.histogram(Operation::Find).count(), 2);
+  EXPECT_EQ(latency.histogram(Operation::Erase).count(), 1);
+
+  cache.stop_monitoring_latency();
+  cache.insert(4, 4);
+  EXPECT_FALSE(cache.is_monitoring_latency());
+}
+
+TEST(LatencyStatisticsTest, CachesCanShareLatencyStatistics) {
+  auto latency = std::make_shared<LatencyStatistics>();
+
+  Cache<int, int> first;
+  TimedCache<int, int> second(std::chrono::seconds(1));
+  first.monitor_latency(latency);
+  second.monitor_latency(latency);
+
+  first.insert(1, 1);
+  second.insert(1, 1);
+  second.clear_expired();
+
+  EXPECT_EQ(latency->histogram(Operation::Insert).count(), 2);
+  EXPECT_EQ(latency->histogram(Operation::ClearExpired).count(), 1);
+  EXPECT_EQ(first.shared_latency(), latency);
+}
@@ -0,0 +1,213 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <cstddef>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+struct LfuCacheTest : public ::testing::Test {
+  LfuCache<int, int> cache{3};
+};
+
+TEST_F(LfuCacheTest, ContainsAfterInsertion) {
+  ASSERT_TRUE(cache.is_empty());
+
+  EXPECT_TRUE(cache.insert(1, 1));
+  EXPECT_TRUE(cache.emplace(2, 4));
+  EXPECT_FALSE(cache.insert(1, 2));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache[1], 2);
+  EXPECT_EQ(cache[2], 4);
+  EXPECT_THROW(cache.lookup(3), LRU::Error::KeyNotFound);
+}
+
+TEST_F(LfuCacheTest, CountsAccesses) {
+  cache.insert(1, 1);
+  EXPECT_EQ(cache.frequency(1), 1);
+
+  cache.contains(1);
+  cache.lookup(1);
+  cache.insert(1, 2);
+  EXPECT_EQ(cache.frequency(1), 4);
+
+  EXPECT_THROW(cache.frequency(2), LRU::Error::KeyNotFound);
+}
+
+TEST_F(LfuCacheTest, EvictsLeastFrequentlyUsedKeys) {
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  cache.insert(3, 3);
+
+  cache.contains(1);
+  cache.contains(1);
+  cache.contains(3);
+
+  cache.insert(4, 4);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(3));
+  EXPECT_TRUE(cache.contains(4));
+}
+
+TEST_F(LfuCacheTest, BreaksTiesByRecency) {
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  cache.insert(3, 3);
+
+  cache.contains(2);
+  cache.contains(1);
+  cache.contains(3);
+
+  cache.insert(4, 4);
+  EXPECT_FALSE(cache.contains(2));
+}
+
+TEST_F(LfuCacheTest, FrequentKeysSurviveScans) {
+  cache.insert(1, 1);
+  for (int i = 0; i < 5; ++i) {
+    cache.contains(1);
+  }
+
+  for (int i = 100; i < 200; ++i) {
+    cache.insert(i, i);
+  }
+
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(199));
+}
+
+TEST_F(LfuCacheTest, DecayHalvesCounts) {
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  for (int i = 0; i < 7; ++i) {
+    cache.contains(1);
+  }
+  cache.contains(2);
+
+  cache.decay();
+  EXPECT_EQ(cache.frequency(1), 4);
+  EXPECT_EQ(cache.frequency(2), 1);
+
+  cache.decay();
+  cache.decay();
+  EXPECT_EQ(cache.frequency(1), 1);
+  EXPECT_EQ(cache.frequency(2), 1);
+
+  // Merged buckets keep the previously more frequent keys last.
+  cache.insert(3, 3);
+  cache.insert(4, 4);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(1));
+}
+
+TEST_F(LfuCacheTest, PeriodicDecayAdaptsToPopularityShifts) {
+  cache.decay_period(20);
+  EXPECT_EQ(cache.decay_period(), 20);
+
+  cache.insert(1, 1);
+  for (int i = 0; i < 50; ++i) {
+    cache.contains(1);
+  }
+
+  // Without decay, the count would be 51.
+  EXPECT_LT(cache.frequency(1), 40);
+
+  cache.insert(2, 2);
+  cache.insert(3, 3);
+  for (int i = 0; i < 100; ++i) {
+    cache.contains(2);
+    cache.contains(3);
+  }
+
+  cache.insert(4, 4);
+  EXPECT_FALSE(cache.contains(1));
+}
+
+TEST_F(LfuCacheTest, ShrinkingEvictsLeastFrequentlyUsedKeys) {
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  cache.insert(3, 3);
+  cache.contains(3);
+
+  cache.capacity(1);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_TRUE(cache.contains(3));
+}
+
+TEST_F(LfuCacheTest, EraseAndClearWork) {
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+
+  EXPECT_TRUE(cache.erase(1));
+  EXPECT_FALSE(cache.erase(1));
+  EXPECT_FALSE(cache.contains(1));
+
+  cache.clear();
+  EXPECT_TRUE(cache.is_empty());
+
+  cache.insert(3, 3);
+  EXPECT_EQ(cache.frequency(3), 1);
+}
+
+TEST_F(LfuCacheTest, CopiesAreIndependent) {
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  cache.contains(2);
+
+  auto copy = cache;
+  copy.contains(1);
+  copy.contains(1);
+  copy.insert(3, 3);
+  copy.insert(4, 4);
+
+  EXPECT_FALSE(copy.contains(3));
+  EXPECT_EQ(copy.frequency(1), 3);
+  EXPECT_EQ(cache.frequency(1), 1);
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST_F(LfuCacheTest, MonitorsStatistics) {
+  cache.monitor();
+  cache.insert(1, 1);
+
+  cache.contains(1);
+  cache.contains(2);
+
+  EXPECT_EQ(cache.stats().total_hits(), 1);
+  EXPECT_EQ(cache.stats().total_misses(), 1);
+
+  cache.insert(1, 2);
+  cache.capacity(2);
+  for (int i = 2; i <= 4; ++i) {
+    cache.insert(i, i);
+  }
+  cache.erase(4);
+
+  EXPECT_EQ(cache.stats().total_overwrites(), 1);
+  EXPECT_EQ(cache.stats().total_evictions(), 2);
+  EXPECT_EQ(cache.stats().total_erasures(), 1);
+}
@@ -0,0 +1,128 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+TEST(MemoizeTest, RecursiveCallsGoThroughTheCache) {
+  std::size_t call_count = 0;
+  auto fibonacci =
+      memoize<long(int)>([&call_count](auto& self, int n) -> long {
+        call_count += 1;
+        return n < 2 ? n : self(n - 1) + self(n - 2);
+      });
+
+  EXPECT_EQ(fibonacci(50), 12586269025);
+  EXPECT_EQ(call_count, 51);
+
+  EXPECT_EQ(fibonacci(50), 12586269025);
+  EXPECT_EQ(call_count, 51);
+  EXPECT_TRUE(fibonacci.cache().contains(std::make_tuple(25)));
+}
+
+TEST(MemoizeTest, CanPassArgumentsToTheCache) {
+  auto fibonacci = memoize<long(int)>(
+      [](auto& self, int n) -> long {
+        return n < 2 ? n : self(n - 1) + self(n - 2);
+      },
+      3);
+
+  EXPECT_EQ(fibonacci.cache().capacity(), 3);
+  EXPECT_EQ(fibonacci(40), 102334155);
+  EXPECT_EQ(fibonacci.cache().size(), 3);
+}
+
+TEST(MemoizeTest, CanMemoizeMultipleArguments) {
+  std::size_t call_count = 0;
+  auto edit_distance = memoize<int(const std::string&, const std::string&)>(
+      [&call_count](auto& self, const std::string& a, const std::string& b) {
+        call_count += 1;
+        if (a.empty()) return static_cast<int>(b.size());
+        if (b.empty()) return static_cast<int>(a.size());
+
+        const auto a_tail = a.substr(1), b_tail = b.substr(1);
+        if (a[0] == b[0]) return self(a_tail, b_tail);
+
+        return 1 + std::min({self(a_tail, b), self(a, b_tail),
+                             self(a_tail, b_tail)});
+      },
+      1024);
+
+  EXPECT_EQ(edit_distance("kitten", "sitting"), 3);
+  EXPECT_LE(call_count, 7 * 8);
+}
+
+TEST(MemoizeTest, DenseTableMemoizesIntegerArguments) {
+  std::size_t call_count = 0;
+  auto fibonacci =
+      memoize_dense<long(int)>([&call_count](auto& self, int n) -> long {
+        call_count += 1;
+        return n < 2 ? n : self(n - 1) + self(n - 2);
+      }, 64);
+
+  EXPECT_EQ(fibonacci(50), 12586269025);
+  EXPECT_EQ(call_count, 51);
+  EXPECT_EQ(fibonacci.cache().size(), 51);
+  EXPECT_EQ(fibonacci.cache().capacity(), 64);
+
+  fibonacci.clear();
+  EXPECT_TRUE(fibonacci.cache().is_empty());
+}
+
+TEST(MemoizeTest, DenseTableComputesArgumentsOutOfRange) {
+  std::size_t call_count = 0;
+  auto identity = memoize_dense<int(int)>([&call_count](auto&, int n) {
+    call_count += 1;
+    return n;
+  }, 4);
+
+  EXPECT_EQ(identity(-1), -1);
+  EXPECT_EQ(identity(-1), -1);
+  EXPECT_EQ(identity(10), 10);
+  EXPECT_EQ(call_count, 3);
+
+  EXPECT_EQ(identity(3), 3);
+  EXPECT_EQ(identity(3), 3);
+  EXPECT_EQ(call_count, 4);
+}
+
+TEST(DenseTableTest, StoresValuesByIndex) {
+  DenseTable<std::string> table(3);
+
+  EXPECT_EQ(table.find(1), nullptr);
+  table.insert(1, "one");
+  table.insert(1, "uno");
+  table.insert(5, "five");
+
+  ASSERT_NE(table.find(1), nullptr);
+  EXPECT_EQ(*table.find(1), "uno");
+  EXPECT_TRUE(table.contains(1));
+  EXPECT_FALSE(table.contains(5));
+  EXPECT_FALSE(table.contains(-1));
+  EXPECT_EQ(table.size(), 1);
+}
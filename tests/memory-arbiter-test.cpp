@@ -0,0 +1,210 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+using namespace std::chrono_literals;
+
+namespace {
+using ArbitratedCache = Cache<int,
+                              int,
+                              DefaultHash<int>,
+                              std::equal_to<int>,
+                              NoHooks,
+                              TrackAccesses>;
+using ArbitratedTimedCache = TimedCache<int,
+                                        int,
+                                        std::chrono::milliseconds,
+                                        DefaultHash<int>,
+                                        std::equal_to<int>,
+                                        NoHooks,
+                                        TrackAccesses>;
+}  // namespace
+
+struct MemoryArbiterTest : public ::testing::Test {
+  MemoryArbiterTest() : arbiter(4), first(10), second(10) {
+    first.arbitrate(arbiter);
+    second.arbitrate(arbiter);
+  }
+
+  MemoryArbiter arbiter;
+  ArbitratedCache first;
+  ArbitratedCache second;
+};
+
+TEST_F(MemoryArbiterTest, CachesJoinAndLeaveTheArbiter) {
+  EXPECT_EQ(arbiter.members(), 2);
+  EXPECT_TRUE(first.is_arbitrated());
+
+  first.stop_arbitration();
+  EXPECT_FALSE(first.is_arbitrated());
+  EXPECT_EQ(arbiter.members(), 1);
+
+  {
+    ArbitratedCache temporary;
+    temporary.arbitrate(arbiter);
+    EXPECT_EQ(arbiter.members(), 2);
+  }
+
+  EXPECT_EQ(arbiter.members(), 1);
+}
+
+TEST_F(MemoryArbiterTest, CopiesAreNotArbitrated) {
+  auto copy = first;
+  EXPECT_FALSE(copy.is_arbitrated());
+  EXPECT_EQ(arbiter.members(), 2);
+}
+
+TEST_F(MemoryArbiterTest, EvictsOldestTailAcrossCaches) {
+  first.insert(1, 1);
+  second.insert(2, 2);
+  first.insert(3, 3);
+  second.insert(4, 4);
+  EXPECT_EQ(arbiter.weight(), 4);
+
+  // Key 1 is the least recently used key of both caches.
+  second.insert(5, 5);
+  EXPECT_EQ(arbiter.weight(), 4);
+  EXPECT_FALSE(first.contains(1));
+  EXPECT_EQ(second.size(), 3);
+
+  // Hits refresh keys, so key 2 is now the oldest.
+  ASSERT_TRUE(first.contains(3));
+  first.insert(6, 6);
+  EXPECT_FALSE(second.contains(2));
+  EXPECT_EQ(first.size(), 2);
+}
+
+TEST_F(MemoryArbiterTest, RespectsWeightsPerEntry) {
+  MemoryArbiter other(10);
+  ArbitratedCache heavy(10);
+  ArbitratedCache light(10);
+  heavy.arbitrate(other, 4);
+  light.arbitrate(other, 1);
+
+  heavy.insert(1, 1);
+  heavy.insert(2, 2);
+  light.insert(3, 3);
+  light.insert(4, 4);
+  EXPECT_EQ(other.weight(), 10);
+
+  light.insert(5, 5);
+  EXPECT_EQ(heavy.size(), 1);
+  EXPECT_EQ(light.size(), 3);
+  EXPECT_EQ(other.weight(), 7);
+}
+
+TEST_F(MemoryArbiterTest, OwnCapacityStillApplies) {
+  ArbitratedCache small(1);
+  small.arbitrate(arbiter);
+
+  first.insert(1, 1);
+  small.insert(2, 2);
+  small.insert(3, 3);
+
+  EXPECT_TRUE(first.contains(1));
+  EXPECT_EQ(small.size(), 1);
+  EXPECT_EQ(arbiter.weight(), 2);
+}
+
+TEST_F(MemoryArbiterTest, LoweringTheBudgetEvicts) {
+  for (int i = 0; i < 4; ++i) {
+    first.insert(i, i);
+  }
+
+  arbiter.budget(2);
+  EXPECT_EQ(first.size(), 2);
+  EXPECT_TRUE(first.contains(3));
+}
+
+TEST_F(MemoryArbiterTest, WorksWithTimedCaches) {
+  ArbitratedTimedCache timed(1s, 10);
+  timed.arbitrate(arbiter);
+
+  timed.insert(1, 1);
+  first.insert(2, 2);
+  first.insert(3, 3);
+  first.insert(4, 4);
+  first.insert(5, 5);
+
+  EXPECT_FALSE(timed.contains(1));
+  EXPECT_EQ(arbiter.weight(), 4);
+}
+
+TEST_F(MemoryArbiterTest, KeepsTrackOfTheWeight) {
+  first.insert(1, 1);
+  first.insert(2, 2);
+  second.insert(3, 3);
+  EXPECT_EQ(arbiter.weight(), 3);
+
+  first.erase(1);
+  EXPECT_EQ(arbiter.weight(), 2);
+
+  first.clear();
+  EXPECT_EQ(arbiter.weight(), 1);
+
+  second.capacity(0);
+  EXPECT_EQ(arbiter.weight(), 0);
+}
+
+TEST_F(MemoryArbiterTest, AssigningToAnArbitratedCacheEnforcesTheBudget) {
+  second.insert(1, 1);
+
+  ArbitratedCache other(10);
+  for (int i = 2; i < 8; ++i) {
+    other.insert(i, i);
+  }
+
+  first = std::move(other);
+  EXPECT_LE(arbiter.weight(), 4);
+  EXPECT_EQ(first.size() + second.size(), arbiter.weight());
+
+  ArbitratedCache copy(10);
+  for (int i = 10; i < 20; ++i) {
+    copy.insert(i, i);
+  }
+
+  second = copy;
+  EXPECT_LE(arbiter.weight(), 4);
+  EXPECT_EQ(first.size() + second.size(), arbiter.weight());
+}
+
+TEST(MemoryArbiterLifetimeTest, CachesOutlivingTheArbiterAreDetached) {
+  ArbitratedCache cache(10);
+  {
+    MemoryArbiter arbiter(1);
+    cache.arbitrate(arbiter);
+    EXPECT_TRUE(cache.is_arbitrated());
+  }
+
+  EXPECT_FALSE(cache.is_arbitrated());
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  EXPECT_EQ(cache.size(), 2);
+}
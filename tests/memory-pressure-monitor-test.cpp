@@ -0,0 +1,177 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+struct MemoryPressureMonitorTest : public ::testing::Test {
+  MemoryPressureMonitorTest()
+  : directory(::testing::TempDir())
+  , monitor(directory, directory + "/pressure")
+  , cache(100) {
+    monitor.manage(cache);
+  }
+
+  ~MemoryPressureMonitorTest() {
+    std::remove((directory + "/memory.current").c_str());
+    std::remove((directory + "/memory.max").c_str());
+    std::remove((directory + "/pressure").c_str());
+    std::remove((directory + "/cgroup").c_str());
+  }
+
+  void write(const std::string& name, const std::string& contents) {
+    std::ofstream(directory + "/" + name) << contents;
+  }
+
+  MemoryReading usage(double fraction) {
+    MemoryReading reading;
+    reading.has_usage = true;
+    reading.usage = fraction;
+    return reading;
+  }
+
+  std::string directory;
+  MemoryPressureMonitor monitor;
+  Cache<int, int> cache;
+};
+
+TEST_F(MemoryPressureMonitorTest, ReadsCgroupAndPressureFiles) {
+  write("memory.current", "750\n");
+  write("memory.max", "1000\n");
+  write("pressure",
+        "some avg10=12.50 avg60=3.00 avg300=1.00 total=12345\n"
+        "full avg10=1.00 avg60=0.50 avg300=0.10 total=123\n");
+
+  auto reading = monitor.read();
+  EXPECT_TRUE(reading.has_usage);
+  EXPECT_DOUBLE_EQ(reading.usage, 0.75);
+  EXPECT_TRUE(reading.has_stall);
+  EXPECT_DOUBLE_EQ(reading.stall, 12.5);
+}
+
+TEST_F(MemoryPressureMonitorTest, MissingLimitsAndFilesAreIgnored) {
+  write("memory.current", "750\n");
+  write("memory.max", "max\n");
+
+  auto reading = monitor.read();
+  EXPECT_FALSE(reading.has_usage);
+  EXPECT_FALSE(reading.has_stall);
+
+  EXPECT_EQ(monitor.poll(), MemoryPressure::Normal);
+  EXPECT_EQ(cache.capacity(), 100);
+}
+
+TEST_F(MemoryPressureMonitorTest, MalformedPressureIsIgnored) {
+  write("pressure", "some avg10=n/a avg60=0.00 avg300=0.00 total=0\n");
+  EXPECT_FALSE(monitor.read().has_stall);
+
+  write("pressure", "some avg10= avg60=0.00 avg300=0.00 total=0\n");
+  EXPECT_FALSE(monitor.read().has_stall);
+
+  write("pressure", "some avg10=1.5x avg60=0.00 avg300=0.00 total=0\n");
+  EXPECT_FALSE(monitor.read().has_stall);
+}
+
+TEST_F(MemoryPressureMonitorTest, FindsCgroupOfProcess) {
+  const auto membership = directory + "/cgroup";
+  write("cgroup", "0::/system.slice/app.service\n");
+  EXPECT_EQ(MemoryPressureMonitor::cgroup_of_process(membership, "/cg"),
+            "/cg/system.slice/app.service");
+
+  // Hybrid hierarchies also list v1 controllers.
+  write("cgroup", "12:memory:/app\n0::/app\n");
+  EXPECT_EQ(MemoryPressureMonitor::cgroup_of_process(membership, "/cg"),
+            "/cg/app");
+
+  write("cgroup", "0::/\n");
+  EXPECT_EQ(MemoryPressureMonitor::cgroup_of_process(membership, "/cg"),
+            "/cg");
+
+  write("cgroup", "1:name=systemd:/app\n");
+  EXPECT_EQ(MemoryPressureMonitor::cgroup_of_process(membership, "/cg"),
+            "/cg");
+}
+
+TEST_F(MemoryPressureMonitorTest, ShrinksGraduallyUnderPressure) {
+  write("memory.current", "950\n");
+  write("memory.max", "1000\n");
+
+  EXPECT_EQ(monitor.poll(), MemoryPressure::High);
+  EXPECT_EQ(cache.capacity(), 90);
+
+  EXPECT_EQ(monitor.poll(), MemoryPressure::High);
+  EXPECT_EQ(cache.capacity(), 80);
+}
+
+TEST_F(MemoryPressureMonitorTest, StallsCountAsPressure) {
+  write("pressure", "some avg10=20.00 avg60=3.00 avg300=1.00 total=12345\n");
+  EXPECT_EQ(monitor.poll(), MemoryPressure::High);
+  EXPECT_EQ(cache.capacity(), 90);
+}
+
+TEST_F(MemoryPressureMonitorTest, NeverShrinksBelowMinimum) {
+  monitor.minimum(0.25);
+  for (int i = 0; i < 20; ++i) {
+    monitor.poll(usage(0.99));
+  }
+
+  EXPECT_EQ(cache.capacity(), 25);
+}
+
+TEST_F(MemoryPressureMonitorTest, RestoresCapacityWhenPressureSubsides) {
+  for (int i = 0; i < 3; ++i) {
+    monitor.poll(usage(0.95));
+  }
+  EXPECT_EQ(cache.capacity(), 70);
+
+  // Between the thresholds, nothing changes.
+  EXPECT_EQ(monitor.poll(usage(0.8)), MemoryPressure::Normal);
+  EXPECT_EQ(cache.capacity(), 70);
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(monitor.poll(usage(0.5)), MemoryPressure::Low);
+  }
+  EXPECT_EQ(cache.capacity(), 100);
+}
+
+TEST_F(MemoryPressureMonitorTest, ShrinkingEvictsKeys) {
+  for (int i = 0; i < 100; ++i) {
+    cache.insert(i, i);
+  }
+
+  monitor.step(0.5);
+  monitor.poll(usage(0.95));
+
+  EXPECT_EQ(cache.size(), 50);
+  EXPECT_TRUE(cache.contains(99));
+  EXPECT_FALSE(cache.contains(0));
+
+  monitor.restore();
+  EXPECT_EQ(cache.capacity(), 100);
+}
@@ -0,0 +1,140 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <mutex>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+namespace {
+bool contains(const std::string& text, const std::string& line) {
+  return text.find(line) != std::string::npos;
+}
+}  // namespace
+
+struct MetricsExporterTest : public ::testing::Test {
+  MetricsExporterTest() : monitored(2), unmonitored(8) {
+    monitored.monitor();
+    monitored.insert(1, 1);
+    monitored.insert(2, 2);
+    monitored.insert(3, 3);
+    monitored.insert(3, 4);
+    monitored.find(3);
+    monitored.find(1);
+    monitored.erase(2);
+
+    exporter.add("monitored", monitored);
+    exporter.add("plain", unmonitored);
+  }
+
+  MetricsExporter exporter;
+  Cache<int, int> monitored;
+  Cache<int, int> unmonitored;
+};
+
+TEST_F(MetricsExporterTest, TakesSnapshots) {
+  EXPECT_EQ(exporter.size(), 2);
+
+  auto snapshots = exporter.snapshot();
+  const auto& metrics = snapshots.at("monitored");
+  EXPECT_TRUE(metrics.is_monitoring);
+  EXPECT_EQ(metrics.size, 1);
+  EXPECT_EQ(metrics.capacity, 2);
+  EXPECT_EQ(metrics.hits, 1);
+  EXPECT_EQ(metrics.misses, 1);
+  EXPECT_EQ(metrics.evictions, 1);
+  EXPECT_EQ(metrics.erasures, 1);
+  EXPECT_EQ(metrics.overwrites, 1);
+  EXPECT_FALSE(metrics.latency);
+
+  EXPECT_FALSE(snapshots.at("plain").is_monitoring);
+
+  exporter.remove("plain");
+  EXPECT_EQ(exporter.size(), 1);
+}
+
+TEST_F(MetricsExporterTest, RendersPrometheusText) {
+  const auto text = exporter.prometheus();
+
+  EXPECT_TRUE(contains(text, "# TYPE lru_cache_size gauge\n"));
+  EXPECT_TRUE(contains(text, "lru_cache_size{cache=\"monitored\"} 1\n"));
+  EXPECT_TRUE(contains(text, "lru_cache_capacity{cache=\"plain\"} 8\n"));
+  EXPECT_TRUE(contains(text, "# TYPE lru_cache_hits_total counter\n"));
+  EXPECT_TRUE(contains(text, "lru_cache_hits_total{cache=\"monitored\"} 1\n"));
+  EXPECT_TRUE(
+      contains(text, "lru_cache_evictions_total{cache=\"monitored\"} 1\n"));
+
+  // Unmonitored caches have no counters.
+  EXPECT_FALSE(contains(text, "lru_cache_hits_total{cache=\"plain\"}"));
+}
+
+TEST_F(MetricsExporterTest, RendersLatencySummaries) {
+  std::mutex mutex;
+  Cache<int, int> timed;
+  timed.monitor_latency();
+  timed.insert(1, 1);
+  exporter.add("timed", timed, mutex);
+
+  const auto text = exporter.prometheus();
+  EXPECT_TRUE(
+      contains(text, "# TYPE lru_cache_operation_duration_seconds summary\n"));
+  EXPECT_TRUE(contains(text,
+                       "lru_cache_operation_duration_seconds_count{cache="
+                       "\"timed\",operation=\"insert\"} 1\n"));
+  EXPECT_TRUE(contains(text,
+                       "lru_cache_operation_duration_seconds{cache=\"timed\","
+                       "operation=\"find\",quantile=\"0.99\"} 0\n"));
+
+  const auto json = exporter.json();
+  EXPECT_TRUE(contains(json, "\"timed\":{\"size\":1,\"capacity\":128,"));
+  EXPECT_TRUE(contains(json, "\"insert\":{\"count\":1,"));
+}
+
+TEST_F(MetricsExporterTest, RendersJson) {
+  exporter.remove("plain");
+  EXPECT_EQ(exporter.json(),
+            "{\"monitored\":{\"size\":1,\"capacity\":2,\"hits\":1,"
+            "\"misses\":1,\"evictions\":1,\"expirations\":0,\"erasures\":1,"
+            "\"overwrites\":1}}");
+}
+
+TEST(MetricsExporterPrefixTest, EscapesNamesAndUsesPrefix) {
+  MetricsExporter exporter("app_cache");
+  LfuCache<int, int> cache(4);
+  exporter.add("a \"quoted\"\\name", cache);
+
+  const auto text = exporter.prometheus();
+  EXPECT_TRUE(contains(
+      text, "app_cache_size{cache=\"a \\\"quoted\\\"\\\\name\"} 0\n"));
+}
+
+TEST(MetricsExporterPrefixTest, EscapesControlCharactersInJson) {
+  MetricsExporter exporter;
+  LfuCache<int, int> cache(4);
+  exporter.add("a\tb\nc\x01\"", cache);
+
+  const auto json = exporter.json();
+  EXPECT_TRUE(contains(json, "{\"a\\u0009b\\nc\\u0001\\\"\":{"));
+}
@@ -0,0 +1,163 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <cstddef>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+struct PartitionedCacheTest : public ::testing::Test {
+  PartitionedCacheTest() : cache(2) {
+    cache.quota("a", 2);
+    cache.quota("b", 2);
+  }
+
+  PartitionedCache<int, int, std::string> cache;
+};
+
+TEST_F(PartitionedCacheTest, ContainsAfterInsertion) {
+  EXPECT_EQ(cache.capacity(), 6);
+  EXPECT_EQ(cache.partitions(), 2);
+
+  EXPECT_TRUE(cache.insert(1, 1, "a"));
+  EXPECT_TRUE(cache.emplace(2, 4, "b"));
+  EXPECT_FALSE(cache.insert(1, 2, "a"));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache[1], 2);
+  EXPECT_EQ(cache[2], 4);
+  EXPECT_EQ(cache.partition_of(1), "a");
+  EXPECT_EQ(cache.size("a"), 1);
+  EXPECT_EQ(cache.size("c"), 0);
+}
+
+TEST_F(PartitionedCacheTest, PartitionsBorrowFromSharedPool) {
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(cache.insert(i, i, "a"));
+  }
+
+  EXPECT_EQ(cache.size("a"), 4);
+  EXPECT_EQ(cache.borrowed("a"), 2);
+  EXPECT_EQ(cache.borrowed(), 2);
+
+  // The pool is exhausted, so "a" now replaces its own keys.
+  cache.insert(4, 4, "a");
+  EXPECT_EQ(cache.size("a"), 4);
+  EXPECT_FALSE(cache.contains(0));
+}
+
+TEST_F(PartitionedCacheTest, NoisyPartitionsDoNotEvictOthers) {
+  cache.insert(-1, -1, "b");
+  cache.insert(-2, -2, "b");
+
+  for (int i = 0; i < 1000; ++i) {
+    cache.insert(i, i, "a");
+  }
+
+  EXPECT_TRUE(cache.contains(-1));
+  EXPECT_TRUE(cache.contains(-2));
+  EXPECT_EQ(cache.size("a"), 4);
+}
+
+TEST_F(PartitionedCacheTest, QuotaIsGuaranteedEvenIfPoolIsBorrowed) {
+  for (int i = 0; i < 4; ++i) {
+    cache.insert(i, i, "a");
+  }
+
+  cache.insert(100, 100, "b");
+  cache.insert(101, 101, "b");
+  EXPECT_EQ(cache.size("a"), 4);
+  EXPECT_EQ(cache.size("b"), 2);
+
+  // Borrowing again means evicting "b"'s own keys, not "a"'s.
+  cache.insert(102, 102, "b");
+  EXPECT_FALSE(cache.contains(100));
+  EXPECT_EQ(cache.size("a"), 4);
+}
+
+TEST_F(PartitionedCacheTest, UnknownPartitionsLiveOffThePool) {
+  EXPECT_TRUE(cache.insert(1, 1, "c"));
+  EXPECT_EQ(cache.quota("c"), 0);
+  EXPECT_EQ(cache.borrowed("c"), 1);
+
+  cache.shared_pool(0);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_FALSE(cache.insert(2, 2, "c"));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(PartitionedCacheTest, ShrinkingThePoolEvictsBiggestBorrowersFirst) {
+  cache.shared_pool(4);
+  for (int i = 0; i < 5; ++i) {
+    cache.insert(i, i, "a");
+  }
+  cache.insert(100, 100, "b");
+  cache.insert(101, 101, "b");
+  cache.insert(102, 102, "b");
+
+  EXPECT_EQ(cache.borrowed(), 4);
+
+  cache.shared_pool(2);
+  EXPECT_EQ(cache.borrowed(), 2);
+  EXPECT_EQ(cache.size("a"), 3);
+  EXPECT_EQ(cache.size("b"), 3);
+}
+
+TEST_F(PartitionedCacheTest, LoweringAQuotaEvictsFromThatPartition) {
+  for (int i = 0; i < 4; ++i) {
+    cache.insert(i, i, "a");
+  }
+
+  cache.quota("a", 1);
+  EXPECT_EQ(cache.size("a"), 3);
+  EXPECT_EQ(cache.borrowed(), 2);
+  EXPECT_FALSE(cache.contains(0));
+}
+
+TEST_F(PartitionedCacheTest, MovingKeysBetweenPartitionsRespectsQuotas) {
+  for (int i = 0; i < 4; ++i) {
+    cache.insert(i, i, "a");
+  }
+
+  cache.insert(3, 3, "b");
+  EXPECT_EQ(cache.partition_of(3), "b");
+  EXPECT_EQ(cache.size("a"), 3);
+  EXPECT_EQ(cache.size("b"), 1);
+  EXPECT_EQ(cache.borrowed(), 1);
+}
+
+TEST_F(PartitionedCacheTest, EraseAndClearWork) {
+  for (int i = 0; i < 3; ++i) {
+    cache.insert(i, i, "a");
+  }
+
+  EXPECT_TRUE(cache.erase(2));
+  EXPECT_EQ(cache.borrowed(), 0);
+
+  cache.clear();
+  EXPECT_TRUE(cache.is_empty());
+  EXPECT_EQ(cache.size("a"), 0);
+  EXPECT_EQ(cache.borrowed(), 0);
+}
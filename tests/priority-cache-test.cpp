@@ -0,0 +1,253 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <cstddef>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+struct PriorityCacheTest : public ::testing::Test {
+  PriorityCache<int, int> cache{4, 3};
+};
+
+TEST_F(PriorityCacheTest, ContainsAfterInsertion) {
+  ASSERT_TRUE(cache.is_empty());
+
+  EXPECT_TRUE(cache.insert(1, 1));
+  EXPECT_TRUE(cache.insert(2, 4, 1));
+  EXPECT_TRUE(cache.emplace(3, 9, 2));
+
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache[1], 1);
+  EXPECT_EQ(cache[2], 4);
+  EXPECT_EQ(cache[3], 9);
+
+  EXPECT_EQ(cache.priority(1), 0);
+  EXPECT_EQ(cache.priority(2), 1);
+  EXPECT_EQ(cache.priority(3), 2);
+  EXPECT_EQ(cache.size(0), 1);
+}
+
+TEST_F(PriorityCacheTest, InsertUpdatesValueAndPriority) {
+  EXPECT_TRUE(cache.insert(1, 1));
+  EXPECT_FALSE(cache.insert(1, 2, 2));
+
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.lookup(1), 2);
+  EXPECT_EQ(cache.priority(1), 2);
+  EXPECT_EQ(cache.size(0), 0);
+  EXPECT_EQ(cache.size(2), 1);
+}
+
+TEST_F(PriorityCacheTest, ThrowsForInvalidPriorities) {
+  EXPECT_THROW(cache.insert(1, 1, 3), LRU::Error::InvalidArgument);
+  EXPECT_THROW(cache.minimum_share(3, 0.5), LRU::Error::InvalidArgument);
+  EXPECT_THROW(cache.minimum_share(0, 1.5), LRU::Error::InvalidArgument);
+  EXPECT_THROW(cache.priority(1), LRU::Error::KeyNotFound);
+}
+
+TEST_F(PriorityCacheTest, EvictsLowerPrioritiesFirst) {
+  cache.insert(1, 1, 2);
+  cache.insert(2, 2, 0);
+  cache.insert(3, 3, 1);
+  cache.insert(4, 4, 0);
+
+  // Lowest class goes first, in LRU order.
+  cache.insert(5, 5, 2);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(4));
+
+  cache.insert(6, 6, 1);
+  EXPECT_FALSE(cache.contains(4));
+
+  cache.insert(7, 7, 2);
+  EXPECT_FALSE(cache.contains(3));
+
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(5));
+  EXPECT_TRUE(cache.contains(6));
+  EXPECT_TRUE(cache.contains(7));
+}
+
+TEST_F(PriorityCacheTest, BurstsOfLowPriorityKeysDoNotEvictHigherOnes) {
+  cache.insert(1, 1, 2);
+  cache.insert(2, 2, 1);
+
+  for (int i = 100; i < 200; ++i) {
+    cache.insert(i, i);
+  }
+
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_EQ(cache.size(0), 2);
+  EXPECT_TRUE(cache.contains(199));
+  EXPECT_TRUE(cache.contains(198));
+}
+
+TEST_F(PriorityCacheTest, RejectsKeysThatWouldDisplaceHigherPriorities) {
+  for (int i = 0; i < 4; ++i) {
+    cache.insert(i, i, 2);
+  }
+
+  EXPECT_FALSE(cache.insert(4, 4, 1));
+  EXPECT_FALSE(cache.contains(4));
+  EXPECT_EQ(cache.size(), 4);
+}
+
+TEST_F(PriorityCacheTest, HitsMoveKeysToFrontOfTheirClass) {
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  cache.insert(3, 3);
+  cache.insert(4, 4);
+
+  ASSERT_TRUE(cache.contains(1));
+  cache.insert(5, 5);
+
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+}
+
+TEST_F(PriorityCacheTest, MinimumSharesProtectLowerClasses) {
+  cache.minimum_share(0, 0.5);
+  EXPECT_EQ(cache.reserved(0), 2);
+
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+
+  for (int i = 100; i < 110; ++i) {
+    cache.insert(i, i, 2);
+  }
+
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_EQ(cache.size(2), 2);
+
+  // Within its share, a class only replaces its own keys.
+  cache.insert(3, 3);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_EQ(cache.size(0), 2);
+  EXPECT_EQ(cache.size(2), 2);
+}
+
+TEST_F(PriorityCacheTest, RejectsKeysThatWouldDigIntoMinimumShares) {
+  cache.minimum_share(0, 0.5);
+  cache.minimum_share(1, 0.5);
+
+  cache.insert(1, 1, 0);
+  cache.insert(2, 2, 0);
+  cache.insert(3, 3, 1);
+  cache.insert(4, 4, 1);
+
+  EXPECT_FALSE(cache.insert(5, 5, 2));
+  EXPECT_FALSE(cache.contains(5));
+  EXPECT_EQ(cache.size(0), 2);
+  EXPECT_EQ(cache.size(1), 2);
+
+  // Shrinking may still evict reserved keys.
+  cache.capacity(3);
+  EXPECT_EQ(cache.size(0), 1);
+  EXPECT_EQ(cache.size(1), 2);
+}
+
+TEST_F(PriorityCacheTest, ShrinkingDigsIntoTheLowestReservationFirst) {
+  cache.minimum_share(0, 0.5);
+  cache.minimum_share(2, 0.5);
+
+  cache.insert(1, 1, 0);
+  cache.insert(2, 2, 0);
+  cache.insert(3, 3, 2);
+  cache.insert(4, 4, 2);
+
+  cache.capacity(3);
+  EXPECT_EQ(cache.size(0), 1);
+  EXPECT_EQ(cache.size(2), 2);
+  EXPECT_FALSE(cache.contains(1));
+
+  cache.capacity(1);
+  EXPECT_EQ(cache.size(0), 0);
+  EXPECT_EQ(cache.size(2), 1);
+}
+
+TEST_F(PriorityCacheTest, ShrinkingEvictsLowerPrioritiesFirst) {
+  cache.insert(1, 1, 2);
+  cache.insert(2, 2, 1);
+  cache.insert(3, 3, 0);
+  cache.insert(4, 4, 1);
+
+  cache.capacity(2);
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(4));
+}
+
+TEST_F(PriorityCacheTest, EraseAndClearWork) {
+  cache.insert(1, 1);
+  cache.insert(2, 2, 1);
+
+  EXPECT_TRUE(cache.erase(1));
+  EXPECT_FALSE(cache.erase(1));
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_EQ(cache.size(0), 0);
+
+  cache.clear();
+  EXPECT_TRUE(cache.is_empty());
+  EXPECT_FALSE(cache.contains(2));
+}
+
+TEST_F(PriorityCacheTest, CopiesAreIndependent) {
+  cache.insert(1, 1);
+  cache.insert(2, 2, 1);
+
+  auto copy = cache;
+  copy.insert(3, 3);
+  EXPECT_TRUE(copy.erase(1));
+
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(3));
+  EXPECT_EQ(copy.priority(2), 1);
+  EXPECT_TRUE(copy.contains(3));
+}
+
+TEST_F(PriorityCacheTest, MonitorsStatistics) {
+  cache.monitor();
+  cache.insert(1, 1);
+
+  cache.contains(1);
+  cache.contains(2);
+
+  EXPECT_EQ(cache.stats().total_hits(), 1);
+  EXPECT_EQ(cache.stats().total_misses(), 1);
+
+  cache.insert(1, 2);
+  for (int i = 2; i <= 5; ++i) {
+    cache.insert(i, i);
+  }
+  cache.erase(5);
+
+  EXPECT_EQ(cache.stats().total_overwrites(), 1);
+  EXPECT_EQ(cache.stats().total_evictions(), 1);
+  EXPECT_EQ(cache.stats().total_erasures(), 1);
+}
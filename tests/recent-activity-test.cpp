@@ -0,0 +1,121 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <chrono>
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+using namespace std::chrono_literals;
+
+struct RecentActivityTest : public ::testing::Test {
+  RecentActivityTest()
+  : start(RecentActivity::Clock::now()), activity(start) {
+  }
+
+  RecentActivity::TimePoint start;
+  RecentActivity activity;
+};
+
+TEST_F(RecentActivityTest, CountsEventsWithinTheWindow) {
+  activity.record(Event::Hit, start);
+  activity.record(Event::Hit, start + 5s, 2);
+  activity.record(Event::Miss, start + 9s);
+
+  const auto now = start + 10s;
+  EXPECT_EQ(activity.count(Event::Hit, 1s, now), 0);
+  EXPECT_EQ(activity.count(Event::Hit, 6s, now), 2);
+  EXPECT_EQ(activity.count(Event::Hit, 60s, now), 3);
+  EXPECT_EQ(activity.count(Event::Miss, 2s, now), 1);
+  EXPECT_EQ(activity.count(Event::Eviction, 60s, now), 0);
+
+  EXPECT_DOUBLE_EQ(activity.rate(Event::Hit, 10s, now), 0.2);
+  EXPECT_DOUBLE_EQ(activity.hit_rate(2s, now), 0);
+  EXPECT_DOUBLE_EQ(activity.hit_rate(60s, now), 0.75);
+  EXPECT_TRUE(std::isnan(activity.hit_rate(1s, now)));
+}
+
+TEST_F(RecentActivityTest, ForgetsEventsOutsideTheSpan) {
+  activity.record(Event::Insertion, start, 5);
+  EXPECT_EQ(activity.count(Event::Insertion, 64s, start + 30s), 5);
+
+  // The slot is re-used for a new tick.
+  const auto later = start + 64s;
+  activity.record(Event::Insertion, later);
+  EXPECT_EQ(activity.count(Event::Insertion, 64s, later), 1);
+
+  EXPECT_EQ(activity.count(Event::Insertion, 64s, start + 200s), 0);
+}
+
+TEST_F(RecentActivityTest, ThrowsForWindowsLongerThanTheSpan) {
+  EXPECT_THROW(activity.count(Event::Hit, 65s, start), Error::InvalidArgument);
+}
+
+TEST_F(RecentActivityTest, MaintainsExponentiallyDecayedRates) {
+  // A steady ten hits per second for a minute.
+  for (int tenth = 0; tenth < 600; ++tenth) {
+    activity.record(Event::Hit, start + tenth * 100ms);
+  }
+
+  const auto now = start + 60s;
+  EXPECT_NEAR(activity.average_rate(Event::Hit, 1s, now), 10, 1);
+  EXPECT_NEAR(activity.average_rate(Event::Hit, 10s, now), 10, 1);
+  // The one-minute average has only had one time constant to warm up.
+  EXPECT_NEAR(
+      activity.average_rate(Event::Hit, 60s, now), 10 * (1 - 1 / M_E), 1);
+
+  // After ten quiet seconds, the short average has all but decayed.
+  const auto quiet = now + 10s;
+  EXPECT_LT(activity.average_rate(Event::Hit, 1s, quiet), 0.01);
+  EXPECT_NEAR(activity.average_rate(Event::Hit, 10s, quiet), 10 / M_E, 1);
+
+  EXPECT_THROW(activity.average_rate(Event::Hit, 5s, now),
+               Error::InvalidArgument);
+}
+
+TEST(RecentActivityStatisticsTest, CachesRecordRecentActivity) {
+  Cache<int, int> cache(2);
+  cache.monitor();
+  EXPECT_THROW(cache.stats().recent(), Error::NotMonitoring);
+
+  cache.stats().track_recent_activity();
+  EXPECT_TRUE(cache.stats().is_tracking_recent_activity());
+
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  cache.insert(3, 3);
+  cache.insert(3, 4);
+  cache.contains(3);
+  cache.contains(1);
+
+  const auto& recent = cache.stats().recent();
+  EXPECT_EQ(recent.count(Event::Insertion, 60s), 3);
+  EXPECT_EQ(recent.count(Event::Eviction, 60s), 1);
+  EXPECT_EQ(recent.count(Event::Hit, 60s), 1);
+  EXPECT_EQ(recent.count(Event::Miss, 60s), 1);
+  EXPECT_DOUBLE_EQ(recent.hit_rate(60s), 0.5);
+
+  cache.stats().stop_tracking_recent_activity();
+  EXPECT_FALSE(cache.stats().is_tracking_recent_activity());
+}
@@ -19,7 +19,12 @@
 /// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 /// IN THE SOFTWARE.
 
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <numeric>
+#include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -193,6 +198,128 @@ TEST(StatisticsTest, RatesAreCalculatedCorrectly) {
   EXPECT_EQ(stats->miss_rate(), 0.8);
 }
 
+TEST(StatisticsTest, PeriodicSamplingExtrapolatesKeyCounts) {
+  auto stats = std::make_shared<Statistics<int>>(1, 2);
+  StatisticsMutator<int> mutator(stats);
+  stats->sample(4, Sampling::Periodic);
+  EXPECT_EQ(stats->sampling_period(), 4);
+  EXPECT_EQ(stats->sampling(), Sampling::Periodic);
+
+  for (int i = 0; i < 10; ++i) {
+    mutator.register_hit(1);
+  }
+  for (int i = 0; i < 6; ++i) {
+    mutator.register_miss(2);
+  }
+
+  // Every fourth hit and every fourth miss is recorded (the 4th and 8th hit,
+  // the 4th miss), each standing for four accesses.
+  EXPECT_EQ(stats->hits_for(1), 8);
+  EXPECT_EQ(stats->misses_for(2), 4);
+
+  // Totals are never sampled.
+  EXPECT_EQ(stats->total_hits(), 10);
+  EXPECT_EQ(stats->total_misses(), 6);
+}
+
+TEST(StatisticsTest, RandomSamplingIsUnbiased) {
+  auto stats = std::make_shared<Statistics<int>>(1);
+  StatisticsMutator<int> mutator(stats);
+  stats->sample(10, Sampling::Random);
+  EXPECT_EQ(stats->sampling(), Sampling::Random);
+
+  for (int i = 0; i < 100000; ++i) {
+    mutator.register_hit(1);
+  }
+
+  EXPECT_NEAR(stats->hits_for(1), 100000, 5000);
+  EXPECT_EQ(stats->hits_for(1) % 10, 0);
+}
+
+TEST(StatisticsTest, SamplingDefaultsToPeriodic) {
+  Statistics<int> stats;
+  EXPECT_EQ(stats.sampling(), Sampling::Periodic);
+
+  stats.sample(4);
+  EXPECT_EQ(stats.sampling(), Sampling::Periodic);
+}
+
+TEST(StatisticsTest, SamplingByKeyRecordsKeysAlwaysOrNever) {
+  std::vector<int> keys(1000);
+  std::iota(keys.begin(), keys.end(), 0);
+
+  auto stats = std::make_shared<Statistics<int>>(keys);
+  StatisticsMutator<int> mutator(stats);
+  stats->sample(4, Sampling::ByKey);
+
+  for (int round = 0; round < 3; ++round) {
+    for (auto key : keys) {
+      mutator.register_hit(key);
+    }
+  }
+
+  std::size_t recorded = 0;
+  for (auto key : keys) {
+    const auto hits = stats->hits_for(key);
+    EXPECT_TRUE(hits == 0 || hits == 12);
+    if (hits > 0) recorded += 1;
+  }
+
+  // About one in four keys is recorded.
+  EXPECT_NEAR(recorded, 250, 60);
+  EXPECT_EQ(stats->total_hits(), 3000);
+}
+
+TEST(StatisticsTest, SamplingExtrapolatesHeavyHitters) {
+  auto stats = std::make_shared<Statistics<int>>();
+  StatisticsMutator<int> mutator(stats);
+  stats->track_heavy_hitters(2);
+  stats->sample(2, Sampling::Periodic);
+
+  for (int i = 0; i < 6; ++i) {
+    mutator.register_hit(7);
+  }
+
+  EXPECT_EQ(stats->heavy_hits().count(7), 6);
+  EXPECT_EQ(stats->top_hits(1)[0].count, 6);
+}
+
+TEST(StatisticsTest, PeriodicSamplingSamplesHitsAndMissesSeparately) {
+  auto stats = std::make_shared<Statistics<int>>(1, 2);
+  StatisticsMutator<int> mutator(stats);
+  stats->sample(2, Sampling::Periodic);
+
+  for (int i = 0; i < 10; ++i) {
+    mutator.register_hit(1);
+    mutator.register_miss(2);
+  }
+
+  EXPECT_EQ(stats->hits_for(1), 10);
+  EXPECT_EQ(stats->misses_for(2), 10);
+}
+
+TEST(StatisticsTest, ChangingSamplingPeriodKeepsRecordedHeavyHitters) {
+  auto stats = std::make_shared<Statistics<int>>();
+  StatisticsMutator<int> mutator(stats);
+  stats->track_heavy_hitters(2);
+
+  for (int i = 0; i < 3; ++i) {
+    mutator.register_hit(7);
+  }
+
+  stats->sample(4, Sampling::Periodic);
+  for (int i = 0; i < 4; ++i) {
+    mutator.register_hit(7);
+  }
+
+  EXPECT_EQ(stats->top_hits(1)[0].count, 7);
+}
+
+TEST(StatisticsTest, ThrowsForZeroSamplingPeriod) {
+  Statistics<int> stats;
+  EXPECT_THROW(stats.sample(0), LRU::Error::InvalidArgument);
+}
+
 TEST(StatisticsTest, CanShareStatistics) {
   auto stats = std::make_shared<Statistics<int>>(1, 2, 3);
   StatisticsMutator<int> mutator1(stats);
@@ -373,3 +500,87 @@ TEST_F(CacheWithStatisticsTest, StopsMonitoringWhenAsked) {
   ASSERT_TRUE(cache.contains(1));
   EXPECT_EQ(stats->hits_for(1), 1);
 }
+
+TEST_F(CacheWithStatisticsTest, CountsEvictionsErasuresAndOverwrites) {
+  cache.capacity(2);
+  cache.monitor();
+
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  cache.insert(2, 3);
+  EXPECT_EQ(cache.stats().total_overwrites(), 1);
+
+  cache.insert(3, 3);
+  cache.insert(4, 4);
+  EXPECT_EQ(cache.stats().total_evictions(), 2);
+
+  cache.erase(4);
+  cache.erase(42);
+  cache.erase(cache.find(3));
+  EXPECT_EQ(cache.stats().total_erasures(), 2);
+  EXPECT_EQ(cache.stats().total_expirations(), 0);
+}
+
+TEST(CacheWithLifetimesTest, RecordsLifetimesOfEvictedKeys) {
+  Cache<int,
+        int,
+        DefaultHash<int>,
+        std::equal_to<int>,
+        NoHooks,
+        TrackLifetimes>
+      cache(2);
+  cache.monitor();
+  EXPECT_THROW(cache.stats().age_at_eviction(), LRU::Error::NotMonitoring);
+
+  // Inserted before lifetimes are tracked, so never recorded.
+  cache.insert(0, 0);
+
+  cache.stats().track_lifetimes();
+  EXPECT_TRUE(cache.stats().is_tracking_lifetimes());
+
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  EXPECT_EQ(cache.stats().total_evictions(), 1);
+  EXPECT_EQ(cache.stats().hits_at_eviction().count(), 0);
+
+  cache.find(1);
+  cache.contains(1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  cache.insert(3, 3);
+  cache.insert(4, 4);
+
+  const auto& hits = cache.stats().hits_at_eviction();
+  EXPECT_EQ(hits.count(), 2);
+  EXPECT_EQ(hits.max(), 2);
+  EXPECT_EQ(hits.percentile(0.5), 0);
+
+  EXPECT_GE(cache.stats().age_at_eviction().max(), 20);
+  EXPECT_GE(cache.stats().idle_time_at_eviction().percentile(0), 20);
+
+  cache.stats().stop_tracking_lifetimes();
+  EXPECT_FALSE(cache.stats().is_tracking_lifetimes());
+}
+
+TEST_F(CacheWithStatisticsTest, OnlyCachesTrackingLifetimesRecordThem) {
+  cache.capacity(1);
+  cache.monitor();
+  cache.stats().track_lifetimes();
+
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  EXPECT_EQ(cache.stats().total_evictions(), 1);
+  EXPECT_EQ(cache.stats().age_at_eviction().count(), 0);
+}
+
+TEST(TimedCacheWithStatisticsTest, CountsExpirations) {
+  TimedCache<int, int> cache(std::chrono::milliseconds(1));
+  cache.monitor();
+
+  cache.insert(1, 1);
+  cache.insert(2, 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+  EXPECT_EQ(cache.clear_expired(), 2);
+  EXPECT_EQ(cache.stats().total_expirations(), 2);
+  EXPECT_EQ(cache.stats().total_erasures(), 0);
+}
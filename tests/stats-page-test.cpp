@@ -0,0 +1,139 @@
+/// The MIT License (MIT)
+/// Copyright (c) 2016 Peter Goldsborough
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "lru/lru.hpp"
+
+using namespace LRU;
+
+struct StatsPageTest : public ::testing::Test {
+  StatsPageTest()
+  : path(::testing::TempDir() + "/lru-stats-page"), page(path, 4), cache(2) {
+    cache.monitor();
+  }
+
+  ~StatsPageTest() {
+    std::remove(path.c_str());
+  }
+
+  std::string path;
+  StatsPage page;
+  Cache<int, int> cache;
+};
+
+TEST_F(StatsPageTest, PublishesCountersToReaders) {
+  page.add("users", cache);
+
+  StatsPageReader reader(path);
+  EXPECT_EQ(reader.slots(), 4);
+
+  auto snapshots = reader.read();
+  ASSERT_EQ(snapshots.size(), 1);
+  EXPECT_EQ(snapshots.at("users").capacity, 2);
+  EXPECT_EQ(snapshots.at("users").hits, 0);
+
+  cache.insert(1, 1);
+  cache.find(1);
+  cache.find(2);
+
+  // Nothing changes until published.
+  EXPECT_EQ(reader.read().at("users").hits, 0);
+
+  page.publish();
+  const auto metrics = reader.read().at("users");
+  EXPECT_TRUE(metrics.is_monitoring);
+  EXPECT_EQ(metrics.size, 1);
+  EXPECT_EQ(metrics.hits, 1);
+  EXPECT_EQ(metrics.misses, 1);
+}
+
+TEST_F(StatsPageTest, FreesSlotsOfRemovedCaches) {
+  Cache<int, int> other;
+  page.add("first", cache);
+  page.add("second", other);
+  EXPECT_THROW(page.add("first", other), Error::InvalidArgument);
+
+  page.remove("first");
+  StatsPageReader reader(path);
+  auto snapshots = reader.read();
+  EXPECT_EQ(snapshots.size(), 1);
+  EXPECT_EQ(snapshots.count("second"), 1);
+
+  page.add("third", cache);
+  page.add("fourth", cache);
+  page.add("fifth", cache);
+  EXPECT_THROW(page.add("sixth", cache), Error::InvalidArgument);
+}
+
+TEST_F(StatsPageTest, RejectsInvalidNames) {
+  EXPECT_THROW(page.add("", cache), Error::InvalidArgument);
+  EXPECT_THROW(page.add(std::string(49, 'x'), cache), Error::InvalidArgument);
+  page.add(std::string(48, 'x'), cache);
+  EXPECT_EQ(StatsPageReader(path).read().count(std::string(48, 'x')), 1);
+}
+
+TEST_F(StatsPageTest, ReadersSeeConsistentSnapshots) {
+  page.add("users", cache);
+
+  std::atomic<bool> done(false);
+  std::thread writer([this, &done] {
+    for (int i = 0; i < 20000; ++i) {
+      cache.find(i % 2);
+      page.publish();
+    }
+    done = true;
+  });
+
+  StatsPageReader reader(path);
+  while (!done) {
+    const auto snapshots = reader.read();
+    if (snapshots.count("users") == 0) {
+      ADD_FAILURE() << "Failed to read a consistent snapshot";
+      break;
+    }
+
+    const auto& metrics = snapshots.at("users");
+    EXPECT_EQ(metrics.capacity, 2);
+    EXPECT_EQ(metrics.hits, 0);
+    EXPECT_LE(metrics.misses, 20000);
+    if (::testing::Test::HasFailure()) break;
+  }
+
+  writer.join();
+  EXPECT_EQ(reader.read().at("users").misses, 20000);
+}
+
+TEST(StatsPageReaderTest, RejectsOtherFiles) {
+  const auto path = ::testing::TempDir() + "/not-a-stats-page";
+  std::ofstream(path) << "definitely not a stats page";
+  EXPECT_THROW(StatsPageReader{path}, Error::InvalidArgument);
+  std::remove(path.c_str());
+
+  EXPECT_THROW(StatsPageReader{path}, std::system_error);
+}
@@ -31,6 +31,23 @@
 using namespace LRU;
 using namespace std::chrono_literals;
 
+TEST(TimedCacheTest, OverwritingRestartsTheTimeToLive) {
+  TimedCache<int, int> cache(50ms);
+
+  cache.insert(1, 2);
+  std::this_thread::sleep_for(100ms);
+  ASSERT_FALSE(cache.contains(1));
+
+  // The expired key is still in the cache, so this is an overwrite.
+  EXPECT_FALSE(cache.insert(1, 3).was_inserted());
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_EQ(cache[1], 3);
+
+  std::this_thread::sleep_for(100ms);
+  EXPECT_FALSE(cache.emplace(1, 4).was_inserted());
+  EXPECT_TRUE(cache.contains(1));
+}
+
 TEST(TimedCacheTest, ContainsRespectsExpiration) {
   TimedCache<int, int> cache(2ms);
 
@@ -20,6 +20,11 @@
 /// IN THE SOFTWARE.
 
 #include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -88,3 +93,316 @@ TEST(WrapTest, CanPassTimeArgumentToTimedCacheWrap) {
   wrapped1(1);
   EXPECT_EQ(call_count, 1);
 }
+
+TEST(WrapTest, EachWrapperOwnsItsCache) {
+  std::size_t call_count = 0;
+  auto f = [&call_count](int x) { return call_count += 1; };
+
+  auto wrapped1 = LRU::wrap(f);
+  auto wrapped2 = LRU::wrap(f);
+
+  wrapped1(1);
+  wrapped2(1);
+  EXPECT_EQ(call_count, 2);
+
+  EXPECT_EQ(wrapped1.cache().size(), 1);
+  EXPECT_EQ(wrapped2.cache().size(), 1);
+}
+
+TEST(WrapTest, CanClearAndResizeTheCache) {
+  std::size_t call_count = 0;
+  auto wrapped = LRU::wrap(
+      [&call_count](int x, const std::string& s) {
+        call_count += 1;
+        return s + std::to_string(x);
+      },
+      4);
+
+  EXPECT_EQ(wrapped.capacity(), 4);
+  EXPECT_EQ(wrapped(1, "a"), "a1");
+  EXPECT_EQ(wrapped(1, "a"), "a1");
+  EXPECT_EQ(call_count, 1);
+  EXPECT_TRUE(wrapped.cache().contains(std::make_tuple(1, "a")));
+
+  wrapped.clear();
+  EXPECT_TRUE(wrapped.cache().is_empty());
+  wrapped(1, "a");
+  EXPECT_EQ(call_count, 2);
+
+  wrapped.capacity(1);
+  wrapped(2, "b");
+  EXPECT_EQ(wrapped.cache().size(), 1);
+  wrapped(1, "a");
+  EXPECT_EQ(call_count, 4);
+}
+
+int square(int x) {
+  return x * x;
+}
+
+TEST(WrapTest, CanWrapFunctionPointersAndMonitorThem) {
+  auto wrapped = LRU::wrap(square);
+  EXPECT_THROW(wrapped.stats(), LRU::Error::NotMonitoring);
+
+  wrapped.cache().monitor();
+  EXPECT_EQ(wrapped(3), 9);
+  EXPECT_EQ(wrapped(3), 9);
+
+  EXPECT_EQ(wrapped.stats().total_hits(), 1);
+  EXPECT_EQ(wrapped.stats().total_misses(), 1);
+}
+
+namespace {
+struct CopyCounter {
+  static std::size_t copies;
+
+  CopyCounter() = default;
+  CopyCounter(CopyCounter&&) = default;
+  CopyCounter(const CopyCounter&) {
+    copies += 1;
+  }
+  CopyCounter& operator=(CopyCounter&&) = default;
+  CopyCounter& operator=(const CopyCounter&) {
+    copies += 1;
+    return *this;
+  }
+
+  bool operator==(const CopyCounter&) const {
+    return true;
+  }
+
+  bool operator!=(const CopyCounter&) const {
+    return false;
+  }
+};
+
+std::size_t CopyCounter::copies = 0;
+}  // namespace
+
+TEST(WrapTest, ReferenceDoesNotCopyResults) {
+  auto wrapped = LRU::wrap([](int) { return CopyCounter(); });
+  CopyCounter::copies = 0;
+
+  const auto& first = wrapped.reference(1);
+  const auto& second = wrapped.reference(1);
+
+  EXPECT_EQ(&first, &second);
+  EXPECT_EQ(CopyCounter::copies, 0);
+}
+
+TEST(WrapTest, ReferenceWorksWithoutCapacity) {
+  std::size_t call_count = 0;
+  auto wrapped = LRU::wrap(
+      [&call_count](int x) {
+        call_count += 1;
+        return std::vector<int>(x, x);
+      },
+      0);
+
+  EXPECT_EQ(wrapped.reference(3), std::vector<int>({3, 3, 3}));
+  EXPECT_EQ(wrapped.reference(2), std::vector<int>({2, 2}));
+  EXPECT_EQ(call_count, 2);
+}
+
+namespace {
+struct Request {
+  int id;
+  std::vector<int> payload;
+};
+}  // namespace
+
+TEST(WrapTest, CanKeyByProjection) {
+  std::size_t call_count = 0;
+  auto wrapped = LRU::wrap(
+      [&call_count](const Request& request) {
+        call_count += 1;
+        return request.payload.size();
+      },
+      LRU::key_by([](const Request& request) { return request.id; }));
+
+  EXPECT_TRUE((std::is_same<decltype(wrapped)::Key, int>::value));
+
+  EXPECT_EQ(wrapped(Request{1, {1, 2, 3}}), 3);
+  EXPECT_EQ(wrapped(Request{1, {}}), 3);
+  EXPECT_EQ(wrapped.reference(Request{1, {}}), 3);
+  EXPECT_EQ(call_count, 1);
+
+  EXPECT_EQ(wrapped(Request{2, {}}), 0);
+  EXPECT_EQ(call_count, 2);
+  EXPECT_TRUE(wrapped.cache().contains(2));
+}
+
+TEST(WrapTest, CanKeyByProjectionWithCacheArguments) {
+  using namespace std::chrono_literals;
+
+  std::size_t call_count = 0;
+  auto f = [&call_count](int x, int y) { return call_count += 1; };
+  auto first = [](int x, int) { return x; };
+
+  auto wrapped = LRU::wrap(f, LRU::key_by(first), 1);
+  EXPECT_EQ(wrapped.capacity(), 1);
+
+  wrapped(1, 1);
+  wrapped(1, 2);
+  EXPECT_EQ(call_count, 1);
+
+  auto timed = LRU::timed_wrap(f, LRU::key_by(first), 100ms);
+  timed(1, 1);
+  timed(1, 2);
+  EXPECT_EQ(call_count, 2);
+
+  auto timed2 = LRU::timed_wrap(f, 100ms, LRU::key_by(first), 1);
+  EXPECT_EQ(timed2.capacity(), 1);
+  timed2(1, 1);
+  timed2(1, 2);
+  EXPECT_EQ(call_count, 3);
+}
+
+TEST(WrapTest, ExceptionsAreNotCachedByDefault) {
+  std::size_t call_count = 0;
+  auto wrapped = LRU::wrap([&call_count](int x) -> int {
+    call_count += 1;
+    throw std::runtime_error("down");
+  });
+
+  EXPECT_THROW(wrapped(1), std::runtime_error);
+  EXPECT_THROW(wrapped(1), std::runtime_error);
+  EXPECT_EQ(call_count, 2);
+  EXPECT_FALSE(wrapped.is_caching_errors());
+}
+
+TEST(WrapTest, CanCacheExceptionsWithSeparateTimeToLive) {
+  using namespace std::chrono_literals;
+
+  std::size_t call_count = 0;
+  auto wrapped = LRU::wrap([&call_count](int x) -> int {
+    call_count += 1;
+    if (x < 0) throw std::runtime_error("negative");
+    return x;
+  });
+  wrapped.cache_errors(50ms);
+
+  EXPECT_THROW(wrapped(-1), std::runtime_error);
+  EXPECT_THROW(wrapped(-1), std::runtime_error);
+  EXPECT_THROW(wrapped.reference(-1), std::runtime_error);
+  EXPECT_EQ(call_count, 1);
+  EXPECT_EQ(wrapped.cached_errors(), 1);
+  EXPECT_FALSE(wrapped.cache().contains(std::make_tuple(-1)));
+
+  EXPECT_EQ(wrapped(1), 1);
+  EXPECT_EQ(call_count, 2);
+
+  std::this_thread::sleep_for(100ms);
+
+  EXPECT_THROW(wrapped(-1), std::runtime_error);
+  EXPECT_EQ(call_count, 3);
+
+  wrapped.clear();
+  EXPECT_EQ(wrapped.cached_errors(), 0);
+  wrapped.stop_caching_errors();
+  EXPECT_FALSE(wrapped.is_caching_errors());
+}
+
+TEST(WrapTest, ExceptionsAreCachedAgainAfterExpiring) {
+  using namespace std::chrono_literals;
+
+  std::size_t call_count = 0;
+  auto wrapped = LRU::wrap(
+      [&call_count](int x) -> int {
+        call_count += 1;
+        throw std::runtime_error("always");
+      },
+      16);
+  wrapped.cache_errors(200ms);
+
+  EXPECT_THROW(wrapped(1), std::runtime_error);
+  EXPECT_THROW(wrapped(1), std::runtime_error);
+  EXPECT_EQ(call_count, 1);
+
+  std::this_thread::sleep_for(250ms);
+
+  // The expired error is still in the error cache, but the new one must get a
+  // fresh time to live rather than the expired one's.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_THROW(wrapped(1), std::runtime_error);
+  }
+  EXPECT_EQ(call_count, 2);
+}
+
+TEST(WrapTest, TimedResultsAreCachedAgainAfterExpiring) {
+  using namespace std::chrono_literals;
+
+  std::size_t call_count = 0;
+  auto wrapped = LRU::timed_wrap(
+      [&call_count](int x) {
+        call_count += 1;
+        return x;
+      },
+      200ms);
+
+  EXPECT_EQ(wrapped(1), 1);
+  EXPECT_EQ(wrapped.reference(2), 2);
+  EXPECT_EQ(call_count, 2);
+
+  std::this_thread::sleep_for(250ms);
+
+  EXPECT_EQ(wrapped(1), 1);
+  EXPECT_EQ(wrapped.reference(2), 2);
+  EXPECT_EQ(call_count, 4);
+
+  EXPECT_EQ(wrapped.reference(1), 1);
+  EXPECT_EQ(wrapped(2), 2);
+  EXPECT_EQ(call_count, 4);
+}
+
+TEST(WrapTest, CanCacheErrorResults) {
+  using namespace std::chrono_literals;
+
+  std::size_t call_count = 0;
+  auto wrapped = LRU::wrap([&call_count](int x) {
+    call_count += 1;
+    return x < 0 ? std::string("error") : std::to_string(x);
+  });
+  wrapped.cache_error_results(
+      [](const std::string& result) { return result == "error"; }, 1min);
+
+  EXPECT_EQ(wrapped(-1), "error");
+  EXPECT_EQ(wrapped.reference(-1), "error");
+  EXPECT_EQ(call_count, 1);
+  EXPECT_EQ(wrapped.cached_errors(), 1);
+  EXPECT_TRUE(wrapped.cache().is_empty());
+
+  EXPECT_EQ(wrapped(5), "5");
+  EXPECT_EQ(wrapped(5), "5");
+  EXPECT_EQ(call_count, 2);
+  EXPECT_EQ(wrapped.cached_errors(), 1);
+}
+
+TEST(WrapTest, CanAdmitOnlyExpensiveResults) {
+  using namespace std::chrono_literals;
+
+  std::size_t call_count = 0;
+  auto wrapped = LRU::wrap([&call_count](int x) {
+    call_count += 1;
+    if (x > 0) std::this_thread::sleep_for(20ms);
+    return x;
+  });
+  wrapped.admit_if_slower_than(10ms);
+  EXPECT_EQ(wrapped.admission_threshold(), 10ms);
+
+  EXPECT_EQ(wrapped(0), 0);
+  EXPECT_EQ(wrapped.reference(0), 0);
+  EXPECT_EQ(call_count, 2);
+  EXPECT_EQ(wrapped.rejected_admissions(), 2);
+
+  EXPECT_EQ(wrapped(1), 1);
+  EXPECT_EQ(wrapped(1), 1);
+  EXPECT_EQ(call_count, 3);
+  EXPECT_TRUE(wrapped.cache().contains(std::make_tuple(1)));
+  EXPECT_FALSE(wrapped.cache().contains(std::make_tuple(0)));
+
+  wrapped.admit_all();
+  wrapped(0);
+  wrapped(0);
+  EXPECT_EQ(call_count, 4);
+}